@@ -0,0 +1,387 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name Kitware, Inc. nor the names of any contributors may be
+ *    used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MAPTK_BACKGROUNDCACHE_H_
+#define MAPTK_BACKGROUNDCACHE_H_
+
+#include <qtGlobal.h>
+
+#include <QtCore/QHash>
+#include <QtCore/QList>
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtCore/QWaitCondition>
+
+/// Least recently used cache of items loaded by a worker thread
+///
+/// This holds the cache state and worker loop shared by ImageCache and
+/// DepthMapCache. \p Request describes an item to load, and must have a
+/// \c path member that identifies the item; a default constructed request
+/// (with an empty path) means "no request". \p Entry is a loaded item, and
+/// must have a \c size member giving its memory use in bytes.
+///
+/// Subclasses implement load(), which the worker thread calls without the
+/// mutex held, and loaded(), which it calls (also without the mutex held)
+/// with the most recently requested item when it becomes available.
+template <typename Request, typename Entry>
+class BackgroundCache : public QThread
+{
+public:
+  explicit BackgroundCache(qint64 memoryLimit)
+    : memoryLimit(memoryLimit), memoryUsed(0), generation(0),
+      loadingGeneration(0), loadingDiscarded(false), stopRequested(false) {}
+
+  /// Stop the worker thread and wait for it to exit.
+  void stop();
+
+  qint64 limit() const;
+  void setLimit(qint64);
+
+  /// Get a cached item, marking it as recently used.
+  bool find(QString const& path, Entry& entry);
+
+  /// Get a cached item without marking it as recently used.
+  bool peek(QString const& path, Entry& entry) const;
+
+  /// Request that an item be loaded as soon as possible.
+  ///
+  /// \return \c true if the item is already cached
+  bool request(Request const& request);
+
+  /// Replace the list of items to load after the requested one.
+  void prefetch(QList<Request> const& requests);
+
+  /// Discard all cached items and pending loads.
+  void clear();
+
+  /// Discard the cached items and pending loads whose paths match.
+  ///
+  /// \p matches is called with the mutex held for each path; an item that
+  /// is being loaded when this is called is discarded once loaded.
+  template <typename Predicate>
+  void discard(Predicate matches);
+
+protected:
+  virtual void run() QTE_OVERRIDE;
+
+  virtual Entry load(Request const& request) = 0;
+  virtual void loaded(Request const& request) = 0;
+
+private:
+  // The following must be called with the mutex held
+  void touch(QString const& path);
+  void insert(QString const& path, Entry const& entry);
+  void evict();
+
+  mutable QMutex mutex;
+  QWaitCondition wakeCondition;
+
+  QHash<QString, Entry> entries;
+  QList<QString> recentlyUsed; // Most recently used first
+  qint64 memoryLimit;
+  qint64 memoryUsed;
+
+  QString pinnedPath; // Most recently requested item, never evicted
+  QString pendingRequest; // Requested item whose arrival must be signaled
+  Request nextRequest; // Requested item that has not started loading
+  QString loadingPath; // Item currently being loaded
+  QList<Request> prefetchQueue;
+
+  // Incremented when the cache is cleared, so that loads which were started
+  // before then are discarded
+  int generation;
+  int loadingGeneration;
+  bool loadingDiscarded; // Item being loaded was discarded
+
+  bool stopRequested;
+};
+
+//-----------------------------------------------------------------------------
+template <typename Request, typename Entry>
+void BackgroundCache<Request, Entry>::run()
+{
+  QMutexLocker locker(&this->mutex);
+  forever
+  {
+    while (!this->stopRequested && this->nextRequest.path.isEmpty() &&
+           this->prefetchQueue.isEmpty())
+    {
+      this->wakeCondition.wait(&this->mutex);
+    }
+    if (this->stopRequested)
+    {
+      return;
+    }
+
+    // Requested items take precedence over prefetching
+    auto request = Request{};
+    if (!this->nextRequest.path.isEmpty())
+    {
+      request = this->nextRequest;
+      this->nextRequest = Request{};
+    }
+    else
+    {
+      request = this->prefetchQueue.takeFirst();
+    }
+    if (this->entries.contains(request.path))
+    {
+      continue;
+    }
+
+    // Load the item without holding the lock
+    auto const generation = this->generation;
+    this->loadingPath = request.path;
+    this->loadingGeneration = generation;
+    this->loadingDiscarded = false;
+    locker.unlock();
+    auto const& entry = this->load(request);
+    locker.relock();
+    this->loadingPath.clear();
+
+    if (generation != this->generation || this->loadingDiscarded)
+    {
+      // Cache was cleared, or the item discarded, while loading; the result
+      // may be stale
+      continue;
+    }
+
+    this->insert(request.path, entry);
+    if (request.path == this->pendingRequest)
+    {
+      this->pendingRequest.clear();
+      locker.unlock();
+      this->loaded(request);
+      locker.relock();
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+template <typename Request, typename Entry>
+void BackgroundCache<Request, Entry>::touch(QString const& path)
+{
+  this->recentlyUsed.removeOne(path);
+  this->recentlyUsed.prepend(path);
+}
+
+//-----------------------------------------------------------------------------
+template <typename Request, typename Entry>
+void BackgroundCache<Request, Entry>::insert(
+  QString const& path, Entry const& entry)
+{
+  this->entries.insert(path, entry);
+  this->memoryUsed += entry.size;
+  this->touch(path);
+  this->evict();
+}
+
+//-----------------------------------------------------------------------------
+template <typename Request, typename Entry>
+void BackgroundCache<Request, Entry>::evict()
+{
+  auto i = this->recentlyUsed.count();
+  while (this->memoryUsed > this->memoryLimit && i--)
+  {
+    auto const path = this->recentlyUsed[i];
+    if (path != this->pinnedPath)
+    {
+      this->memoryUsed -= this->entries.take(path).size;
+      this->recentlyUsed.removeAt(i);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+template <typename Request, typename Entry>
+void BackgroundCache<Request, Entry>::stop()
+{
+  this->mutex.lock();
+  this->stopRequested = true;
+  this->wakeCondition.wakeAll();
+  this->mutex.unlock();
+
+  this->wait();
+}
+
+//-----------------------------------------------------------------------------
+template <typename Request, typename Entry>
+qint64 BackgroundCache<Request, Entry>::limit() const
+{
+  QMutexLocker locker(&this->mutex);
+  return this->memoryLimit;
+}
+
+//-----------------------------------------------------------------------------
+template <typename Request, typename Entry>
+void BackgroundCache<Request, Entry>::setLimit(qint64 limit)
+{
+  QMutexLocker locker(&this->mutex);
+  this->memoryLimit = limit;
+  this->evict();
+}
+
+//-----------------------------------------------------------------------------
+template <typename Request, typename Entry>
+bool BackgroundCache<Request, Entry>::find(QString const& path, Entry& entry)
+{
+  QMutexLocker locker(&this->mutex);
+
+  auto const iter = this->entries.find(path);
+  if (iter == this->entries.end())
+  {
+    return false;
+  }
+
+  this->touch(path);
+  entry = *iter;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+template <typename Request, typename Entry>
+bool BackgroundCache<Request, Entry>::peek(
+  QString const& path, Entry& entry) const
+{
+  QMutexLocker locker(&this->mutex);
+
+  auto const iter = this->entries.find(path);
+  if (iter == this->entries.end())
+  {
+    return false;
+  }
+
+  entry = *iter;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+template <typename Request, typename Entry>
+bool BackgroundCache<Request, Entry>::request(Request const& request)
+{
+  QMutexLocker locker(&this->mutex);
+
+  this->pinnedPath = request.path;
+  if (this->entries.contains(request.path))
+  {
+    this->pendingRequest.clear();
+    this->nextRequest = Request{};
+    this->touch(request.path);
+    return true;
+  }
+
+  // An item that is already loading is only reused if the cache has not
+  // been cleared, nor the item discarded, since the load started
+  this->pendingRequest = request.path;
+  if (request.path != this->loadingPath ||
+      this->loadingGeneration != this->generation || this->loadingDiscarded)
+  {
+    this->nextRequest = request;
+    this->wakeCondition.wakeAll();
+  }
+  return false;
+}
+
+//-----------------------------------------------------------------------------
+template <typename Request, typename Entry>
+void BackgroundCache<Request, Entry>::prefetch(QList<Request> const& requests)
+{
+  QMutexLocker locker(&this->mutex);
+
+  this->prefetchQueue.clear();
+  foreach (auto const& request, requests)
+  {
+    if (!request.path.isEmpty() && !this->entries.contains(request.path))
+    {
+      this->prefetchQueue.append(request);
+    }
+  }
+  this->wakeCondition.wakeAll();
+}
+
+//-----------------------------------------------------------------------------
+template <typename Request, typename Entry>
+void BackgroundCache<Request, Entry>::clear()
+{
+  QMutexLocker locker(&this->mutex);
+
+  ++this->generation;
+  this->entries.clear();
+  this->recentlyUsed.clear();
+  this->memoryUsed = 0;
+  this->pinnedPath.clear();
+  this->pendingRequest.clear();
+  this->nextRequest = Request{};
+  this->prefetchQueue.clear();
+}
+
+//-----------------------------------------------------------------------------
+template <typename Request, typename Entry>
+template <typename Predicate>
+void BackgroundCache<Request, Entry>::discard(Predicate matches)
+{
+  QMutexLocker locker(&this->mutex);
+
+  for (auto i = this->recentlyUsed.count(); i--;)
+  {
+    auto const path = this->recentlyUsed[i];
+    if (matches(path))
+    {
+      this->memoryUsed -= this->entries.take(path).size;
+      this->recentlyUsed.removeAt(i);
+    }
+  }
+  for (auto i = this->prefetchQueue.count(); i--;)
+  {
+    if (matches(this->prefetchQueue[i].path))
+    {
+      this->prefetchQueue.removeAt(i);
+    }
+  }
+
+  if (!this->loadingPath.isEmpty() && matches(this->loadingPath))
+  {
+    this->loadingDiscarded = true;
+  }
+  if (!this->pinnedPath.isEmpty() && matches(this->pinnedPath))
+  {
+    this->pinnedPath.clear();
+  }
+  if (!this->pendingRequest.isEmpty() && matches(this->pendingRequest))
+  {
+    this->pendingRequest.clear();
+  }
+  if (!this->nextRequest.path.isEmpty() && matches(this->nextRequest.path))
+  {
+    this->nextRequest = Request{};
+  }
+}
+
+#endif
@@ -38,15 +38,19 @@
 #include "FeatureOptions.h"
 #include "FieldInformation.h"
 #include "ImageOptions.h"
+#include "ImagePyramid.h"
 #include "vtkMaptkCamera.h"
 #include "vtkMaptkFeatureTrackRepresentation.h"
 
 #include <vital/types/landmark_map.h>
 #include <vital/types/track.h>
+#include <vital/types/track_set.h>
 
 #include <vtkCamera.h>
 #include <vtkCellArray.h>
+#include <vtkCommand.h>
 #include <vtkDoubleArray.h>
+#include <vtkEventQtSlotConnect.h>
 #include <vtkImageActor.h>
 #include <vtkImageData.h>
 #include <vtkInteractorStyleRubberBand2D.h>
@@ -58,6 +62,7 @@
 #include <vtkProperty.h>
 #include <vtkRenderer.h>
 #include <vtkRenderWindow.h>
+#include <vtkSmartPointer.h>
 #include <vtkUnsignedCharArray.h>
 #include <vtkUnsignedIntArray.h>
 
@@ -69,6 +74,8 @@
 #include <QtGui/QToolButton>
 #include <QtGui/QWidgetAction>
 
+#include <QtCore/QThread>
+
 QTE_IMPLEMENT_D_FUNC(CameraView)
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -134,6 +141,21 @@ void ActorColorOption::setDefaultColor(QColor const& color)
 
 //BEGIN CameraViewPrivate definition
 
+//-----------------------------------------------------------------------------
+class FeatureTrackLoader : public QThread
+{
+public:
+  virtual void run() QTE_OVERRIDE
+  {
+    this->result =
+      vtkMaptkFeatureTrackRepresentation::BuildTrackData(this->tracks);
+    this->tracks.reset();
+  }
+
+  kwiver::vital::track_set_sptr tracks;
+  std::shared_ptr<vtkMaptkFeatureTrackRepresentation::TrackData> result;
+};
+
 //-----------------------------------------------------------------------------
 class CameraViewPrivate
 {
@@ -172,6 +194,9 @@ public:
     LandmarkCloud();
 
     void addPoint(double x, double y, double z, LandmarkData const& data);
+    void addPoints(QVector<kwiver::vital::landmark_id_t> const& ids,
+                   Eigen::Matrix2Xd const& points, double z,
+                   QHash<kwiver::vital::landmark_id_t, LandmarkData> const&);
 
     void clear();
 
@@ -180,14 +205,17 @@ public:
     vtkNew<vtkDoubleArray> elevations;
   };
 
-  CameraViewPrivate() : featuresDirty(false) {}
+  CameraViewPrivate()
+    : imagePyramid(0), featuresDirty(false), featureTracksPending(false) {}
 
   void setPopup(QAction* action, QMenu* menu);
   void setPopup(QAction* action, QWidget* widget);
 
   void setTransforms(int imageHeight);
+  void updateImageTiles();
 
   void updateFeatures(CameraView* q);
+  void loadFeatureTracks();
 
   Ui::CameraView UI;
   Am::CameraView AM;
@@ -197,6 +225,10 @@ public:
 
   vtkNew<vtkImageActor> imageActor;
   vtkNew<vtkImageData> emptyImage;
+  vtkSmartPointer<vtkImageData> imageData;
+  ImagePyramid* imagePyramid;
+
+  vtkNew<vtkEventQtSlotConnect> connections;
 
   vtkNew<vtkMaptkFeatureTrackRepresentation> featureRep;
 
@@ -210,6 +242,10 @@ public:
   double imageBounds[6];
 
   bool featuresDirty;
+
+  FeatureTrackLoader featureTrackLoader;
+  kwiver::vital::track_set_sptr pendingFeatureTracks;
+  bool featureTracksPending;
 };
 
 //END CameraViewPrivate definition
@@ -329,6 +365,45 @@ void CameraViewPrivate::LandmarkCloud::addPoint(
   this->elevations->Modified();
 }
 
+//-----------------------------------------------------------------------------
+void CameraViewPrivate::LandmarkCloud::addPoints(
+  QVector<kwiver::vital::landmark_id_t> const& ids,
+  Eigen::Matrix2Xd const& points, double z,
+  QHash<kwiver::vital::landmark_id_t, LandmarkData> const& data)
+{
+  auto const offset = this->points->GetNumberOfPoints();
+  auto const count = static_cast<vtkIdType>(ids.count());
+
+  // Size all arrays once, then fill them in place
+  this->points->SetNumberOfPoints(offset + count);
+  this->colors->SetNumberOfTuples(offset + count);
+  this->observations->SetNumberOfTuples(offset + count);
+  this->elevations->SetNumberOfTuples(offset + count);
+
+  for (vtkIdType i = 0; i < count; ++i)
+  {
+    auto const vid = offset + i;
+    auto const& ld = data.value(ids[i]);
+
+    this->points->SetPoint(vid, points(0, i), points(1, i), z);
+
+    this->verts->InsertNextCell(1);
+    this->verts->InsertCellPoint(vid);
+
+    this->colors->SetValue((3 * vid) + 0, ld.color.r);
+    this->colors->SetValue((3 * vid) + 1, ld.color.g);
+    this->colors->SetValue((3 * vid) + 2, ld.color.b);
+    this->observations->SetValue(vid, ld.observations);
+    this->elevations->SetValue(vid, ld.elevation);
+  }
+
+  this->points->Modified();
+  this->verts->Modified();
+  this->colors->Modified();
+  this->observations->Modified();
+  this->elevations->Modified();
+}
+
 //END geometry helpers
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -377,6 +452,64 @@ void CameraViewPrivate::setTransforms(int imageHeight)
   this->residuals.actor->SetUserMatrix(xf.GetPointer());
 }
 
+//-----------------------------------------------------------------------------
+void CameraViewPrivate::updateImageTiles()
+{
+  static auto const tileSize = 512;
+
+  auto const pyramid = this->imagePyramid;
+  if (!this->imageData || !pyramid || pyramid->levelCount() < 2 ||
+      pyramid->image() != this->imageData)
+  {
+    // Image is displayed directly
+    return;
+  }
+
+  auto const camera = this->renderer->GetActiveCamera();
+  auto const viewSize = this->renderer->GetSize();
+  if (viewSize[0] < 1 || viewSize[1] < 1)
+  {
+    return;
+  }
+
+  // Select the pyramid level matching the current zoom; until that level has
+  // been built, a coarser one is used
+  auto const halfHeight = camera->GetParallelScale();
+  auto const halfWidth = halfHeight * viewSize[0] / viewSize[1];
+  auto const scale = 2.0 * halfHeight / viewSize[1];
+  auto const data = pyramid->level(pyramid->levelForScale(scale));
+
+  double focus[3], origin[3], spacing[3];
+  int extent[6];
+  camera->GetFocalPoint(focus);
+  data->GetOrigin(origin);
+  data->GetSpacing(spacing);
+  data->GetExtent(extent);
+
+  // Compute the visible part of the level, rounded out to whole tiles so that
+  // small pans do not change the extent (which would upload a new texture)
+  int displayExtent[6] = { 0, 0, 0, 0, extent[4], extent[4] };
+  for (int a = 0; a < 2; ++a)
+  {
+    auto const half = (a ? halfHeight : halfWidth);
+    auto const lo = (focus[a] - half - origin[a]) / spacing[a];
+    auto const hi = (focus[a] + half - origin[a]) / spacing[a];
+    auto const tileLo = qFloor(lo / tileSize) * tileSize;
+    auto const tileHi = (qFloor(hi / tileSize) + 1) * tileSize - 1;
+
+    displayExtent[2 * a + 0] =
+      qBound(extent[2 * a], tileLo, extent[2 * a + 1]);
+    displayExtent[2 * a + 1] =
+      qBound(extent[2 * a], tileHi, extent[2 * a + 1]);
+  }
+
+  if (this->imageActor->GetInput() != data)
+  {
+    this->imageActor->SetInputData(data);
+  }
+  this->imageActor->SetDisplayExtent(displayExtent);
+}
+
 //-----------------------------------------------------------------------------
 void CameraViewPrivate::updateFeatures(CameraView* q)
 {
@@ -387,6 +520,16 @@ void CameraViewPrivate::updateFeatures(CameraView* q)
   }
 }
 
+//-----------------------------------------------------------------------------
+void CameraViewPrivate::loadFeatureTracks()
+{
+  this->featureTrackLoader.wait();
+  this->featureTrackLoader.tracks = this->pendingFeatureTracks;
+  this->pendingFeatureTracks.reset();
+  this->featureTracksPending = false;
+  this->featureTrackLoader.start();
+}
+
 //END CameraViewPrivate implementation
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -488,6 +631,13 @@ CameraView::CameraView(QWidget* parent, Qt::WindowFlags flags)
   d->renderer->AddViewProp(d->imageActor.GetPointer());
   d->imageActor->SetPosition(0.0, 0.0, -0.5);
 
+  // Update the displayed part of large images whenever the view is rendered
+  d->connections->Connect(d->renderer.GetPointer(), vtkCommand::StartEvent,
+                          this, SLOT(updateImageTiles()));
+
+  connect(&d->featureTrackLoader, SIGNAL(finished()),
+          this, SLOT(acceptFeatureTracks()));
+
   // Create "dummy" image data for use when we have no "real" image
   d->emptyImage->SetExtent(0, 0, 0, 0, 0, 0);
   d->emptyImage->AllocateScalars(VTK_UNSIGNED_CHAR, 1);
@@ -499,6 +649,8 @@ CameraView::CameraView(QWidget* parent, Qt::WindowFlags flags)
 //-----------------------------------------------------------------------------
 CameraView::~CameraView()
 {
+  QTE_D();
+  d->featureTrackLoader.wait();
 }
 
 //-----------------------------------------------------------------------------
@@ -509,6 +661,25 @@ void CameraView::setBackgroundColor(QColor const& color)
   d->UI.renderWidget->update();
 }
 
+//-----------------------------------------------------------------------------
+void CameraView::setImagePyramid(ImagePyramid* pyramid)
+{
+  QTE_D();
+
+  if (d->imagePyramid)
+  {
+    disconnect(d->imagePyramid, 0, d->UI.renderWidget, 0);
+  }
+
+  d->imagePyramid = pyramid;
+
+  if (pyramid)
+  {
+    connect(pyramid, SIGNAL(levelReady(int)),
+            d->UI.renderWidget, SLOT(update()));
+  }
+}
+
 //-----------------------------------------------------------------------------
 void CameraView::setImagePath(QString const& path)
 {
@@ -524,7 +695,9 @@ void CameraView::setImageData(vtkImageData* data, QSize const& dimensions)
   if (!data)
   {
     // If no image given, clear current image and replace with "empty" image
+    d->imageData = vtkSmartPointer<vtkImageData>();
     d->imageActor->SetInputData(d->emptyImage.GetPointer());
+    d->imageActor->SetDisplayExtent(0, -1, 0, -1, 0, 0);
 
     d->imageBounds[0] = 0.0; d->imageBounds[1] = dimensions.width() - 1;
     d->imageBounds[2] = 0.0; d->imageBounds[3] = dimensions.height() - 1;
@@ -534,11 +707,15 @@ void CameraView::setImageData(vtkImageData* data, QSize const& dimensions)
   }
   else
   {
-    // Set data on image actor
+    // Set data on image actor; for large images, this is replaced by the
+    // visible tiles of a pyramid level
+    d->imageData = data;
     d->imageActor->SetInputData(data);
+    d->imageActor->SetDisplayExtent(0, -1, 0, -1, 0, 0);
+    d->updateImageTiles();
     d->imageActor->Update();
 
-    d->imageActor->GetBounds(d->imageBounds);
+    data->GetBounds(d->imageBounds);
     auto const h = d->imageBounds[3] + 1 - d->imageBounds[2];
     d->setTransforms(qMax(0, static_cast<int>(h)));
   }
@@ -610,6 +787,46 @@ void CameraView::addFeatureTrack(kwiver::vital::track const& track)
   d->updateFeatures(this);
 }
 
+//-----------------------------------------------------------------------------
+void CameraView::setFeatureTracks(kwiver::vital::track_set_sptr const& tracks)
+{
+  QTE_D();
+
+  // Build the track data in the background; if a build is already running,
+  // the newest tracks are loaded once it finishes
+  d->pendingFeatureTracks = tracks;
+  d->featureTracksPending = true;
+  if (!d->featureTrackLoader.isRunning())
+  {
+    d->loadFeatureTracks();
+  }
+}
+
+//-----------------------------------------------------------------------------
+void CameraView::acceptFeatureTracks()
+{
+  QTE_D();
+
+  if (d->featureTrackLoader.isRunning() || !d->featureTrackLoader.result)
+  {
+    // Tracks were replaced after this load finished, and the newer load has
+    // already been started (or accepted)
+    return;
+  }
+
+  if (d->featureTracksPending)
+  {
+    // The tracks were replaced while loading; load the new ones instead
+    d->featureTrackLoader.result.reset();
+    d->loadFeatureTracks();
+    return;
+  }
+
+  d->featureRep->SetTrackData(d->featureTrackLoader.result);
+  d->featureTrackLoader.result.reset();
+  d->UI.renderWidget->update();
+}
+
 //-----------------------------------------------------------------------------
 void CameraView::addLandmark(
   kwiver::vital::landmark_id_t id, double x, double y)
@@ -621,6 +838,18 @@ void CameraView::addLandmark(
   d->UI.renderWidget->update();
 }
 
+//-----------------------------------------------------------------------------
+void CameraView::addLandmarks(
+  QVector<kwiver::vital::landmark_id_t> const& ids,
+  Eigen::Matrix2Xd const& points)
+{
+  QTE_D();
+
+  d->landmarks.addPoints(ids, points, 0.0, d->landmarkData);
+
+  d->UI.renderWidget->update();
+}
+
 //-----------------------------------------------------------------------------
 void CameraView::addResidual(
   kwiver::vital::track_id_t id, double x1, double y1, double x2, double y2)
@@ -704,6 +933,13 @@ void CameraView::resetViewToFullExtents()
   d->UI.renderWidget->update();
 }
 
+//-----------------------------------------------------------------------------
+void CameraView::updateImageTiles()
+{
+  QTE_D();
+  d->updateImageTiles();
+}
+
 //-----------------------------------------------------------------------------
 void CameraView::updateFeatures()
 {
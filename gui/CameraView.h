@@ -31,20 +31,27 @@
 #ifndef MAPTK_CAMERAVIEW_H_
 #define MAPTK_CAMERAVIEW_H_
 
+#include <vital/types/vector.h>
 #include <vital/vital_types.h>
 
 #include <qtGlobal.h>
 
 #include <QtGui/QWidget>
 
+#include <QtCore/QVector>
+
+#include <memory>
+
 class vtkImageData;
 
 namespace kwiver { namespace vital { class landmark_map; } }
 namespace kwiver { namespace vital { class track; } }
+namespace kwiver { namespace vital { class track_set; } }
 
 class vtkMaptkCamera;
 
 class CameraViewPrivate;
+class ImagePyramid;
 
 class CameraView : public QWidget
 {
@@ -56,6 +63,19 @@ public:
 
   void addFeatureTrack(kwiver::vital::track const&);
 
+  /// Replace all feature tracks.
+  ///
+  /// The feature points and their per-frame index are built on a worker
+  /// thread; the displayed tracks are replaced when that is done.
+  void setFeatureTracks(std::shared_ptr<kwiver::vital::track_set> const&);
+
+  /// Set the pyramid used to display large images.
+  ///
+  /// When the image passed to setImageData() is the source of \p pyramid,
+  /// only the tiles of the pyramid level matching the current zoom that are
+  /// visible are displayed.
+  void setImagePyramid(ImagePyramid* pyramid);
+
 public slots:
   void setBackgroundColor(QColor const&);
 
@@ -67,6 +87,8 @@ public slots:
   void setActiveFrame(unsigned);
 
   void addLandmark(kwiver::vital::landmark_id_t id, double x, double y);
+  void addLandmarks(QVector<kwiver::vital::landmark_id_t> const& ids,
+                    Eigen::Matrix2Xd const& points);
   void addResidual(kwiver::vital::track_id_t id,
                    double x1, double y1,
                    double x2, double y2);
@@ -83,6 +105,8 @@ protected slots:
   void setResidualsVisible(bool);
 
   void updateFeatures();
+  void updateImageTiles();
+  void acceptFeatureTracks();
 
 private:
   QTE_DECLARE_PRIVATE_RPTR(CameraView)
@@ -0,0 +1,259 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name Kitware, Inc. nor the names of any contributors may be
+ *    used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "DepthMapCache.h"
+
+#include "BackgroundCache.h"
+#include "vtkMaptkCamera.h"
+#include "vtkMaptkImageUnprojectDepth.h"
+
+#include <vtksys/SystemTools.hxx>
+
+#include <vtkImageData.h>
+#include <vtkNew.h>
+#include <vtkXMLImageDataReader.h>
+
+#include <QtCore/QDebug>
+
+namespace // anonymous
+{
+
+// Default memory limit; enough for a dozen or so typical depth maps
+auto const defaultMemoryLimit = qint64{1} << 29;
+
+//-----------------------------------------------------------------------------
+struct CacheEntry
+{
+  CacheEntry() : size(0) {}
+
+  vtkSmartPointer<vtkImageData> data;
+  qint64 size;
+};
+
+//-----------------------------------------------------------------------------
+struct LoadRequest
+{
+  QString path; // Cache key
+  QString fileName;
+  vtkSmartPointer<vtkMaptkCamera> camera;
+};
+
+//-----------------------------------------------------------------------------
+QString cacheKey(QString const& path, QSize const& imageSize)
+{
+  // File names can not contain a null character, so keys for one file can
+  // be told apart from those of any other
+  return path + QChar(0) +
+         QString("%1x%2").arg(imageSize.width()).arg(imageSize.height());
+}
+
+//-----------------------------------------------------------------------------
+LoadRequest makeRequest(QString const& path, vtkMaptkCamera* camera,
+                        QSize const& imageSize)
+{
+  auto request = LoadRequest{cacheKey(path, imageSize), path, {}};
+
+  // Take a copy of the camera, as the original may be modified by the UI
+  // thread while the depth map is being unprojected; its image dimensions
+  // may not be known yet, so use those of the decoded image
+  if (camera)
+  {
+    request.camera = vtkSmartPointer<vtkMaptkCamera>::New();
+    request.camera->DeepCopy(camera);
+    if (imageSize.isValid())
+    {
+      request.camera->SetImageDimensions(imageSize.width(),
+                                         imageSize.height());
+    }
+  }
+
+  return request;
+}
+
+//-----------------------------------------------------------------------------
+CacheEntry readDepthMap(LoadRequest const& request,
+                        vtkMaptkImageUnprojectDepth* unprojectFilter)
+{
+  auto entry = CacheEntry{};
+
+  if (!vtksys::SystemTools::FileExists(qPrintable(request.fileName), true))
+  {
+    qWarning() << "File doesn't exist: " << request.fileName;
+    return entry;
+  }
+
+  // Read the depth map
+  vtkNew<vtkXMLImageDataReader> reader;
+  reader->SetFileName(qPrintable(request.fileName));
+  reader->Update();
+
+  auto const data = vtkSmartPointer<vtkImageData>::New();
+  if (request.camera)
+  {
+    // Unproject the depth map, and detach the result from the pipeline
+    unprojectFilter->SetCamera(request.camera);
+    unprojectFilter->SetInputData(reader->GetOutput());
+    unprojectFilter->Update();
+
+    data->ShallowCopy(unprojectFilter->GetOutput());
+
+    unprojectFilter->SetInputData(0);
+    unprojectFilter->SetCamera(0);
+  }
+  else
+  {
+    data->ShallowCopy(reader->GetOutput());
+  }
+
+  entry.data = data;
+  entry.size = qint64{data->GetActualMemorySize()} * 1024;
+  return entry;
+}
+
+} // namespace <anonymous>
+
+//-----------------------------------------------------------------------------
+class DepthMapCachePrivate : public BackgroundCache<LoadRequest, CacheEntry>
+{
+public:
+  DepthMapCachePrivate(DepthMapCache* q)
+    : BackgroundCache(defaultMemoryLimit), q_ptr(q) {}
+
+protected:
+  virtual CacheEntry load(LoadRequest const& request) QTE_OVERRIDE;
+  virtual void loaded(LoadRequest const& request) QTE_OVERRIDE;
+
+  // The unprojection filter is kept across loads, so that its per-pixel rays
+  // are reused for all depth maps with the same intrinsics; it is only used
+  // by the worker thread
+  vtkNew<vtkMaptkImageUnprojectDepth> unprojectFilter;
+
+  QTE_DECLARE_PUBLIC_PTR(DepthMapCache)
+  QTE_DECLARE_PUBLIC(DepthMapCache)
+};
+
+QTE_IMPLEMENT_D_FUNC(DepthMapCache)
+
+//-----------------------------------------------------------------------------
+CacheEntry DepthMapCachePrivate::load(LoadRequest const& request)
+{
+  return readDepthMap(request, this->unprojectFilter.GetPointer());
+}
+
+//-----------------------------------------------------------------------------
+void DepthMapCachePrivate::loaded(LoadRequest const& request)
+{
+  QTE_Q();
+  emit q->depthMapReady(request.fileName);
+}
+
+//-----------------------------------------------------------------------------
+DepthMapCache::DepthMapCache(QObject* parent)
+  : QObject(parent), d_ptr(new DepthMapCachePrivate(this))
+{
+  QTE_D();
+  d->start(QThread::LowPriority);
+}
+
+//-----------------------------------------------------------------------------
+DepthMapCache::~DepthMapCache()
+{
+  QTE_D();
+  d->stop();
+}
+
+//-----------------------------------------------------------------------------
+qint64 DepthMapCache::memoryLimit() const
+{
+  QTE_D();
+  return d->limit();
+}
+
+//-----------------------------------------------------------------------------
+void DepthMapCache::setMemoryLimit(qint64 limit)
+{
+  QTE_D();
+  d->setLimit(limit);
+}
+
+//-----------------------------------------------------------------------------
+bool DepthMapCache::depthMap(
+  QString const& path, QSize const& imageSize,
+  vtkSmartPointer<vtkImageData>& data)
+{
+  QTE_D();
+
+  auto entry = CacheEntry{};
+  if (!d->find(cacheKey(path, imageSize), entry))
+  {
+    return false;
+  }
+
+  data = entry.data;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool DepthMapCache::request(
+  QString const& path, vtkMaptkCamera* camera, QSize const& imageSize)
+{
+  QTE_D();
+  return d->request(makeRequest(path, camera, imageSize));
+}
+
+//-----------------------------------------------------------------------------
+void DepthMapCache::prefetch(QList<Request> const& requests)
+{
+  QTE_D();
+
+  auto loadRequests = QList<LoadRequest>{};
+  foreach (auto const& request, requests)
+  {
+    loadRequests.append(
+      makeRequest(request.path, request.camera, request.imageSize));
+  }
+  d->prefetch(loadRequests);
+}
+
+//-----------------------------------------------------------------------------
+void DepthMapCache::clear()
+{
+  QTE_D();
+  d->clear();
+}
+
+//-----------------------------------------------------------------------------
+void DepthMapCache::invalidate(QString const& path)
+{
+  QTE_D();
+
+  auto const prefix = path + QChar(0);
+  d->discard([&prefix](QString const& key){ return key.startsWith(prefix); });
+}
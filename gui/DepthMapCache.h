@@ -0,0 +1,132 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name Kitware, Inc. nor the names of any contributors may be
+ *    used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MAPTK_DEPTHMAPCACHE_H_
+#define MAPTK_DEPTHMAPCACHE_H_
+
+#include <qtGlobal.h>
+
+#include <QtCore/QList>
+#include <QtCore/QObject>
+#include <QtCore/QSize>
+
+#include <vtkSmartPointer.h>
+
+class vtkImageData;
+class vtkMaptkCamera;
+
+class DepthMapCachePrivate;
+
+/// Cache of unprojected depth maps, loaded on a background thread
+///
+/// Depth maps are read and unprojected using their camera by a worker thread,
+/// and the resulting image data (including the unprojected points) is kept in
+/// a least recently used cache whose total size is bounded by a memory limit.
+/// Requested depth maps are loaded before any prefetched ones; when a
+/// requested depth map is ready, depthMapReady() is emitted so that the UI
+/// thread can swap it in without reading or unprojecting anything itself.
+///
+/// Depth maps are cached by path and by the size of the camera image they
+/// are unprojected for, since the camera intrinsics are scaled from the image
+/// size to the depth map size.
+class DepthMapCache : public QObject
+{
+  Q_OBJECT
+
+public:
+  struct Request
+  {
+    QString path;
+    vtkMaptkCamera* camera;
+    QSize imageSize; // Size of the camera image
+  };
+
+  explicit DepthMapCache(QObject* parent = 0);
+  virtual ~DepthMapCache();
+
+  /// Get the memory limit of the cache, in bytes.
+  qint64 memoryLimit() const;
+
+  /// Set the memory limit of the cache, in bytes.
+  ///
+  /// Least recently used depth maps are discarded to stay within the limit.
+  /// The most recently requested depth map is always kept, even if it alone
+  /// exceeds the limit.
+  void setMemoryLimit(qint64);
+
+  /// Get a depth map if it has already been loaded.
+  ///
+  /// If the depth map is in the cache for the camera image size
+  /// \p imageSize, this returns \c true and sets \p data to the unprojected
+  /// depth map. If the depth map could not be read, \p data is set to null.
+  /// Otherwise, this returns \c false and \p data is not modified.
+  bool depthMap(QString const& path, QSize const& imageSize,
+                vtkSmartPointer<vtkImageData>& data);
+
+  /// Request that a depth map be loaded as soon as possible.
+  ///
+  /// The depth map is unprojected using a copy of \p camera as it is at the
+  /// time of the call, with its image dimensions set to \p imageSize, which
+  /// should be the size of the decoded camera image; if \p camera is null,
+  /// the depth map is not unprojected. The request replaces any previous one
+  /// that has not started loading. The depthMapReady() signal is emitted when
+  /// the depth map is available, unless it was already cached.
+  ///
+  /// \return \c true if the depth map is already cached
+  bool request(QString const& path, vtkMaptkCamera* camera,
+               QSize const& imageSize);
+
+  /// Set the depth maps to be loaded after the requested one.
+  ///
+  /// Depth maps are loaded in the order given. The list replaces any previous
+  /// prefetch list; depth maps already in the cache are skipped.
+  void prefetch(QList<Request> const& requests);
+
+  /// Discard all cached depth maps and pending loads.
+  void clear();
+
+  /// Discard the cached copies and pending loads of a depth map.
+  ///
+  /// This should be called when the camera of a depth map changes, as cached
+  /// copies were unprojected using the previous camera.
+  void invalidate(QString const& path);
+
+signals:
+  /// Emitted when a requested depth map has been loaded (or failed to load).
+  void depthMapReady(QString const& path);
+
+private:
+  QTE_DECLARE_PRIVATE_RPTR(DepthMapCache)
+  QTE_DECLARE_PRIVATE(DepthMapCache)
+
+  QTE_DISABLE_COPY(DepthMapCache)
+};
+
+#endif
@@ -0,0 +1,219 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name Kitware, Inc. nor the names of any contributors may be
+ *    used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ImageCache.h"
+
+#include "BackgroundCache.h"
+
+#include <vtkImageData.h>
+#include <vtkImageReader2.h>
+#include <vtkImageReader2Factory.h>
+
+#include <QtCore/QDebug>
+
+namespace // anonymous
+{
+
+// Default memory limit; enough for a few dozen typical aerial frames
+auto const defaultMemoryLimit = qint64{1} << 30;
+
+//-----------------------------------------------------------------------------
+struct CacheEntry
+{
+  CacheEntry() : size(0) {}
+
+  vtkSmartPointer<vtkImageData> data;
+  QSize dimensions;
+  qint64 size;
+};
+
+//-----------------------------------------------------------------------------
+struct LoadRequest
+{
+  QString path;
+};
+
+//-----------------------------------------------------------------------------
+CacheEntry readImage(QString const& path)
+{
+  auto entry = CacheEntry{};
+
+  // Create a reader capable of reading the image file
+  auto const reader =
+    vtkImageReader2Factory::CreateImageReader2(qPrintable(path));
+  if (!reader)
+  {
+    qWarning() << "Failed to create image reader for image" << path;
+    return entry;
+  }
+
+  // Load the image, and detach it from the reader
+  reader->SetFileName(qPrintable(path));
+  reader->Update();
+
+  auto const data = vtkSmartPointer<vtkImageData>::New();
+  data->ShallowCopy(reader->GetOutput());
+  reader->Delete();
+
+  // Test for errors
+  int dimensions[3];
+  data->GetDimensions(dimensions);
+  if (dimensions[0] < 2 || dimensions[1] < 2)
+  {
+    qWarning() << "Failed to read image" << path;
+    return entry;
+  }
+
+  entry.data = data;
+  entry.dimensions = QSize(dimensions[0], dimensions[1]);
+  entry.size = qint64{data->GetActualMemorySize()} * 1024;
+  return entry;
+}
+
+} // namespace <anonymous>
+
+//-----------------------------------------------------------------------------
+class ImageCachePrivate : public BackgroundCache<LoadRequest, CacheEntry>
+{
+public:
+  ImageCachePrivate(ImageCache* q)
+    : BackgroundCache(defaultMemoryLimit), q_ptr(q) {}
+
+protected:
+  virtual CacheEntry load(LoadRequest const& request) QTE_OVERRIDE;
+  virtual void loaded(LoadRequest const& request) QTE_OVERRIDE;
+
+  QTE_DECLARE_PUBLIC_PTR(ImageCache)
+  QTE_DECLARE_PUBLIC(ImageCache)
+};
+
+QTE_IMPLEMENT_D_FUNC(ImageCache)
+
+//-----------------------------------------------------------------------------
+CacheEntry ImageCachePrivate::load(LoadRequest const& request)
+{
+  return readImage(request.path);
+}
+
+//-----------------------------------------------------------------------------
+void ImageCachePrivate::loaded(LoadRequest const& request)
+{
+  QTE_Q();
+  emit q->imageReady(request.path);
+}
+
+//-----------------------------------------------------------------------------
+ImageCache::ImageCache(QObject* parent)
+  : QObject(parent), d_ptr(new ImageCachePrivate(this))
+{
+  QTE_D();
+  d->start(QThread::LowPriority);
+}
+
+//-----------------------------------------------------------------------------
+ImageCache::~ImageCache()
+{
+  QTE_D();
+  d->stop();
+}
+
+//-----------------------------------------------------------------------------
+qint64 ImageCache::memoryLimit() const
+{
+  QTE_D();
+  return d->limit();
+}
+
+//-----------------------------------------------------------------------------
+void ImageCache::setMemoryLimit(qint64 limit)
+{
+  QTE_D();
+  d->setLimit(limit);
+}
+
+//-----------------------------------------------------------------------------
+bool ImageCache::image(QString const& path,
+                       vtkSmartPointer<vtkImageData>& data,
+                       QSize& dimensions)
+{
+  QTE_D();
+
+  auto entry = CacheEntry{};
+  if (!d->find(path, entry))
+  {
+    return false;
+  }
+
+  data = entry.data;
+  dimensions = entry.dimensions;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool ImageCache::imageSize(QString const& path, QSize& dimensions) const
+{
+  QTE_D();
+
+  auto entry = CacheEntry{};
+  if (!d->peek(path, entry) || !entry.data)
+  {
+    return false;
+  }
+
+  dimensions = entry.dimensions;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+bool ImageCache::request(QString const& path)
+{
+  QTE_D();
+  return d->request(LoadRequest{path});
+}
+
+//-----------------------------------------------------------------------------
+void ImageCache::prefetch(QStringList const& paths)
+{
+  QTE_D();
+
+  auto requests = QList<LoadRequest>{};
+  foreach (auto const& path, paths)
+  {
+    requests.append(LoadRequest{path});
+  }
+  d->prefetch(requests);
+}
+
+//-----------------------------------------------------------------------------
+void ImageCache::clear()
+{
+  QTE_D();
+  d->clear();
+}
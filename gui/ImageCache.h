@@ -0,0 +1,116 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name Kitware, Inc. nor the names of any contributors may be
+ *    used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MAPTK_IMAGECACHE_H_
+#define MAPTK_IMAGECACHE_H_
+
+#include <qtGlobal.h>
+
+#include <QtCore/QObject>
+#include <QtCore/QSize>
+#include <QtCore/QStringList>
+
+#include <vtkSmartPointer.h>
+
+class vtkImageData;
+
+class ImageCachePrivate;
+
+/// Cache of decoded images, loaded on a background thread
+///
+/// Images are decoded by a worker thread and kept in a least recently used
+/// cache whose total size is bounded by a memory limit. Requested images are
+/// loaded before any prefetched ones; when a requested image is ready,
+/// imageReady() is emitted so that the UI thread can swap it in without
+/// decoding anything itself.
+class ImageCache : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit ImageCache(QObject* parent = 0);
+  virtual ~ImageCache();
+
+  /// Get the memory limit of the cache, in bytes.
+  qint64 memoryLimit() const;
+
+  /// Set the memory limit of the cache, in bytes.
+  ///
+  /// Least recently used images are discarded to stay within the limit. The
+  /// most recently requested image is always kept, even if it alone exceeds
+  /// the limit.
+  void setMemoryLimit(qint64);
+
+  /// Get an image if it has already been decoded.
+  ///
+  /// If the image is in the cache, this returns \c true, and sets \p data to
+  /// the decoded image and \p dimensions to its size. If the image could not
+  /// be read, \p data is set to null. Otherwise, this returns \c false and
+  /// the outputs are not modified.
+  bool image(QString const& path, vtkSmartPointer<vtkImageData>& data,
+             QSize& dimensions);
+
+  /// Get the size of an image if it has already been decoded.
+  ///
+  /// Unlike image(), this does not mark the image as recently used. If the
+  /// image is in the cache and was read successfully, this returns \c true
+  /// and sets \p dimensions to its size.
+  bool imageSize(QString const& path, QSize& dimensions) const;
+
+  /// Request that an image be loaded as soon as possible.
+  ///
+  /// The request replaces any previous one that has not started loading.
+  /// The imageReady() signal is emitted when the image is available, unless
+  /// it was already cached.
+  ///
+  /// \return \c true if the image is already cached
+  bool request(QString const& path);
+
+  /// Set the images to be loaded after the requested one.
+  ///
+  /// Images are loaded in the order given. The list replaces any previous
+  /// prefetch list; images already in the cache are skipped.
+  void prefetch(QStringList const& paths);
+
+  /// Discard all cached images and pending loads.
+  void clear();
+
+signals:
+  /// Emitted when a requested image has been loaded (or failed to load).
+  void imageReady(QString const& path);
+
+private:
+  QTE_DECLARE_PRIVATE_RPTR(ImageCache)
+  QTE_DECLARE_PRIVATE(ImageCache)
+
+  QTE_DISABLE_COPY(ImageCache)
+};
+
+#endif
@@ -0,0 +1,283 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name Kitware, Inc. nor the names of any contributors may be
+ *    used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ImagePyramid.h"
+
+#include <vtkImageData.h>
+#include <vtkImageShrink3D.h>
+#include <vtkNew.h>
+
+#include <QtCore/QMutex>
+#include <QtCore/QThread>
+#include <QtCore/QVector>
+#include <QtCore/QWaitCondition>
+
+namespace // anonymous
+{
+
+// Images whose larger side does not exceed this are displayed directly
+auto const largeImageSize = 4096;
+
+// Larger side of the coarsest level of a pyramid
+auto const coarseLevelSize = 1024;
+
+//-----------------------------------------------------------------------------
+int maxDimension(vtkImageData* data)
+{
+  int dimensions[3];
+  data->GetDimensions(dimensions);
+  return qMax(dimensions[0], dimensions[1]);
+}
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkImageData> shrinkImage(
+  vtkImageData* data, int factor, bool average)
+{
+  vtkNew<vtkImageShrink3D> shrink;
+  shrink->SetInputData(data);
+  shrink->SetShrinkFactors(factor, factor, 1);
+  shrink->SetAveraging(average);
+  shrink->Update();
+
+  // Detach the result from the filter
+  auto const result = vtkSmartPointer<vtkImageData>::New();
+  result->ShallowCopy(shrink->GetOutput());
+  return result;
+}
+
+} // namespace <anonymous>
+
+//-----------------------------------------------------------------------------
+class ImagePyramidPrivate : public QThread
+{
+public:
+  ImagePyramidPrivate(ImagePyramid* q)
+    : generation(0), buildPending(false), stopRequested(false), q_ptr(q) {}
+
+  virtual void run() QTE_OVERRIDE;
+
+  mutable QMutex mutex;
+  QWaitCondition wakeCondition;
+
+  vtkSmartPointer<vtkImageData> source;
+  QVector<vtkSmartPointer<vtkImageData>> levels; // Null if not yet built
+
+  unsigned generation; // Incremented when the source changes
+  bool buildPending;
+  bool stopRequested;
+
+protected:
+  QTE_DECLARE_PUBLIC_PTR(ImagePyramid)
+  QTE_DECLARE_PUBLIC(ImagePyramid)
+};
+
+QTE_IMPLEMENT_D_FUNC(ImagePyramid)
+
+//-----------------------------------------------------------------------------
+void ImagePyramidPrivate::run()
+{
+  QTE_Q();
+
+  QMutexLocker locker(&this->mutex);
+  forever
+  {
+    while (!this->stopRequested && !this->buildPending)
+    {
+      this->wakeCondition.wait(&this->mutex);
+    }
+    if (this->stopRequested)
+    {
+      return;
+    }
+    this->buildPending = false;
+
+    // Build each level from the previous one, without holding the lock; stop
+    // early if the source is changed meanwhile
+    auto const currentGeneration = this->generation;
+    auto const count = this->levels.count();
+    auto previous = this->source;
+    for (int level = 1; level < count; ++level)
+    {
+      locker.unlock();
+      auto const next = shrinkImage(previous, 2, true);
+      locker.relock();
+
+      if (this->generation != currentGeneration || this->stopRequested)
+      {
+        break;
+      }
+
+      this->levels[level] = next;
+      previous = next;
+
+      locker.unlock();
+      emit q->levelReady(level);
+      locker.relock();
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+ImagePyramid::ImagePyramid(QObject* parent)
+  : QObject(parent), d_ptr(new ImagePyramidPrivate(this))
+{
+  QTE_D();
+  d->start(QThread::LowPriority);
+}
+
+//-----------------------------------------------------------------------------
+ImagePyramid::~ImagePyramid()
+{
+  QTE_D();
+
+  d->mutex.lock();
+  d->stopRequested = true;
+  d->wakeCondition.wakeAll();
+  d->mutex.unlock();
+
+  d->wait();
+}
+
+//-----------------------------------------------------------------------------
+void ImagePyramid::setImage(vtkImageData* data)
+{
+  QTE_D();
+
+  auto levels = QVector<vtkSmartPointer<vtkImageData>>();
+  if (data)
+  {
+    levels.append(data);
+
+    auto size = maxDimension(data);
+    if (size > largeImageSize)
+    {
+      while (size > coarseLevelSize)
+      {
+        size /= 2;
+        levels.append(vtkSmartPointer<vtkImageData>());
+      }
+
+      // Subsampling (rather than averaging) only touches the output pixels,
+      // so the coarsest level is available at once as a placeholder; it is
+      // replaced by a filtered version when the pyramid has been built
+      auto const factor = 1 << (levels.count() - 1);
+      levels.last() = shrinkImage(data, factor, false);
+    }
+  }
+
+  QMutexLocker locker(&d->mutex);
+
+  ++d->generation;
+  d->source = data;
+  d->levels = levels;
+  d->buildPending = (levels.count() > 1);
+  d->wakeCondition.wakeAll();
+}
+
+//-----------------------------------------------------------------------------
+vtkImageData* ImagePyramid::image() const
+{
+  QTE_D();
+  QMutexLocker locker(&d->mutex);
+  return d->source;
+}
+
+//-----------------------------------------------------------------------------
+int ImagePyramid::levelCount() const
+{
+  QTE_D();
+  QMutexLocker locker(&d->mutex);
+  return d->levels.count();
+}
+
+//-----------------------------------------------------------------------------
+vtkSmartPointer<vtkImageData> ImagePyramid::level(
+  int level, int* actualLevel) const
+{
+  QTE_D();
+  QMutexLocker locker(&d->mutex);
+
+  auto const count = d->levels.count();
+  for (auto k = qBound(0, level, count - 1); k < count; ++k)
+  {
+    if (d->levels[k])
+    {
+      if (actualLevel)
+      {
+        *actualLevel = k;
+      }
+      return d->levels[k];
+    }
+  }
+
+  if (actualLevel)
+  {
+    *actualLevel = 0;
+  }
+  return vtkSmartPointer<vtkImageData>();
+}
+
+//-----------------------------------------------------------------------------
+int ImagePyramid::levelForSize(int size) const
+{
+  QTE_D();
+  QMutexLocker locker(&d->mutex);
+
+  if (d->levels.isEmpty())
+  {
+    return 0;
+  }
+
+  auto const count = d->levels.count();
+  auto levelSize = maxDimension(d->source);
+  auto level = 0;
+  while (levelSize > size && level + 1 < count)
+  {
+    levelSize /= 2;
+    ++level;
+  }
+  return level;
+}
+
+//-----------------------------------------------------------------------------
+int ImagePyramid::levelForScale(double scale) const
+{
+  QTE_D();
+  QMutexLocker locker(&d->mutex);
+
+  auto const count = d->levels.count();
+  auto level = 0;
+  while (scale >= 2.0 && level + 1 < count)
+  {
+    scale *= 0.5;
+    ++level;
+  }
+  return level;
+}
@@ -0,0 +1,100 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name Kitware, Inc. nor the names of any contributors may be
+ *    used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MAPTK_IMAGEPYRAMID_H_
+#define MAPTK_IMAGEPYRAMID_H_
+
+#include <qtGlobal.h>
+
+#include <QtCore/QObject>
+
+#include <vtkSmartPointer.h>
+
+class vtkImageData;
+
+class ImagePyramidPrivate;
+
+/// Multi-resolution pyramid of an image, built in the background
+///
+/// Level 0 of the pyramid is the image itself; each following level is half
+/// the size of the previous one, down to a coarse level small enough to be
+/// displayed as a single texture. Level images share the world coordinates
+/// of the source (their spacing grows with the level), so any level may be
+/// displayed in place of the source.
+///
+/// Images small enough to be displayed directly have a single level. For
+/// larger images, a coarse (subsampled) level is created immediately as a
+/// placeholder, and properly filtered levels are then built by a worker
+/// thread. The levelReady() signal is emitted as each level becomes
+/// available.
+class ImagePyramid : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit ImagePyramid(QObject* parent = 0);
+  virtual ~ImagePyramid();
+
+  /// Set the source image, and start building its pyramid.
+  void setImage(vtkImageData*);
+
+  /// Get the source image.
+  vtkImageData* image() const;
+
+  /// Get the number of levels in the pyramid, including the source image.
+  int levelCount() const;
+
+  /// Get the best available image for a level.
+  ///
+  /// This returns the image for level \p level if it has been built, or
+  /// otherwise the next coarser level that has been built. If \p actualLevel
+  /// is not null, it is set to the level of the returned image.
+  vtkSmartPointer<vtkImageData> level(int level, int* actualLevel = 0) const;
+
+  /// Get the finest level whose larger dimension does not exceed \p size.
+  int levelForSize(int size) const;
+
+  /// Get the coarsest level with at least one pixel per screen pixel.
+  ///
+  /// \param scale Number of source image pixels per screen pixel.
+  int levelForScale(double scale) const;
+
+signals:
+  /// Emitted when a level of the pyramid has been built.
+  void levelReady(int level);
+
+private:
+  QTE_DECLARE_PRIVATE_RPTR(ImagePyramid)
+  QTE_DECLARE_PRIVATE(ImagePyramid)
+
+  QTE_DISABLE_COPY(ImagePyramid)
+};
+
+#endif
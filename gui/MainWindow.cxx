@@ -39,20 +39,21 @@
 #include "tools/NeckerReversalTool.h"
 
 #include "AboutDialog.h"
+#include "DepthMapCache.h"
+#include "ImageCache.h"
+#include "ImagePyramid.h"
 #include "MatchMatrixWindow.h"
 #include "Project.h"
+#include "ProjectLoader.h"
 #include "vtkMaptkImageDataGeometryFilter.h"
-#include "vtkMaptkImageUnprojectDepth.h"
 #include "vtkMaptkCamera.h"
 
+#include <maptk/match_matrix_builder.h>
 #include <maptk/version.h>
 
 #include <vital/io/camera_io.h>
 #include <vital/io/landmark_map_io.h>
 #include <vital/io/track_set_io.h>
-#include <arrows/core/match_matrix.h>
-
-#include <vtksys/SystemTools.hxx>
 
 #include <vtkImageData.h>
 #include <vtkImageReader2.h>
@@ -61,7 +62,7 @@
 #include <vtkNew.h>
 #include <vtkPolyData.h>
 #include <vtkSmartPointer.h>
-#include <vtkXMLImageDataReader.h>
+#include <vtkTrivialProducer.h>
 
 #include <qtEnumerate.h>
 #include <qtIndexRange.h>
@@ -74,9 +75,13 @@
 #include <QtGui/QColorDialog>
 #include <QtGui/QDesktopServices>
 #include <QtGui/QFileDialog>
+#include <QtGui/QInputDialog>
 #include <QtGui/QMessageBox>
+#include <QtGui/QProgressBar>
+#include <QtGui/QStatusBar>
 
 #include <QtCore/QDebug>
+#include <QtCore/QElapsedTimer>
 #include <QtCore/QQueue>
 #include <QtCore/QSignalMapper>
 #include <QtCore/QTimer>
@@ -89,6 +94,10 @@
 namespace // anonymous
 {
 
+// Minimum interval between rebuilds of the cameras from intermediate tool
+// results, in milliseconds
+static auto const cameraUpdateInterval = 1000;
+
 //-----------------------------------------------------------------------------
 kwiver::vital::path_t kvPath(QString const& s)
 {
@@ -181,6 +190,28 @@ QString makeFilters(QStringList extensions)
   return result.join(" ");
 }
 
+//-----------------------------------------------------------------------------
+bool sameCamera(kwiver::vital::camera_sptr const& a,
+                kwiver::vital::camera_sptr const& b)
+{
+  if (a == b)
+  {
+    return true;
+  }
+  if (!a || !b)
+  {
+    return false;
+  }
+
+  auto const& ka = a->intrinsics();
+  auto const& kb = b->intrinsics();
+  return a->center() == b->center() &&
+         a->rotation().quaternion().coeffs() ==
+           b->rotation().quaternion().coeffs() &&
+         ka->as_matrix() == kb->as_matrix() &&
+         ka->dist_coeffs() == kb->dist_coeffs();
+}
+
 //-----------------------------------------------------------------------------
 template <typename T>
 class StateValue : public qtUiState::AbstractItem
@@ -230,10 +261,15 @@ public:
 
     QString imagePath; // Full path to camera image data
     QString depthMapPath; // Full path to depth map data
+
+    QSize imageSize; // Size of the camera image, once it has been decoded
   };
 
   // Methods
-  MainWindowPrivate() : activeTool(0), activeCameraIndex(-1) {}
+  MainWindowPrivate()
+    : activeTool(0), toolUpdateQueued(false),
+      activeCameraIndex(-1), slideDirection(1),
+      projectFrameOffset(0), resetViewOnLandmarks(false), loadProgress(0) {}
 
   void addTool(AbstractTool* tool, MainWindow* mainWindow);
 
@@ -246,12 +282,20 @@ public:
   kwiver::vital::camera_map_sptr cameraMap() const;
   void updateCameras(kwiver::vital::camera_map_sptr const&);
 
+  void setLandmarks(kwiver::vital::landmark_map_sptr const&);
+  bool moveLandmarks(ToolData const&);
+
+  void applyTracks(kwiver::vital::track_set_sptr const&);
+  void applyLandmarks(kwiver::vital::landmark_map_sptr const&);
+
   void setActiveCamera(int);
   void updateCameraView();
 
   void loadImage(QString const& path, vtkMaptkCamera* camera);
+  void prefetchFrames(int id);
 
-  void loadDepthMap(QString const& imagePath);
+  void loadDepthMap(QString const& path);
+  void reloadDepthMaps();
 
   void setActiveTool(AbstractTool* tool);
 
@@ -261,6 +305,7 @@ public:
   qtUiState uiState;
 
   StateValue<QColor>* viewBackgroundColor;
+  StateValue<int>* toolUpdateInterval;
 
   QTimer slideTimer;
   QSignalMapper toolDispatcher;
@@ -268,21 +313,50 @@ public:
   QAction* toolSeparator;
   AbstractTool* activeTool;
   QList<AbstractTool*> tools;
+  bool toolUpdateQueued;
   kwiver::vital::camera_map_sptr toolUpdateCameras;
-  kwiver::vital::landmark_map_sptr toolUpdateLandmarks;
+  std::shared_ptr<ToolData> toolUpdateLandmarks;
   kwiver::vital::track_set_sptr toolUpdateTracks;
 
+  // Rebuilding the cameras is expensive, so intermediate cameras are applied
+  // at most once per cameraUpdateInterval; toolCameraTimer applies any that
+  // arrive sooner once the interval has elapsed
+  QElapsedTimer lastToolCameraUpdate;
+  QTimer toolCameraTimer;
+
   QList<CameraData> cameras;
   kwiver::vital::track_set_sptr tracks;
   kwiver::vital::landmark_map_sptr landmarks;
 
+  // Landmark positions stored contiguously (one per column) for batch
+  // projection, with the corresponding landmark IDs
+  Eigen::Matrix3Xd landmarkPositions;
+  QVector<kwiver::vital::landmark_id_t> landmarkIds;
+  QHash<kwiver::vital::landmark_id_t, int> landmarkIndices;
+
+  // Match matrix counts, updated incrementally when the tracks change
+  kwiver::maptk::match_matrix_builder matchMatrix{0};
+
   int activeCameraIndex;
+  int slideDirection;
+
+  ImageCache imageCache;
+  ImagePyramid imagePyramid;
+  QString pendingImagePath;
+
+  DepthMapCache depthMapCache;
+  QString depthMapPath; // Depth map currently shown
+  QString pendingDepthMapPath;
 
   QQueue<int> orphanImages;
   QQueue<int> orphanCameras;
 
-  vtkNew<vtkXMLImageDataReader> depthReader;
-  vtkNew<vtkMaptkImageUnprojectDepth> depthFilter;
+  ProjectLoader projectLoader;
+  int projectFrameOffset; // Index of the first frame of the loading project
+  bool resetViewOnLandmarks;
+  QProgressBar* loadProgress;
+
+  vtkNew<vtkTrivialProducer> depthSource;
   vtkNew<vtkMaptkImageDataGeometryFilter> depthGeometryFilter;
 };
 
@@ -417,6 +491,7 @@ void MainWindowPrivate::updateCameras(
 {
   auto const cameraCount = this->cameras.count();
   auto allowExport = false;
+  auto activeDepthMapChanged = false;
 
   foreach (auto const& iter, cameras->cameras())
   {
@@ -424,6 +499,15 @@ void MainWindowPrivate::updateCameras(
     if (index >= 0 && index < cameraCount && iter.second)
     {
       auto& cd = this->cameras[index];
+      if (!cd.depthMapPath.isEmpty() &&
+          (!cd.camera || !sameCamera(cd.camera->GetCamera(), iter.second)))
+      {
+        // Cached copies of the depth map were unprojected using the old
+        // camera (or none); those of unchanged cameras are kept
+        this->depthMapCache.invalidate(cd.depthMapPath);
+        activeDepthMapChanged =
+          activeDepthMapChanged || cd.id == this->activeCameraIndex;
+      }
       if (!cd.camera)
       {
         cd.camera = vtkSmartPointer<vtkMaptkCamera>::New();
@@ -443,20 +527,147 @@ void MainWindowPrivate::updateCameras(
   }
 
   this->UI.actionExportCameras->setEnabled(allowExport);
+
+  if (activeDepthMapChanged || this->depthMapPath.isEmpty())
+  {
+    // Show the active depth map, unprojected using the new camera
+    this->depthMapPath.clear();
+    if (this->activeCameraIndex >= 0)
+    {
+      auto const& cd = this->cameras[this->activeCameraIndex];
+      if (!cd.depthMapPath.isEmpty())
+      {
+        this->loadDepthMap(cd.depthMapPath);
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void MainWindowPrivate::reloadDepthMaps()
+{
+  // Discard cached depth maps, and reload the active one
+  this->depthMapCache.clear();
+  this->depthMapPath.clear();
+  if (this->activeCameraIndex >= 0)
+  {
+    auto const& cd = this->cameras[this->activeCameraIndex];
+    if (!cd.depthMapPath.isEmpty())
+    {
+      this->loadDepthMap(cd.depthMapPath);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void MainWindowPrivate::setLandmarks(
+  kwiver::vital::landmark_map_sptr const& newLandmarks)
+{
+  this->landmarks = newLandmarks;
+
+  auto const count =
+    static_cast<int>(newLandmarks ? newLandmarks->size() : 0);
+  this->landmarkPositions.resize(3, count);
+  this->landmarkIds.resize(count);
+  this->landmarkIndices.clear();
+  this->landmarkIndices.reserve(count);
+
+  if (newLandmarks)
+  {
+    auto i = 0;
+    foreach (auto const& lm, newLandmarks->landmarks())
+    {
+      this->landmarkPositions.col(i) = lm.second->loc();
+      this->landmarkIds[i] = lm.first;
+      this->landmarkIndices.insert(lm.first, i);
+      ++i;
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+bool MainWindowPrivate::moveLandmarks(ToolData const& data)
+{
+  // Only an update that moves existing landmarks can be applied incrementally
+  if (!data.landmarksMoved || !this->landmarks || !data.landmarks)
+  {
+    return false;
+  }
+
+  auto moved = QVector<int>{};
+  moved.reserve(static_cast<int>(data.movedLandmarks.size()));
+  for (auto const& m : data.movedLandmarks)
+  {
+    auto const i = this->landmarkIndices.value(m.first, -1);
+    if (i < 0)
+    {
+      return false;
+    }
+    moved.append(i);
+  }
+
+  auto k = 0;
+  for (auto const& m : data.movedLandmarks)
+  {
+    this->landmarkPositions.col(moved[k++]) = m.second;
+  }
+  this->landmarks = data.landmarks;
+
+  if (!moved.isEmpty())
+  {
+    this->UI.worldView->moveLandmarks(this->landmarkPositions, moved);
+  }
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void MainWindowPrivate::applyTracks(
+  kwiver::vital::track_set_sptr const& newTracks)
+{
+  this->tracks = newTracks;
+  this->updateCameraView();
+
+  this->UI.cameraView->setFeatureTracks(newTracks);
+
+  this->UI.actionShowMatchMatrix->setEnabled(!newTracks->tracks().empty());
+}
+
+//-----------------------------------------------------------------------------
+void MainWindowPrivate::applyLandmarks(
+  kwiver::vital::landmark_map_sptr const& newLandmarks)
+{
+  this->setLandmarks(newLandmarks);
+  this->UI.worldView->setLandmarks(*newLandmarks);
+  this->UI.cameraView->setLandmarksData(*newLandmarks);
+
+  this->UI.actionExportLandmarks->setEnabled(
+    this->landmarks && this->landmarks->size());
+
+  this->updateCameraView();
 }
 
 //-----------------------------------------------------------------------------
 void MainWindowPrivate::setActiveCamera(int id)
 {
+  if (id != this->activeCameraIndex && this->activeCameraIndex >= 0)
+  {
+    this->slideDirection = (id < this->activeCameraIndex ? -1 : 1);
+  }
+
   this->activeCameraIndex = id;
   this->UI.worldView->setActiveCamera(id);
   this->updateCameraView();
+  this->prefetchFrames(id);
 
   auto& cd = this->cameras[id];
   if (!cd.depthMapPath.isEmpty())
   {
     this->loadDepthMap(cd.depthMapPath);
   }
+  else
+  {
+    this->pendingDepthMapPath.clear();
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -473,8 +684,6 @@ void MainWindowPrivate::updateCameraView()
   this->UI.cameraView->setActiveFrame(
     static_cast<unsigned>(this->activeCameraIndex));
 
-  QHash<kwiver::vital::track_id_t, kwiver::vital::vector_2d> landmarkPoints;
-
   auto const& cd = this->cameras[this->activeCameraIndex];
 
   // Show camera image
@@ -491,27 +700,36 @@ void MainWindowPrivate::updateCameraView()
 
   // Show landmarks
   this->UI.cameraView->clearLandmarks();
+  auto projectedIndices = std::vector<int>{};
+  auto projectedPoints = Eigen::Matrix2Xd{};
   if (this->landmarks)
   {
-    // Map landmarks to camera space
-    auto const& landmarks = this->landmarks->landmarks();
-    foreach (auto const& lm, landmarks)
+    // Map landmarks to camera space in one batch, culling those outside the
+    // camera frustum, and add them to the camera view in one call
+    cd.camera->ProjectPoints(this->landmarkPositions,
+                             projectedIndices, projectedPoints);
+
+    auto ids = QVector<kwiver::vital::landmark_id_t>{};
+    ids.reserve(static_cast<int>(projectedIndices.size()));
+    foreach (auto const i, projectedIndices)
     {
-      double pp[2];
-      if (cd.camera->ProjectPoint(lm.second->loc(), pp))
-      {
-        // Add projected landmark to camera view
-        auto const id = lm.first;
-        this->UI.cameraView->addLandmark(id, pp[0], pp[1]);
-        landmarkPoints.insert(id, kwiver::vital::vector_2d(pp[0], pp[1]));
-      }
+      ids.append(this->landmarkIds[i]);
     }
+
+    this->UI.cameraView->addLandmarks(ids, projectedPoints);
   }
 
   // Show residuals
   this->UI.cameraView->clearResiduals();
-  if (this->tracks)
+  if (this->tracks && this->landmarks)
   {
+    // Map landmark indices to their projections
+    auto projectedColumns = QVector<int>(this->landmarkIds.count(), -1);
+    for (int k = 0; k < static_cast<int>(projectedIndices.size()); ++k)
+    {
+      projectedColumns[projectedIndices[k]] = k;
+    }
+
     auto const& tracks = this->tracks->tracks();
     foreach (auto const& track, tracks)
     {
@@ -519,12 +737,28 @@ void MainWindowPrivate::updateCameraView()
       if (state != track->end() && state->feat)
       {
         auto const id = track->id();
-        if (landmarkPoints.contains(id))
+        auto const i = this->landmarkIndices.value(id, -1);
+        if (i < 0)
         {
-          auto const& fp = state->feat->loc();
-          auto const& lp = landmarkPoints[id];
-          this->UI.cameraView->addResidual(id, fp[0], fp[1], lp[0], lp[1]);
+          continue;
         }
+
+        // Landmarks culled for being outside the image still have residuals
+        // if they are in front of the camera
+        double lp[2];
+        auto const k = projectedColumns[i];
+        if (k >= 0)
+        {
+          lp[0] = projectedPoints(0, k);
+          lp[1] = projectedPoints(1, k);
+        }
+        else if (!cd.camera->ProjectPoint(this->landmarkPositions.col(i), lp))
+        {
+          continue;
+        }
+
+        auto const& fp = state->feat->loc();
+        this->UI.cameraView->addResidual(id, fp[0], fp[1], lp[0], lp[1]);
       }
     }
   }
@@ -533,6 +767,8 @@ void MainWindowPrivate::updateCameraView()
 //-----------------------------------------------------------------------------
 void MainWindowPrivate::loadImage(QString const& path, vtkMaptkCamera* camera)
 {
+  this->pendingImagePath.clear();
+
   if (path.isEmpty())
   {
     auto imageDimensions = QSize(1, 1);
@@ -543,78 +779,156 @@ void MainWindowPrivate::loadImage(QString const& path, vtkMaptkCamera* camera)
       imageDimensions = QSize(w, h);
     }
 
+    this->imagePyramid.setImage(0);
     this->UI.cameraView->setImageData(0, imageDimensions);
     this->UI.worldView->setImageData(0, imageDimensions);
   }
   else
   {
-    // Create a reader capable of reading the image file
-    auto const reader =
-      vtkImageReader2Factory::CreateImageReader2(qPrintable(path));
-    if (!reader)
+    // Images are decoded in the background; if this one is not ready yet,
+    // keep showing the current image until the cache reports that it is
+    auto data = vtkSmartPointer<vtkImageData>{};
+    auto dimensions = QSize{};
+    if (!this->imageCache.request(path) ||
+        !this->imageCache.image(path, data, dimensions))
     {
-      qWarning() << "Failed to create image reader for image" << path;
-      this->loadImage(QString(), camera);
+      this->pendingImagePath = path;
       return;
     }
 
-    // Load the image
-    reader->SetFileName(qPrintable(path));
-    reader->Update();
-
-    // Get dimensions
-    auto const data = reader->GetOutput();
-    int dimensions[3];
-    data->GetDimensions(dimensions);
-
-    // Test for errors
-    if (dimensions[0] < 2 || dimensions[1] < 2)
+    if (!data)
     {
-      qWarning() << "Failed to read image" << path;
+      // Image failed to load
       this->loadImage(QString(), camera);
+      return;
     }
-    else
+
+    // Update camera image dimensions
+    if (camera)
     {
-      // If successful, update camera image dimensions
-      if (camera)
+      camera->SetImageDimensions(dimensions.width(), dimensions.height());
+    }
+    if (this->activeCameraIndex >= 0)
+    {
+      this->cameras[this->activeCameraIndex].imageSize = dimensions;
+    }
+
+    // Set image on views; large images are displayed using a pyramid
+    this->imagePyramid.setImage(data);
+    this->UI.cameraView->setImageData(data, dimensions);
+    this->UI.worldView->setImageData(data, dimensions);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void MainWindowPrivate::prefetchFrames(int id)
+{
+  static auto const prefetchCount = 4;
+
+  auto const count = this->cameras.count();
+  auto const wrap = this->UI.actionSlideshowLoop->isChecked();
+
+  // Queue images ahead of the camera in the playback direction first, then
+  // the ones behind it
+  auto const directions =
+    QList<int>() << this->slideDirection << -this->slideDirection;
+
+  auto paths = QStringList();
+  auto depthMaps = QList<DepthMapCache::Request>();
+  foreach (auto const direction, directions)
+  {
+    for (int n = 1; n <= prefetchCount; ++n)
+    {
+      auto i = id + (direction * n);
+      if (wrap)
+      {
+        i = ((i % count) + count) % count;
+      }
+      else if (i < 0 || i >= count)
       {
-        camera->SetImageDimensions(dimensions);
+        break;
       }
 
-      // Set image on views
-      auto const size = QSize(dimensions[0], dimensions[1]);
-      this->UI.cameraView->setImageData(data, size);
-      this->UI.worldView->setImageData(data, size);
-    }
+      auto& cd = this->cameras[i];
+      paths.append(cd.imagePath);
 
-    // Delete the reader
-    reader->Delete();
+      // Depth maps are unprojected for the size of their camera image, so
+      // they are only prefetched once the image has been decoded
+      if (!cd.depthMapPath.isEmpty() &&
+          (cd.imageSize.isValid() ||
+           this->imageCache.imageSize(cd.imagePath, cd.imageSize)))
+      {
+        depthMaps.append(DepthMapCache::Request{
+          cd.depthMapPath, cd.camera.GetPointer(), cd.imageSize});
+      }
+    }
   }
-}
 
+  this->imageCache.prefetch(paths);
+  this->depthMapCache.prefetch(depthMaps);
+}
 
 //-----------------------------------------------------------------------------
-void MainWindowPrivate::loadDepthMap(QString const& imagePath)
+void MainWindowPrivate::loadDepthMap(QString const& path)
 {
-  if (!vtksys::SystemTools::FileExists(qPrintable(imagePath), true))
+  this->pendingDepthMapPath.clear();
+
+  if (path == this->depthMapPath)
+  {
+    // No change to depth map... return without any update
+    return;
+  }
+
+  auto camera = vtkSmartPointer<vtkMaptkCamera>{};
+  auto imageSize = QSize{};
+  if (this->activeCameraIndex >= 0)
+  {
+    auto const& cd = this->cameras[this->activeCameraIndex];
+    camera = cd.camera;
+    imageSize = cd.imageSize;
+  }
+
+  // The depth map is unprojected for the size of the camera image, so wait
+  // until the image has been decoded; if it could not be, fall back to the
+  // dimensions the camera estimates from its principal point
+  if (!imageSize.isValid())
+  {
+    if (!this->pendingImagePath.isEmpty())
+    {
+      this->pendingDepthMapPath = path;
+      return;
+    }
+    if (camera)
+    {
+      int w, h;
+      camera->GetImageDimensions(w, h);
+      imageSize = QSize(w, h);
+    }
+  }
+
+  // Depth maps are read and unprojected in the background; if this one is
+  // not ready yet, keep showing the current one until the cache reports that
+  // it is
+  auto data = vtkSmartPointer<vtkImageData>{};
+  if (!this->depthMapCache.request(path, camera, imageSize) ||
+      !this->depthMapCache.depthMap(path, imageSize, data))
   {
-    qWarning() << "File doesn't exist: " << imagePath;
+    this->pendingDepthMapPath = path;
     return;
   }
 
-  if (this->depthReader->GetFileName() &&
-    !strcmp(this->depthReader->GetFileName(), qPrintable(imagePath)))
+  if (!data)
   {
-    // No change to reader input... return without any update
+    // Depth map failed to load
     return;
   }
 
-  this->depthReader->SetFileName(qPrintable(imagePath));
+  this->depthMapPath = path;
+  this->depthSource->SetOutput(data);
 
   this->UI.depthMapView->setValidDepthInput(true);
   this->UI.worldView->setValidDepthInput(true);
 
-  this->depthFilter->SetCamera(this->cameras[this->activeCameraIndex].camera);
   this->UI.worldView->updateDepthMap();
   this->UI.depthMapView->updateView(true);
   this->UI.actionExportDepthPoints->setEnabled(true);
@@ -702,6 +1016,12 @@ MainWindow::MainWindow(QWidget* parent, Qt::WindowFlags flags)
 
   connect(d->UI.actionSetBackgroundColor, SIGNAL(triggered()),
           this, SLOT(setViewBackroundColor()));
+  connect(d->UI.actionSetToolUpdateInterval, SIGNAL(triggered()),
+          this, SLOT(setToolUpdateInterval()));
+
+  d->toolCameraTimer.setSingleShot(true);
+  connect(&d->toolCameraTimer, SIGNAL(timeout()),
+          this, SLOT(updateToolResults()));
 
   connect(d->UI.actionAbout, SIGNAL(triggered()),
           this, SLOT(showAboutDialog()));
@@ -717,12 +1037,35 @@ MainWindow::MainWindow(QWidget* parent, Qt::WindowFlags flags)
   connect(d->UI.camera, SIGNAL(valueChanged(int)),
           this, SLOT(setActiveCamera(int)));
 
+  connect(&d->imageCache, SIGNAL(imageReady(QString)),
+          this, SLOT(showLoadedImage(QString)));
+  connect(&d->depthMapCache, SIGNAL(depthMapReady(QString)),
+          this, SLOT(showLoadedDepthMap(QString)));
+
   connect(d->UI.worldView, SIGNAL(depthMapThresholdsChanged()),
           d->UI.depthMapView, SLOT(updateThresholds()));
 
   connect(d->UI.depthMapViewDock, SIGNAL(visibilityChanged(bool)),
           d->UI.depthMapView, SLOT(updateView(bool)));
 
+  connect(&d->projectLoader, SIGNAL(camerasLoaded()),
+          this, SLOT(acceptProjectCameras()));
+  connect(&d->projectLoader, SIGNAL(tracksLoaded()),
+          this, SLOT(acceptProjectTracks()));
+  connect(&d->projectLoader, SIGNAL(landmarksLoaded()),
+          this, SLOT(acceptProjectLandmarks()));
+  connect(&d->projectLoader, SIGNAL(progressChanged(QString, int, int)),
+          this, SLOT(updateProjectProgress(QString, int, int)));
+  connect(&d->projectLoader, SIGNAL(finished()),
+          this, SLOT(finishProjectLoad()));
+
+  // Project loading progress is shown in the status bar, which is only
+  // visible while a project is loading
+  d->loadProgress = new QProgressBar;
+  d->loadProgress->setMaximumWidth(240);
+  this->statusBar()->addPermanentWidget(d->loadProgress);
+  this->statusBar()->hide();
+
   this->setSlideDelay(d->UI.slideDelay->value());
 
 #ifdef VTKWEBGLEXPORTER
@@ -739,6 +1082,10 @@ MainWindow::MainWindow(QWidget* parent, Qt::WindowFlags flags)
   d->viewBackgroundColor = new StateValue<QColor>{Qt::black},
   d->uiState.map("ViewBackground", d->viewBackgroundColor);
 
+  d->toolUpdateInterval =
+    new StateValue<int>{AbstractTool::defaultUpdateInterval()};
+  d->uiState.map("ToolUpdateInterval", d->toolUpdateInterval);
+
   d->uiState.mapChecked("WorldView/Axes", d->UI.actionShowWorldAxes);
 
   d->uiState.mapState("Window/state", this);
@@ -749,9 +1096,16 @@ MainWindow::MainWindow(QWidget* parent, Qt::WindowFlags flags)
   d->UI.cameraView->setBackgroundColor(*d->viewBackgroundColor);
   d->UI.depthMapView->setBackgroundColor(*d->viewBackgroundColor);
 
+  foreach (auto const& tool, d->tools)
+  {
+    tool->setUpdateInterval(*d->toolUpdateInterval);
+  }
+
+  d->UI.cameraView->setImagePyramid(&d->imagePyramid);
+  d->UI.worldView->setImagePyramid(&d->imagePyramid);
+
   // Hookup basic depth pipeline and pass geometry filter to relevant views
-  d->depthFilter->SetInputConnection(d->depthReader->GetOutputPort());
-  d->depthGeometryFilter->SetInputConnection(d->depthFilter->GetOutputPort());
+  d->depthGeometryFilter->SetInputConnection(d->depthSource->GetOutputPort());
   d->UI.worldView->setDepthGeometryFilter(d->depthGeometryFilter.GetPointer());
   d->UI.depthMapView->setDepthGeometryFilter(d->depthGeometryFilter.GetPointer());
 
@@ -840,19 +1194,9 @@ void MainWindow::loadProject(QString const& path)
     return;
   }
 
-  // Load tracks
-  if (!project.tracks.isEmpty())
-  {
-    this->loadTracks(project.tracks);
-  }
-
-  // Load landmarks
-  if (!project.landmarks.isEmpty())
-  {
-    this->loadLandmarks(project.landmarks);
-  }
-
-  // Load cameras and/or images
+  // Add frames at once, so that images can be shown while the cameras,
+  // tracks and landmarks are loaded in the background
+  d->projectFrameOffset = d->cameras.count();
   if (project.cameraPath.isEmpty())
   {
     foreach (auto const& ip, project.images)
@@ -862,27 +1206,14 @@ void MainWindow::loadProject(QString const& path)
   }
   else
   {
-    auto const cameraDir = kwiver::vital::path_t(kvPath(project.cameraPath));
     foreach (auto const& ip, project.images)
     {
-      try
-      {
-        auto const& camera =
-          kwiver::vital::read_krtd_file(kvPath(ip), cameraDir);
-
-        // Add camera to scene
-        d->addFrame(camera, ip);
-      }
-      catch (...)
-      {
-        qWarning() << "failed to read camera for" << ip
-                   << "from" << project.cameraPath;
-        d->addFrame(kwiver::vital::camera_sptr(), ip);
-      }
+      d->addFrame(kwiver::vital::camera_sptr(), ip);
     }
   }
 
-  // Associate depth maps with cameras
+  // Associate depth maps with cameras; they are loaded once the cameras are
+  // available, as they must be unprojected using the cameras
   foreach (auto dm, qtEnumerate(project.depthMaps))
   {
     auto const i = dm.key();
@@ -890,18 +1221,108 @@ void MainWindow::loadProject(QString const& path)
     {
       d->cameras[i].depthMapPath = dm.value();
     }
-
-    if (i == d->activeCameraIndex)
-    {
-      d->loadDepthMap(dm.value());
-    }
   }
 
+  this->updateProjectProgress("Loading project...", 0, 0);
+  d->projectLoader.load(project);
+
 #ifdef VTKWEBGLEXPORTER
   d->UI.actionWebGLScene->setEnabled(true);
 #endif
+}
 
-  d->UI.worldView->resetView();
+//-----------------------------------------------------------------------------
+void MainWindow::acceptProjectCameras()
+{
+  QTE_D();
+
+  auto const& cameras = d->projectLoader.takeCameras();
+  if (!cameras)
+  {
+    return;
+  }
+
+  if (cameras->size())
+  {
+    // Loaded cameras are keyed by their index in the project; map them to
+    // the frames that were added for the project
+    auto map = kwiver::vital::camera_map::map_camera_t{};
+    foreach (auto const& iter, cameras->cameras())
+    {
+      auto const frame = iter.first + d->projectFrameOffset;
+      map.insert(std::make_pair(frame, iter.second));
+    }
+
+    d->updateCameras(std::make_shared<kwiver::vital::simple_camera_map>(map));
+    d->UI.worldView->resetView();
+  }
+  else
+  {
+    d->reloadDepthMaps();
+  }
+
+  // Without cameras, there is nothing to show until landmarks are loaded
+  d->resetViewOnLandmarks = !cameras->size();
+
+  if (d->activeCameraIndex >= 0)
+  {
+    d->prefetchFrames(d->activeCameraIndex);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void MainWindow::acceptProjectTracks()
+{
+  QTE_D();
+
+  auto const& tracks = d->projectLoader.takeTracks();
+  if (tracks)
+  {
+    d->applyTracks(tracks);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void MainWindow::acceptProjectLandmarks()
+{
+  QTE_D();
+
+  auto const& landmarks = d->projectLoader.takeLandmarks();
+  if (landmarks)
+  {
+    d->applyLandmarks(landmarks);
+
+    if (d->resetViewOnLandmarks)
+    {
+      d->UI.worldView->resetView();
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void MainWindow::updateProjectProgress(
+  QString const& status, int value, int maximum)
+{
+  QTE_D();
+
+  d->loadProgress->setRange(0, maximum);
+  d->loadProgress->setValue(value);
+
+  this->statusBar()->showMessage(status);
+  this->statusBar()->show();
+}
+
+//-----------------------------------------------------------------------------
+void MainWindow::finishProjectLoad()
+{
+  QTE_D();
+
+  // Ignore completion of an abandoned load
+  if (!d->projectLoader.isLoading())
+  {
+    this->statusBar()->clearMessage();
+    this->statusBar()->hide();
+  }
 }
 
 //-----------------------------------------------------------------------------
@@ -937,15 +1358,7 @@ void MainWindow::loadTracks(QString const& path)
     auto const& tracks = kwiver::vital::read_track_file(kvPath(path));
     if (tracks)
     {
-      d->tracks = tracks;
-      d->updateCameraView();
-
-      foreach (auto const& track, tracks->tracks())
-      {
-        d->UI.cameraView->addFeatureTrack(*track);
-      }
-
-      d->UI.actionShowMatchMatrix->setEnabled(!tracks->tracks().empty());
+      d->applyTracks(tracks);
     }
   }
   catch (...)
@@ -964,14 +1377,7 @@ void MainWindow::loadLandmarks(QString const& path)
     auto const& landmarks = kwiver::vital::read_ply_file(kvPath(path));
     if (landmarks)
     {
-      d->landmarks = landmarks;
-      d->UI.worldView->setLandmarks(*landmarks);
-      d->UI.cameraView->setLandmarksData(*landmarks);
-
-      d->UI.actionExportLandmarks->setEnabled(
-        d->landmarks && d->landmarks->size());
-
-      d->updateCameraView();
+      d->applyLandmarks(landmarks);
     }
   }
   catch (...)
@@ -1208,6 +1614,12 @@ void MainWindow::nextSlide()
 {
   QTE_D();
 
+  if (!d->pendingImagePath.isEmpty() || !d->pendingDepthMapPath.isEmpty())
+  {
+    // Don't advance past an image or depth map that is still being loaded
+    return;
+  }
+
   if (d->UI.camera->value() == d->UI.camera->maximum())
   {
     if (d->UI.actionSlideshowLoop->isChecked())
@@ -1240,6 +1652,35 @@ void MainWindow::setActiveCamera(int id)
   d->setActiveCamera(id);
 }
 
+//-----------------------------------------------------------------------------
+void MainWindow::showLoadedImage(QString const& path)
+{
+  QTE_D();
+
+  if (path == d->pendingImagePath && d->activeCameraIndex >= 0)
+  {
+    auto const& cd = d->cameras[d->activeCameraIndex];
+    d->loadImage(cd.imagePath, cd.camera);
+
+    // A depth map may have been waiting for the size of the image
+    if (!d->pendingDepthMapPath.isEmpty())
+    {
+      d->loadDepthMap(cd.depthMapPath);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void MainWindow::showLoadedDepthMap(QString const& path)
+{
+  QTE_D();
+
+  if (path == d->pendingDepthMapPath && d->activeCameraIndex >= 0)
+  {
+    d->loadDepthMap(d->cameras[d->activeCameraIndex].depthMapPath);
+  }
+}
+
 //-----------------------------------------------------------------------------
 void MainWindow::executeTool(QObject* object)
 {
@@ -1275,27 +1716,25 @@ void MainWindow::acceptToolFinalResults()
 void MainWindow::acceptToolResults(std::shared_ptr<ToolData> data)
 {
   QTE_D();
-  // if all the update variables are Null then trigger a GUI update after
-  // extracting the data otherwise we've already triggered an update that
-  // hasn't happened yet, so don't trigger another
-  bool updateNeeded = !d->toolUpdateCameras &&
-                      !d->toolUpdateLandmarks &&
-                      !d->toolUpdateTracks;
 
   if (d->activeTool)
   {
     auto const outputs = d->activeTool->outputs();
 
-    d->toolUpdateCameras = NULL;
-    d->toolUpdateLandmarks = NULL;
-    d->toolUpdateTracks = NULL;
+    // Results that have not been applied yet are replaced by newer ones
     if (outputs.testFlag(AbstractTool::Cameras))
     {
       d->toolUpdateCameras = data->cameras;
     }
     if (outputs.testFlag(AbstractTool::Landmarks))
     {
-      d->toolUpdateLandmarks = data->landmarks;
+      // The new landmark moves are relative to the landmarks being replaced,
+      // so combine them with any moves that were not yet applied
+      if (d->toolUpdateLandmarks)
+      {
+        data->mergeLandmarkMoves(*d->toolUpdateLandmarks);
+      }
+      d->toolUpdateLandmarks = data;
     }
     if (outputs.testFlag(AbstractTool::Tracks))
     {
@@ -1303,9 +1742,12 @@ void MainWindow::acceptToolResults(std::shared_ptr<ToolData> data)
     }
   }
 
-  if(updateNeeded)
+  // Tools limit how often they report progress, so apply the results as
+  // soon as possible, unless an update is already waiting to run
+  if (!d->toolUpdateQueued)
   {
-    QTimer::singleShot(1000, this, SLOT(updateToolResults()));
+    d->toolUpdateQueued = true;
+    QTimer::singleShot(0, this, SLOT(updateToolResults()));
   }
 }
 
@@ -1314,35 +1756,60 @@ void MainWindow::updateToolResults()
 {
   QTE_D();
 
+  d->toolUpdateQueued = false;
+
+  auto camerasUpdated = false;
   if (d->toolUpdateCameras)
   {
-    d->updateCameras(d->toolUpdateCameras);
-    d->toolUpdateCameras = NULL;
+    // Intermediate cameras (i.e. while a tool is running) are applied at most
+    // once per cameraUpdateInterval; final results are applied immediately
+    auto const remaining =
+      (d->activeTool && d->lastToolCameraUpdate.isValid()
+       ? cameraUpdateInterval -
+         static_cast<int>(d->lastToolCameraUpdate.elapsed())
+       : 0);
+    if (remaining > 0)
+    {
+      if (!d->toolCameraTimer.isActive())
+      {
+        d->toolCameraTimer.start(remaining);
+      }
+    }
+    else
+    {
+      d->toolCameraTimer.stop();
+      d->updateCameras(d->toolUpdateCameras);
+      d->toolUpdateCameras = NULL;
+      d->lastToolCameraUpdate.start();
+      camerasUpdated = true;
+    }
   }
   if (d->toolUpdateLandmarks)
   {
-    d->landmarks = d->toolUpdateLandmarks;
-    d->UI.worldView->setLandmarks(*d->landmarks);
+    // Intermediate results usually only move landmarks, which is much cheaper
+    // to apply than a new set of landmarks
+    if (!d->moveLandmarks(*d->toolUpdateLandmarks))
+    {
+      d->setLandmarks(d->toolUpdateLandmarks->landmarks);
+      d->UI.worldView->setLandmarks(*d->landmarks);
+    }
 
     d->UI.actionExportLandmarks->setEnabled(
       d->landmarks && d->landmarks->size());
     d->toolUpdateLandmarks = NULL;
-  }
-  if (d->toolUpdateTracks)
-  {
-    d->tracks = d->toolUpdateTracks;
-    d->updateCameraView();
 
-    foreach (auto const& track, d->tracks->tracks())
+    if (!camerasUpdated)
     {
-      d->UI.cameraView->addFeatureTrack(*track);
+      d->updateCameraView();
     }
-
-    d->UI.actionShowMatchMatrix->setEnabled(!d->tracks->tracks().empty());
+  }
+  if (d->toolUpdateTracks)
+  {
+    d->applyTracks(d->toolUpdateTracks);
     d->toolUpdateTracks = NULL;
   }
 
-  if (!d->cameras.isEmpty())
+  if (camerasUpdated && !d->cameras.isEmpty())
   {
     d->setActiveCamera(d->activeCameraIndex);
   }
@@ -1355,13 +1822,15 @@ void MainWindow::showMatchMatrix()
 
   if (d->tracks)
   {
-    // Get matrix
+    // Get matrix; only tracks that were replaced or changed size since the
+    // last call are processed
+    d->matchMatrix.update(*d->tracks);
     auto frames = std::vector<kwiver::vital::frame_id_t>();
-    auto const mm = kwiver::arrows::match_matrix(d->tracks, frames);
+    auto const mm = d->matchMatrix.matrix(frames);
 
     // Show window
     auto window = new MatchMatrixWindow();
-    window->setMatrix(mm);
+    window->setMatrix(mm, frames);
     window->show();
   }
 }
@@ -1382,6 +1851,27 @@ void MainWindow::setViewBackroundColor()
   }
 }
 
+//-----------------------------------------------------------------------------
+void MainWindow::setToolUpdateInterval()
+{
+  QTE_D();
+
+  auto ok = false;
+  auto const interval = QInputDialog::getInt(
+    this, "Progress Update Interval",
+    "Minimum time between updates of the views\n"
+    "while a computation is running (milliseconds):",
+    *d->toolUpdateInterval, 0, 60000, 50, &ok);
+  if (ok)
+  {
+    *d->toolUpdateInterval = interval;
+    foreach (auto const& tool, d->tools)
+    {
+      tool->setUpdateInterval(interval);
+    }
+  }
+}
+
 //-----------------------------------------------------------------------------
 void MainWindow::showAboutDialog()
 {
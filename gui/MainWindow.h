@@ -74,6 +74,7 @@ public slots:
   void setActiveCamera(int);
 
   void setViewBackroundColor();
+  void setToolUpdateInterval();
 
   void showMatchMatrix();
 
@@ -85,6 +86,15 @@ protected slots:
   void setSlideshowPlaying(bool);
   void nextSlide();
 
+  void showLoadedImage(QString const& path);
+  void showLoadedDepthMap(QString const& path);
+
+  void acceptProjectCameras();
+  void acceptProjectTracks();
+  void acceptProjectLandmarks();
+  void updateProjectProgress(QString const& status, int value, int maximum);
+  void finishProjectLoad();
+
   void executeTool(QObject*);
   void acceptToolFinalResults();
   void acceptToolResults(std::shared_ptr<ToolData> data);
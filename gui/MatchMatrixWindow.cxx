@@ -35,6 +35,8 @@
 
 #include "MatchMatrixAlgorithms.h"
 
+#include <maptk/match_matrix_io.h>
+
 #include <vital/util/enumerate_matrix.h>
 
 #include <qtGradient.h>
@@ -43,11 +45,19 @@
 #include <qtUiStateItem.h>
 
 #include <QtGui/QFileDialog>
+#include <QtGui/QGraphicsItem>
 #include <QtGui/QGraphicsSceneHoverEvent>
-#include <QtGui/QGraphicsPixmapItem>
 #include <QtGui/QImageWriter>
 #include <QtGui/QMessageBox>
+#include <QtGui/QPainter>
+#include <QtGui/QStyleOptionGraphicsItem>
+
+#include <QtCore/QCache>
+#include <QtCore/QRunnable>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
 
+#include <algorithm>
 #include <cmath>
 
 using std::floor;
@@ -98,6 +108,13 @@ enum ScaleAlgorithm
 
 //BEGIN miscellaneous helpers
 
+// Size of image tiles; must be a multiple of 4 so that tile scan lines are
+// contiguous
+int const tileSize = 256;
+
+// Maximum size of converted tile pixmaps kept for display, in KiB
+int const tileCacheSize = 128 * 1024;
+
 //-----------------------------------------------------------------------------
 template <typename T>
 T sparseMax(Eigen::SparseMatrix<T> const& m)
@@ -135,8 +152,181 @@ QString supportedImageFilter()
   return filters;
 }
 
+//-----------------------------------------------------------------------------
+uchar quantize(double value)
+{
+  return static_cast<uchar>(qBound(0, qRound(value * 255.0), 255));
+}
+
 //END miscellaneous helpers
 
+///////////////////////////////////////////////////////////////////////////////
+
+//BEGIN parallel helpers
+
+//-----------------------------------------------------------------------------
+template <typename Functor>
+class ParallelRangeTask : public QRunnable
+{
+public:
+  ParallelRangeTask(Functor const& func, int first, int last)
+    : func(func), first(first), last(last) {}
+
+  virtual void run() QTE_OVERRIDE
+  {
+    for (auto i = this->first; i < this->last; ++i)
+    {
+      this->func(i);
+    }
+  }
+
+protected:
+  Functor const& func;
+  int const first;
+  int const last;
+};
+
+//-----------------------------------------------------------------------------
+template <typename Functor>
+void parallelFor(int count, Functor const& func)
+{
+  if (count < 1)
+  {
+    return;
+  }
+
+  // Use several chunks per thread, as the work per index may vary greatly
+  auto const threads = qMax(1, QThread::idealThreadCount());
+  auto const chunks = qMin(count, 4 * threads);
+
+  QThreadPool pool;
+  pool.setMaxThreadCount(threads);
+  for (auto n = 0; n < chunks; ++n)
+  {
+    auto const first = static_cast<int>((qint64(count) * n) / chunks);
+    auto const last = static_cast<int>((qint64(count) * (n + 1)) / chunks);
+    pool.start(new ParallelRangeTask<Functor>(func, first, last));
+  }
+  pool.waitForDone();
+}
+
+//END parallel helpers
+
+///////////////////////////////////////////////////////////////////////////////
+
+//BEGIN image pyramid helpers
+
+//-----------------------------------------------------------------------------
+struct ImageLevel
+{
+  ImageLevel(QSize const& size = QSize());
+
+  QSize size;
+  int tilesX;
+  int tilesY;
+  QVector<QImage> tiles; // Null if the tile contains no values
+};
+
+//-----------------------------------------------------------------------------
+ImageLevel::ImageLevel(QSize const& size)
+  : size(size),
+    tilesX((size.width() + tileSize - 1) / tileSize),
+    tilesY((size.height() + tileSize - 1) / tileSize),
+    tiles(tilesX * tilesY)
+{
+}
+
+//-----------------------------------------------------------------------------
+QImage createTile()
+{
+  auto tile = QImage(tileSize, tileSize, QImage::Format_Indexed8);
+  tile.fill(0);
+  Q_ASSERT(tile.bytesPerLine() == tileSize);
+  return tile;
+}
+
+//-----------------------------------------------------------------------------
+void poolTile(uchar* out, uchar const* const in[4])
+{
+  auto const half = tileSize / 2;
+
+  // Each input tile covers one quadrant of the output tile; take the maximum
+  // of each 2x2 block, so that isolated values remain visible
+  for (int q = 0; q < 4; ++q)
+  {
+    if (!in[q])
+    {
+      continue;
+    }
+
+    auto const ox = (q & 1) * half;
+    auto const oy = (q >> 1) * half;
+    for (int y = 0; y < half; ++y)
+    {
+      auto const r0 = in[q] + (2 * y * tileSize);
+      auto const r1 = r0 + tileSize;
+      auto const o = out + ((oy + y) * tileSize) + ox;
+      for (int x = 0; x < half; ++x)
+      {
+        auto const a = qMax(r0[2 * x], r0[2 * x + 1]);
+        auto const b = qMax(r1[2 * x], r1[2 * x + 1]);
+        o[x] = qMax(a, b);
+      }
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+ImageLevel poolLevel(ImageLevel const& source)
+{
+  struct PoolJob
+  {
+    uchar* out;
+    uchar const* in[4];
+  };
+
+  auto const size = QSize((source.size.width() + 1) / 2,
+                          (source.size.height() + 1) / 2);
+  auto result = ImageLevel(size);
+  auto jobs = QVector<PoolJob>();
+
+  // Allocate output tiles covering at least one non-empty input tile
+  for (int ty = 0; ty < result.tilesY; ++ty)
+  {
+    for (int tx = 0; tx < result.tilesX; ++tx)
+    {
+      auto job = PoolJob();
+      auto empty = true;
+
+      for (int q = 0; q < 4; ++q)
+      {
+        auto const sx = (2 * tx) + (q & 1);
+        auto const sy = (2 * ty) + (q >> 1);
+        job.in[q] =
+          (sx < source.tilesX && sy < source.tilesY
+           ? source.tiles[sy * source.tilesX + sx].constBits() : 0);
+        empty = empty && !job.in[q];
+      }
+
+      if (!empty)
+      {
+        auto& tile = result.tiles[ty * result.tilesX + tx];
+        tile = createTile();
+        job.out = tile.bits();
+        jobs.append(job);
+      }
+    }
+  }
+
+  parallelFor(jobs.count(), [&jobs](int n){
+    poolTile(jobs.at(n).out, jobs.at(n).in);
+  });
+
+  return result;
+}
+
+//END image pyramid helpers
+
 } // namespace <anonymous>
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -150,29 +340,35 @@ public:
   void persist(QString const& key, QComboBox* widget);
   void persist(QString const& key, qtDoubleSlider* widget);
 
-  void buildHorizontalImage(
-    qtGradient const& gradient,
-    AbstractValueAlgorithm const& valueAlgorithm,
-    AbstractScaleAlgorithm const& scaleAlgorithm);
-  void buildVerticalImage(
-    qtGradient const& gradient,
-    AbstractValueAlgorithm const& valueAlgorithm,
-    AbstractScaleAlgorithm const& scaleAlgorithm);
-  void buildDiagonalImage(
-    qtGradient const& gradient,
+  void buildImage(
+    int layout,
     AbstractValueAlgorithm const& valueAlgorithm,
     AbstractScaleAlgorithm const& scaleAlgorithm);
+  void updateImageLayout(int layout);
+
+  QPoint mapToImage(int layout, int row, int col) const;
+  QPixmap tilePixmap(int level, int index);
+  QImage fullImage() const;
 
   Ui::MatchMatrixWindow UI;
   Am::MatchMatrixWindow AM;
   qtUiState uiState;
 
   Eigen::SparseMatrix<uint> matrix;
+  std::vector<kwiver::vital::frame_id_t> frames;
   uint maxValue;
 
-  QImage image;
+  kwiver::vital::frame_id_t frame(int index) const;
+
+  QSize imageSize;
   int offset;
 
+  // Image pyramid; level 0 is the full resolution image, and each following
+  // level is max-pooled from the previous one, down to a single tile
+  QList<ImageLevel> levels;
+  QVector<QRgb> colors;
+  QCache<quint64, QPixmap> tileCache;
+
   QGraphicsScene scene;
 };
 
@@ -197,80 +393,169 @@ void MatchMatrixWindowPrivate::persist(
 }
 
 //-----------------------------------------------------------------------------
-void MatchMatrixWindowPrivate::buildHorizontalImage(
-  qtGradient const& gradient,
-  AbstractValueAlgorithm const& valueAlgorithm,
-  AbstractScaleAlgorithm const& scaleAlgorithm)
+kwiver::vital::frame_id_t MatchMatrixWindowPrivate::frame(int index) const
 {
-  auto const k = this->matrix.rows();
-  auto minY = k;
-  auto maxY = k;
+  auto const i = static_cast<size_t>(index);
+  return (i < this->frames.size() ? this->frames[i] : index);
+}
 
-  auto image = QImage(k, k * 2, QImage::Format_RGB32);
-  image.fill(gradient.at(0.0));
+//-----------------------------------------------------------------------------
+void MatchMatrixWindowPrivate::updateImageLayout(int layout)
+{
+  auto const k = static_cast<int>(this->matrix.rows());
 
-  foreach (auto it, kwiver::vital::enumerate(this->matrix))
+  if (layout == Diagonal)
   {
-    auto const y = it.col() + k - 1 - it.row();
-    minY = qMin(minY, y);
-    maxY = qMax(maxY, y);
+    this->imageSize = QSize(k, k);
+    this->offset = 0;
+    return;
+  }
 
-    auto const a = scaleAlgorithm(valueAlgorithm(this->matrix, it));
-    auto const c = gradient.at(a);
-    image.setPixel(it.row(), y, c.rgba());
+  // Find the extent of the off-diagonal band that contains values
+  auto minD = k;
+  auto maxD = k;
+
+  foreach (auto it, kwiver::vital::enumerate(this->matrix))
+  {
+    auto const i = static_cast<int>(it.row());
+    auto const j = static_cast<int>(it.col());
+    auto const d = (layout == Horizontal ? j - i : i - j) + k - 1;
+    minD = qMin(minD, d);
+    maxD = qMax(maxD, d);
   }
 
-  this->image = image.copy(0, minY, k, maxY - minY + 1);
-  this->offset = minY;
+  auto const n = maxD - minD + 1;
+  this->imageSize = (layout == Horizontal ? QSize(k, n) : QSize(n, k));
+  this->offset = minD;
+}
+
+//-----------------------------------------------------------------------------
+QPoint MatchMatrixWindowPrivate::mapToImage(
+  int layout, int row, int col) const
+{
+  auto const k = static_cast<int>(this->matrix.rows());
+
+  switch (layout)
+  {
+    case Horizontal:
+      return QPoint(row, col + k - 1 - row - this->offset);
+    case Vertical:
+      return QPoint(row + k - 1 - col - this->offset, col);
+    default: // Diagonal
+      return QPoint(row, col);
+  }
 }
 
 //-----------------------------------------------------------------------------
-void MatchMatrixWindowPrivate::buildVerticalImage(
-  qtGradient const& gradient,
+void MatchMatrixWindowPrivate::buildImage(
+  int layout,
   AbstractValueAlgorithm const& valueAlgorithm,
   AbstractScaleAlgorithm const& scaleAlgorithm)
 {
-  auto const k = this->matrix.rows();
-  auto minX = k;
-  auto maxX = k;
+  this->levels.clear();
+  this->tileCache.clear();
 
-  auto image = QImage(k * 2, k, QImage::Format_RGB32);
-  image.fill(gradient.at(0.0));
+  this->updateImageLayout(layout);
 
+  // Allocate the full resolution tiles that contain at least one value; the
+  // (mostly empty) full image is never allocated as a whole
+  auto level = ImageLevel(this->imageSize);
   foreach (auto it, kwiver::vital::enumerate(this->matrix))
   {
-    auto const x = it.row() + k - 1 - it.col();
-    minX = qMin(minX, x);
-    maxX = qMax(maxX, x);
+    auto const p = this->mapToImage(layout, it.row(), it.col());
+    auto& tile =
+      level.tiles[(p.y() / tileSize) * level.tilesX + (p.x() / tileSize)];
+    if (tile.isNull())
+    {
+      tile = createTile();
+    }
+  }
 
-    auto const a = scaleAlgorithm(valueAlgorithm(this->matrix, it));
-    auto const c = gradient.at(a);
-    image.setPixel(x, it.col(), c.rgba());
+  auto tileBits = QVector<uchar*>(level.tiles.count());
+  for (int n = 0; n < level.tiles.count(); ++n)
+  {
+    tileBits[n] = (level.tiles[n].isNull() ? 0 : level.tiles[n].bits());
   }
 
-  this->image = image.copy(minX, 0, maxX - minX + 1, k);
-  this->offset = minX;
+  // Compute values in parallel by matrix column; each matrix element maps to
+  // a distinct pixel, so no synchronization is needed
+  typedef AbstractValueAlgorithm::MatrixIterator MatrixIterator;
+  auto const& matrix = this->matrix;
+  auto const& bits = tileBits;
+  auto const tilesX = level.tilesX;
+  parallelFor(matrix.outerSize(), [&](int outer){
+    for (MatrixIterator it(matrix, outer); it; ++it)
+    {
+      auto const p = this->mapToImage(layout, it.row(), it.col());
+      auto const a = scaleAlgorithm(valueAlgorithm(matrix, it));
+      auto const t = (p.y() / tileSize) * tilesX + (p.x() / tileSize);
+      auto const i = (p.y() % tileSize) * tileSize + (p.x() % tileSize);
+      bits.at(t)[i] = quantize(a);
+    }
+  });
+
+  // Build reduced resolution levels
+  this->levels.append(level);
+  while (this->levels.last().tiles.count() > 1)
+  {
+    this->levels.append(poolLevel(this->levels.last()));
+  }
 }
 
 //-----------------------------------------------------------------------------
-void MatchMatrixWindowPrivate::buildDiagonalImage(
-  qtGradient const& gradient,
-  AbstractValueAlgorithm const& valueAlgorithm,
-  AbstractScaleAlgorithm const& scaleAlgorithm)
+QPixmap MatchMatrixWindowPrivate::tilePixmap(int level, int index)
 {
-  auto const k = this->matrix.rows();
-  auto image = QImage(k, k, QImage::Format_RGB32);
-  image.fill(gradient.at(0.0));
+  auto const key = (quint64(level) << 32) | quint64(index);
+  if (auto const cached = this->tileCache.object(key))
+  {
+    return *cached;
+  }
 
-  foreach (auto it, kwiver::vital::enumerate(this->matrix))
+  auto image = this->levels.at(level).tiles.at(index);
+  image.setColorTable(this->colors);
+
+  auto const pixmap = QPixmap::fromImage(image);
+  this->tileCache.insert(key, new QPixmap(pixmap),
+                         (tileSize * tileSize * 4) / 1024);
+  return pixmap;
+}
+
+//-----------------------------------------------------------------------------
+QImage MatchMatrixWindowPrivate::fullImage() const
+{
+  auto image = QImage(this->imageSize, QImage::Format_Indexed8);
+  if (image.isNull() || this->levels.isEmpty())
   {
-    auto const a = scaleAlgorithm(valueAlgorithm(this->matrix, it));
-    auto const c = gradient.at(a);
-    image.setPixel(it.row(), it.col(), c.rgba());
+    return image;
   }
 
-  this->image = image;
-  this->offset = 0;
+  image.setColorTable(this->colors);
+  image.fill(0);
+
+  auto const& level = this->levels.first();
+  for (int ty = 0; ty < level.tilesY; ++ty)
+  {
+    for (int tx = 0; tx < level.tilesX; ++tx)
+    {
+      auto const& tile = level.tiles[ty * level.tilesX + tx];
+      if (tile.isNull())
+      {
+        continue;
+      }
+
+      auto const x = tx * tileSize;
+      auto const y = ty * tileSize;
+      auto const w = qMin(tileSize, image.width() - x);
+      auto const h = qMin(tileSize, image.height() - y);
+      for (int row = 0; row < h; ++row)
+      {
+        auto const in = tile.constScanLine(row);
+        std::copy(in, in + w, image.scanLine(y + row) + x);
+      }
+    }
+  }
+
+  return image;
 }
 
 //END MatchMatrixWindowPrivate
@@ -280,10 +565,15 @@ void MatchMatrixWindowPrivate::buildDiagonalImage(
 //BEGIN MatchMatrixImageItem
 
 //-----------------------------------------------------------------------------
-class MatchMatrixImageItem : public QGraphicsPixmapItem
+class MatchMatrixImageItem : public QGraphicsItem
 {
 public:
-  MatchMatrixImageItem(QImage const& image, MatchMatrixWindowPrivate* q);
+  MatchMatrixImageItem(QSize const& size, MatchMatrixWindowPrivate* q);
+
+  virtual QRectF boundingRect() const QTE_OVERRIDE;
+  virtual void paint(QPainter* painter,
+                     QStyleOptionGraphicsItem const* option,
+                     QWidget* widget) QTE_OVERRIDE;
 
 protected:
   virtual void hoverEnterEvent(QGraphicsSceneHoverEvent* event) QTE_OVERRIDE;
@@ -292,16 +582,79 @@ protected:
 
   void updateStatusText(QPointF const& pos);
 
+  QRectF const bounds;
+
   QTE_DECLARE_PUBLIC_PTR(MatchMatrixWindowPrivate);
   QTE_DECLARE_PUBLIC(MatchMatrixWindowPrivate);
 };
 
 //-----------------------------------------------------------------------------
 MatchMatrixImageItem::MatchMatrixImageItem(
-  QImage const& image, MatchMatrixWindowPrivate* q)
-  : QGraphicsPixmapItem(QPixmap::fromImage(image)), q_ptr(q)
+  QSize const& size, MatchMatrixWindowPrivate* q)
+  : bounds(QPointF(0.0, 0.0), size), q_ptr(q)
 {
   this->setAcceptHoverEvents(true);
+  this->setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+}
+
+//-----------------------------------------------------------------------------
+QRectF MatchMatrixImageItem::boundingRect() const
+{
+  return this->bounds;
+}
+
+//-----------------------------------------------------------------------------
+void MatchMatrixImageItem::paint(
+  QPainter* painter, QStyleOptionGraphicsItem const* option,
+  QWidget* /*widget*/)
+{
+  QTE_Q();
+
+  auto const exposed = option->exposedRect & this->bounds;
+  if (exposed.isEmpty() || q->levels.isEmpty())
+  {
+    return;
+  }
+
+  painter->save();
+  painter->setClipRect(this->bounds, Qt::IntersectClip);
+  painter->fillRect(exposed, QColor(q->colors.first()));
+
+  // Select the coarsest level that still has at least one pixel per screen
+  // pixel
+  auto const lod =
+    option->levelOfDetailFromTransform(painter->worldTransform());
+  auto level = 0;
+  while (level + 1 < q->levels.count() && lod * (2 << level) <= 1.0)
+  {
+    ++level;
+  }
+
+  // Draw non-empty tiles that intersect the exposed area
+  auto const& data = q->levels.at(level);
+  auto const extent = static_cast<qreal>(tileSize << level);
+  auto const x0 = qMax(0, static_cast<int>(floor(exposed.left() / extent)));
+  auto const y0 = qMax(0, static_cast<int>(floor(exposed.top() / extent)));
+  auto const x1 = qMin(data.tilesX - 1,
+                       static_cast<int>(floor(exposed.right() / extent)));
+  auto const y1 = qMin(data.tilesY - 1,
+                       static_cast<int>(floor(exposed.bottom() / extent)));
+
+  auto const source = QRectF(0.0, 0.0, tileSize, tileSize);
+  for (int ty = y0; ty <= y1; ++ty)
+  {
+    for (int tx = x0; tx <= x1; ++tx)
+    {
+      auto const index = ty * data.tilesX + tx;
+      if (!data.tiles.at(index).isNull())
+      {
+        auto const target = QRectF(tx * extent, ty * extent, extent, extent);
+        painter->drawPixmap(target, q->tilePixmap(level, index), source);
+      }
+    }
+  }
+
+  painter->restore();
 }
 
 //-----------------------------------------------------------------------------
@@ -366,7 +719,8 @@ void MatchMatrixImageItem::updateStatusText(const QPointF& pos)
     static auto const format =
       QString("Frame %1 has %2 feature point(s)");
 
-    q->UI.statusBar->showMessage(format.arg(x).arg(q->matrix.coeff(x, y)));
+    q->UI.statusBar->showMessage(
+      format.arg(q->frame(x)).arg(q->matrix.coeff(x, y)));
   }
   else
   {
@@ -377,7 +731,8 @@ void MatchMatrixImageItem::updateStatusText(const QPointF& pos)
     auto const cy = q->matrix.coeff(y, y);
     auto const cxy = q->matrix.coeff(x, y);
 
-    q->UI.statusBar->showMessage(format.arg(x).arg(y).arg(cx).arg(cy).arg(cxy));
+    q->UI.statusBar->showMessage(
+      format.arg(q->frame(x)).arg(q->frame(y)).arg(cx).arg(cy).arg(cxy));
   }
 }
 
@@ -404,6 +759,8 @@ MatchMatrixWindow::MatchMatrixWindow(QWidget* parent, Qt::WindowFlags flags)
 
   d->UI.view->setScene(&d->scene);
 
+  d->tileCache.setMaxCost(tileCacheSize);
+
   d->UI.color->setCurrentIndex(GradientSelector::Viridis);
 
   // Set up UI persistence and restore previous state
@@ -425,6 +782,7 @@ MatchMatrixWindow::MatchMatrixWindow(QWidget* parent, Qt::WindowFlags flags)
   this->updateImageTransform();
 
   // Set up signals/slots
+  connect(d->UI.actionOpenMatrix, SIGNAL(triggered()), this, SLOT(openMatrix()));
   connect(d->UI.actionSaveImage, SIGNAL(triggered()), this, SLOT(saveImage()));
 
   connect(d->UI.layout, SIGNAL(currentIndexChanged(QString)),
@@ -436,7 +794,7 @@ MatchMatrixWindow::MatchMatrixWindow(QWidget* parent, Qt::WindowFlags flags)
   connect(d->UI.scale, SIGNAL(currentIndexChanged(QString)),
           this, SLOT(updateImage()));
   connect(d->UI.color, SIGNAL(currentIndexChanged(QString)),
-          this, SLOT(updateImage()));
+          this, SLOT(updateImageColors()));
   connect(d->UI.exponent, SIGNAL(valueChanged(double)),
           this, SLOT(updateImage()));
   connect(d->UI.range, SIGNAL(valueChanged(double)),
@@ -457,15 +815,63 @@ MatchMatrixWindow::~MatchMatrixWindow()
 
 //-----------------------------------------------------------------------------
 void MatchMatrixWindow::setMatrix(Eigen::SparseMatrix<uint> const& matrix)
+{
+  this->setMatrix(matrix, std::vector<kwiver::vital::frame_id_t>());
+}
+
+//-----------------------------------------------------------------------------
+void MatchMatrixWindow::setMatrix(
+  Eigen::SparseMatrix<uint> const& matrix,
+  std::vector<kwiver::vital::frame_id_t> const& frames)
 {
   QTE_D();
 
   d->matrix = matrix;
+  d->frames = frames;
   d->maxValue = sparseMax(matrix);
 
   this->updateImage();
 }
 
+//-----------------------------------------------------------------------------
+void MatchMatrixWindow::openMatrix()
+{
+  auto const path = QFileDialog::getOpenFileName(
+    this, "Open Match Matrix", QString(),
+    "Match matrix files (*.csr *.mtx *.txt);;"
+    "Binary CSR match matrix (*.csr);;"
+    "Matrix Market file (*.mtx);;"
+    "Match matrix triplets (*.txt);;"
+    "All Files (*)");
+
+  if (!path.isEmpty())
+  {
+    this->openMatrix(path);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void MatchMatrixWindow::openMatrix(QString const& path)
+{
+  auto matrix = Eigen::SparseMatrix<uint>();
+  auto frames = std::vector<kwiver::vital::frame_id_t>();
+
+  try
+  {
+    kwiver::maptk::read_match_matrix_file(
+      qPrintable(path), matrix, frames);
+  }
+  catch (std::exception const& e)
+  {
+    static auto const msgFormat =
+      QString("Failed to read match matrix from \"%1\":\n%2");
+    QMessageBox::critical(this, "Error", msgFormat.arg(path, e.what()));
+    return;
+  }
+
+  this->setMatrix(matrix, frames);
+}
+
 //-----------------------------------------------------------------------------
 void MatchMatrixWindow::saveImage()
 {
@@ -488,7 +894,8 @@ void MatchMatrixWindow::saveImage(QString const& path)
   QTE_D();
 
   auto const flip = (d->UI.orientation->currentIndex() == Graph);
-  auto const& image = (flip ? d->image.mirrored() : d->image);
+  auto const fullImage = d->fullImage();
+  auto const& image = (flip ? fullImage.mirrored() : fullImage);
 
   if (!image.save(path))
   {
@@ -547,7 +954,6 @@ void MatchMatrixWindow::updateImage()
   // Set up visualization
   QScopedPointer<AbstractValueAlgorithm> valueAlgorithm;
   QScopedPointer<AbstractScaleAlgorithm> scaleAlgorithm;
-  auto const& gradient = d->UI.color->currentGradient();
 
   switch (d->UI.values->currentIndex())
   {
@@ -591,21 +997,29 @@ void MatchMatrixWindow::updateImage()
   }
 
   // Build image
-  switch (d->UI.layout->currentIndex())
+  d->scene.clear();
+  d->buildImage(d->UI.layout->currentIndex(),
+                *valueAlgorithm, *scaleAlgorithm);
+  this->updateImageColors();
+
+  d->scene.addItem(new MatchMatrixImageItem(d->imageSize, d));
+}
+
+//-----------------------------------------------------------------------------
+void MatchMatrixWindow::updateImageColors()
+{
+  QTE_D();
+
+  // Image values are quantized, so only the color table needs to be updated
+  auto const& gradient = d->UI.color->currentGradient();
+  d->colors.resize(256);
+  for (int i = 0; i < 256; ++i)
   {
-    case Horizontal:
-      d->buildHorizontalImage(gradient, *valueAlgorithm, *scaleAlgorithm);
-      break;
-    case Vertical:
-      d->buildVerticalImage(gradient, *valueAlgorithm, *scaleAlgorithm);
-      break;
-    default: // Diagonal
-      d->buildDiagonalImage(gradient, *valueAlgorithm, *scaleAlgorithm);
-      break;
+    d->colors[i] = gradient.at(i / 255.0).rgb();
   }
 
-  d->scene.clear();
-  d->scene.addItem(new MatchMatrixImageItem(d->image, d));
+  d->tileCache.clear();
+  d->scene.update();
 }
 
 //-----------------------------------------------------------------------------
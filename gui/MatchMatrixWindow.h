@@ -35,8 +35,12 @@
 
 #include <QMainWindow>
 
+#include <vital/vital_types.h>
+
 #include <Eigen/SparseCore>
 
+#include <vector>
+
 class MatchMatrixWindowPrivate;
 
 class MatchMatrixWindow : public QMainWindow
@@ -49,6 +53,11 @@ public:
 
 public slots:
   void setMatrix(Eigen::SparseMatrix<uint> const&);
+  void setMatrix(Eigen::SparseMatrix<uint> const&,
+                 std::vector<kwiver::vital::frame_id_t> const& frames);
+
+  void openMatrix();
+  void openMatrix(QString const& path);
 
   void saveImage();
   void saveImage(QString const& path);
@@ -56,6 +65,7 @@ public slots:
 protected slots:
   void updateControls();
   void updateImage();
+  void updateImageColors();
   void updateImageTransform();
 
 private:
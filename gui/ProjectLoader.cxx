@@ -0,0 +1,402 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name Kitware, Inc. nor the names of any contributors may be
+ *    used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "ProjectLoader.h"
+
+#include "Project.h"
+
+#include <vital/io/camera_io.h>
+#include <vital/io/landmark_map_io.h>
+#include <vital/io/track_set_io.h>
+
+#include <qtStlUtil.h>
+
+#include <QtCore/QAtomicInt>
+#include <QtCore/QDebug>
+#include <QtCore/QMutex>
+#include <QtCore/QRunnable>
+#include <QtCore/QThread>
+#include <QtCore/QThreadPool>
+#include <QtCore/QWaitCondition>
+
+#include <functional>
+
+namespace // anonymous
+{
+
+// Interval at which progress is reported, in milliseconds
+auto const progressInterval = 100;
+
+//-----------------------------------------------------------------------------
+kwiver::vital::path_t kvPath(QString const& s)
+{
+  return stdString(s);
+}
+
+//-----------------------------------------------------------------------------
+class FunctionTask : public QRunnable
+{
+public:
+  FunctionTask(std::function<void()> const& func) : func(func) {}
+
+  virtual void run() QTE_OVERRIDE { this->func(); }
+
+protected:
+  std::function<void()> const func;
+};
+
+} // namespace <anonymous>
+
+//-----------------------------------------------------------------------------
+class ProjectLoaderPrivate : public QThread
+{
+public:
+  ProjectLoaderPrivate(ProjectLoader* q)
+    : generation(0), loadPending(false), loading(false),
+      stopRequested(false), q_ptr(q) {}
+
+  virtual void run() QTE_OVERRIDE;
+
+  void load(Project const& project, unsigned generation);
+  kwiver::vital::camera_map_sptr readCameras(
+    Project const& project, unsigned generation);
+
+  bool isCurrent(unsigned generation) const;
+
+  template <typename T>
+  bool store(unsigned generation, T& member, T const& value);
+
+  void reset();
+
+  mutable QMutex mutex;
+  QWaitCondition wakeCondition;
+
+  Project project;
+
+  kwiver::vital::camera_map_sptr cameras;
+  kwiver::vital::track_set_sptr tracks;
+  kwiver::vital::landmark_map_sptr landmarks;
+
+  unsigned generation; // Incremented when a load is started or abandoned
+  bool loadPending;
+  bool loading;
+  bool stopRequested;
+
+protected:
+  QTE_DECLARE_PUBLIC_PTR(ProjectLoader)
+  QTE_DECLARE_PUBLIC(ProjectLoader)
+};
+
+QTE_IMPLEMENT_D_FUNC(ProjectLoader)
+
+//-----------------------------------------------------------------------------
+void ProjectLoaderPrivate::run()
+{
+  QTE_Q();
+
+  QMutexLocker locker(&this->mutex);
+  forever
+  {
+    while (!this->stopRequested && !this->loadPending)
+    {
+      this->wakeCondition.wait(&this->mutex);
+    }
+    if (this->stopRequested)
+    {
+      return;
+    }
+    this->loadPending = false;
+
+    // Load the project without holding the lock
+    auto const currentProject = this->project;
+    auto const currentGeneration = this->generation;
+
+    locker.unlock();
+    this->load(currentProject, currentGeneration);
+    locker.relock();
+
+    if (this->generation == currentGeneration)
+    {
+      this->loading = false;
+
+      locker.unlock();
+      emit q->finished();
+      locker.relock();
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+void ProjectLoaderPrivate::load(Project const& project, unsigned generation)
+{
+  QTE_Q();
+
+  // Read cameras first, so that the UI can show them as soon as possible
+  auto const& cameras = this->readCameras(project, generation);
+  if (!this->store(generation, this->cameras, cameras))
+  {
+    return;
+  }
+  emit q->camerasLoaded();
+
+  // Read landmarks in the background while tracks are read on this thread;
+  // track files are typically much larger, and landmarks are useful on
+  // their own
+  emit q->progressChanged("Loading tracks and landmarks...", 0, 0);
+
+  QThreadPool pool;
+  if (!project.landmarks.isEmpty())
+  {
+    auto const& path = project.landmarks;
+    pool.start(new FunctionTask([this, q, path, generation]{
+      auto landmarks = kwiver::vital::landmark_map_sptr{};
+      try
+      {
+        landmarks = kwiver::vital::read_ply_file(kvPath(path));
+      }
+      catch (...)
+      {
+        qWarning() << "failed to read landmarks from" << path;
+      }
+
+      if (this->store(generation, this->landmarks, landmarks))
+      {
+        emit q->landmarksLoaded();
+      }
+    }));
+  }
+
+  if (!project.tracks.isEmpty())
+  {
+    auto tracks = kwiver::vital::track_set_sptr{};
+    try
+    {
+      tracks = kwiver::vital::read_track_file(kvPath(project.tracks));
+    }
+    catch (...)
+    {
+      qWarning() << "failed to read tracks from" << project.tracks;
+    }
+
+    if (this->store(generation, this->tracks, tracks))
+    {
+      emit q->tracksLoaded();
+    }
+  }
+
+  pool.waitForDone();
+}
+
+//-----------------------------------------------------------------------------
+kwiver::vital::camera_map_sptr ProjectLoaderPrivate::readCameras(
+  Project const& project, unsigned generation)
+{
+  QTE_Q();
+
+  auto map = kwiver::vital::camera_map::map_camera_t{};
+  if (project.cameraPath.isEmpty())
+  {
+    return std::make_shared<kwiver::vital::simple_camera_map>(map);
+  }
+
+  // Read cameras in parallel; each camera is read into its own slot, so no
+  // synchronization is needed other than to count completed reads
+  auto const count = project.images.count();
+  auto cameras = std::vector<kwiver::vital::camera_sptr>(count);
+  auto const cameraDir = kwiver::vital::path_t(kvPath(project.cameraPath));
+
+  QAtomicInt completed(0);
+  auto const readCamera = [&](int i){
+    auto const& ip = project.images[i];
+    try
+    {
+      cameras[i] = kwiver::vital::read_krtd_file(kvPath(ip), cameraDir);
+    }
+    catch (...)
+    {
+      qWarning() << "failed to read camera for" << ip
+                 << "from" << project.cameraPath;
+    }
+    completed.ref();
+  };
+
+  QThreadPool pool;
+  auto const chunks = qMin(count, 4 * qMax(1, QThread::idealThreadCount()));
+  for (int n = 0; n < chunks; ++n)
+  {
+    auto const first = static_cast<int>((qint64(count) * n) / chunks);
+    auto const last = static_cast<int>((qint64(count) * (n + 1)) / chunks);
+    pool.start(new FunctionTask([&, first, last]{
+      for (auto i = first; i < last && this->isCurrent(generation); ++i)
+      {
+        readCamera(i);
+      }
+    }));
+  }
+
+  while (!pool.waitForDone(progressInterval))
+  {
+    emit q->progressChanged("Loading cameras...", completed, count);
+  }
+
+  if (!this->isCurrent(generation))
+  {
+    return kwiver::vital::camera_map_sptr{};
+  }
+
+  for (int i = 0; i < count; ++i)
+  {
+    if (cameras[i])
+    {
+      map.insert(std::make_pair(static_cast<kwiver::vital::frame_id_t>(i),
+                                cameras[i]));
+    }
+  }
+
+  return std::make_shared<kwiver::vital::simple_camera_map>(map);
+}
+
+//-----------------------------------------------------------------------------
+bool ProjectLoaderPrivate::isCurrent(unsigned generation) const
+{
+  QMutexLocker locker(&this->mutex);
+  return (generation == this->generation && !this->stopRequested);
+}
+
+//-----------------------------------------------------------------------------
+template <typename T>
+bool ProjectLoaderPrivate::store(
+  unsigned generation, T& member, T const& value)
+{
+  QMutexLocker locker(&this->mutex);
+  if (generation != this->generation)
+  {
+    return false;
+  }
+
+  member = value;
+  return true;
+}
+
+//-----------------------------------------------------------------------------
+void ProjectLoaderPrivate::reset()
+{
+  ++this->generation;
+  this->cameras.reset();
+  this->tracks.reset();
+  this->landmarks.reset();
+}
+
+//-----------------------------------------------------------------------------
+ProjectLoader::ProjectLoader(QObject* parent)
+  : QObject(parent), d_ptr(new ProjectLoaderPrivate(this))
+{
+  QTE_D();
+  d->start();
+}
+
+//-----------------------------------------------------------------------------
+ProjectLoader::~ProjectLoader()
+{
+  QTE_D();
+
+  d->mutex.lock();
+  d->reset();
+  d->stopRequested = true;
+  d->wakeCondition.wakeAll();
+  d->mutex.unlock();
+
+  d->wait();
+}
+
+//-----------------------------------------------------------------------------
+void ProjectLoader::load(Project const& project)
+{
+  QTE_D();
+  QMutexLocker locker(&d->mutex);
+
+  d->reset();
+  d->project = project;
+  d->loadPending = true;
+  d->loading = true;
+  d->wakeCondition.wakeAll();
+}
+
+//-----------------------------------------------------------------------------
+void ProjectLoader::cancel()
+{
+  QTE_D();
+  QMutexLocker locker(&d->mutex);
+
+  d->reset();
+  d->loadPending = false;
+  d->loading = false;
+}
+
+//-----------------------------------------------------------------------------
+bool ProjectLoader::isLoading() const
+{
+  QTE_D();
+  QMutexLocker locker(&d->mutex);
+  return d->loading;
+}
+
+//-----------------------------------------------------------------------------
+kwiver::vital::camera_map_sptr ProjectLoader::takeCameras()
+{
+  QTE_D();
+  QMutexLocker locker(&d->mutex);
+
+  auto result = d->cameras;
+  d->cameras.reset();
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+kwiver::vital::track_set_sptr ProjectLoader::takeTracks()
+{
+  QTE_D();
+  QMutexLocker locker(&d->mutex);
+
+  auto result = d->tracks;
+  d->tracks.reset();
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+kwiver::vital::landmark_map_sptr ProjectLoader::takeLandmarks()
+{
+  QTE_D();
+  QMutexLocker locker(&d->mutex);
+
+  auto result = d->landmarks;
+  d->landmarks.reset();
+  return result;
+}
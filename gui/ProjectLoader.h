@@ -0,0 +1,122 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither the name Kitware, Inc. nor the names of any contributors may be
+ *    used to endorse or promote products derived from this software without
+ *    specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef MAPTK_PROJECTLOADER_H_
+#define MAPTK_PROJECTLOADER_H_
+
+#include <qtGlobal.h>
+
+#include <QtCore/QObject>
+
+#include <vital/types/camera_map.h>
+#include <vital/types/landmark_map.h>
+#include <vital/types/track_set.h>
+
+struct Project;
+
+class ProjectLoaderPrivate;
+
+/// Loader for the data of a project, which runs in the background
+///
+/// Loading proceeds in stages. Cameras are read first, in parallel, so that
+/// the UI can become interactive as soon as the camera poses are available.
+/// Landmarks and tracks are then read concurrently. As each stage completes,
+/// the corresponding signal is emitted, and the loaded data may be taken from
+/// the loader. Starting a new load abandons any load in progress; data from an
+/// abandoned load is never made available.
+class ProjectLoader : public QObject
+{
+  Q_OBJECT
+
+public:
+  explicit ProjectLoader(QObject* parent = 0);
+  virtual ~ProjectLoader();
+
+  /// Start loading the cameras, tracks and landmarks of a project.
+  ///
+  /// Images and depth maps are not loaded, as they are only needed when the
+  /// corresponding frame is shown. Cameras are keyed by the index of their
+  /// image in the project; if the project has no camera path, an empty camera
+  /// map is produced.
+  void load(Project const& project);
+
+  /// Abandon the load in progress, if any.
+  void cancel();
+
+  /// Test if a load is in progress.
+  bool isLoading() const;
+
+  /// Take the loaded cameras.
+  ///
+  /// This returns null if the cameras have not been loaded yet, or have
+  /// already been taken.
+  kwiver::vital::camera_map_sptr takeCameras();
+
+  /// Take the loaded tracks.
+  ///
+  /// This returns null if the tracks have not been loaded yet, have already
+  /// been taken, or could not be read.
+  kwiver::vital::track_set_sptr takeTracks();
+
+  /// Take the loaded landmarks.
+  ///
+  /// This returns null if the landmarks have not been loaded yet, have
+  /// already been taken, or could not be read.
+  kwiver::vital::landmark_map_sptr takeLandmarks();
+
+signals:
+  /// Emitted when the cameras have been loaded.
+  void camerasLoaded();
+
+  /// Emitted when the tracks have been loaded (or failed to load).
+  void tracksLoaded();
+
+  /// Emitted when the landmarks have been loaded (or failed to load).
+  void landmarksLoaded();
+
+  /// Emitted periodically to report the progress of the current stage.
+  ///
+  /// If \p maximum is zero, the progress of the stage is unknown.
+  void progressChanged(QString const& status, int value, int maximum);
+
+  /// Emitted when all stages of a load have completed.
+  ///
+  /// This may be received after a new load has been started, in which case
+  /// isLoading() will return \c true.
+  void finished();
+
+private:
+  QTE_DECLARE_PRIVATE_RPTR(ProjectLoader)
+  QTE_DECLARE_PRIVATE(ProjectLoader)
+
+  QTE_DISABLE_COPY(ProjectLoader)
+};
+
+#endif
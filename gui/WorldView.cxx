@@ -38,6 +38,7 @@
 #include "DepthMapOptions.h"
 #include "FieldInformation.h"
 #include "ImageOptions.h"
+#include "ImagePyramid.h"
 #include "PointOptions.h"
 #include "vtkMaptkImageUnprojectDepth.h"
 #include "vtkMaptkCamera.h"
@@ -53,7 +54,9 @@
 #include <vtkDoubleArray.h>
 #include <vtkGeometryFilter.h>
 #include <vtkImageActor.h>
+#include <vtkIdTypeArray.h>
 #include <vtkImageData.h>
+#include <vtkLODActor.h>
 #include <vtkMaptkImageDataGeometryFilter.h>
 #include <vtkMatrix4x4.h>
 #include <vtkNew.h>
@@ -65,6 +68,7 @@
 #include <vtkProperty.h>
 #include <vtkRenderWindow.h>
 #include <vtkRenderer.h>
+#include <vtkSmartPointer.h>
 #include <vtkTextProperty.h>
 #include <vtkThreshold.h>
 #include <vtkTimeStamp.h>
@@ -86,16 +90,189 @@
 
 #include <QtCore/QDebug>
 
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
 using namespace LandmarkArrays;
 
 QTE_IMPLEMENT_D_FUNC(WorldView)
 
+namespace // anonymous
+{
+
+// Depth of the octree used to order landmarks for level-of-detail rendering
+static const int octreeDepth = 10;
+
+// Number of points in each reduced level of detail, from finest to coarsest
+static const vtkIdType landmarkLodSizes[] = { 1 << 19, 1 << 16 };
+static const size_t landmarkLodCount =
+  sizeof(landmarkLodSizes) / sizeof(*landmarkLodSizes);
+
+//-----------------------------------------------------------------------------
+unsigned int spreadBits(unsigned int v)
+{
+  // Spread the low 10 bits of the input so that there are two 0 bits between
+  // each input bit
+  v = (v | (v << 16)) & 0x030000ff;
+  v = (v | (v <<  8)) & 0x0300f00f;
+  v = (v | (v <<  4)) & 0x030c30c3;
+  v = (v | (v <<  2)) & 0x09249249;
+  return v;
+}
+
+//-----------------------------------------------------------------------------
+void radixSort(std::vector<std::pair<unsigned int, vtkIdType>>& items)
+{
+  static const int bitsPerPass = 10;
+  static const size_t bucketCount = size_t{1} << bitsPerPass;
+  static const auto mask = static_cast<unsigned int>(bucketCount - 1);
+
+  auto scratch = std::vector<std::pair<unsigned int, vtkIdType>>(items.size());
+  for (int shift = 0; shift < 3 * octreeDepth; shift += bitsPerPass)
+  {
+    auto offsets = std::vector<size_t>(bucketCount + 1, 0);
+    for (auto const& item : items)
+    {
+      ++offsets[((item.first >> shift) & mask) + 1];
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    for (auto const& item : items)
+    {
+      scratch[offsets[(item.first >> shift) & mask]++] = item;
+    }
+    items.swap(scratch);
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Select a spatially uniform subset of at most \p maxPoints points
+//
+// The points are sorted into a linear octree (i.e. by Morton code). Each
+// point is then assigned the coarsest octree level at which it is the first
+// point in its octree cell, so that taking all points up to a given level
+// yields (at most) one point per cell of that level. The returned list
+// contains the points of as many complete levels as fit in the budget, in
+// coarse-to-fine order, such that any prefix of the list which ends on a level
+// boundary is also a uniform subsample. The end of each level is written to
+// \p levelEnds.
+std::vector<vtkIdType> octreeSubsample(
+  double const* points, vtkIdType count, vtkIdType maxPoints,
+  std::vector<vtkIdType>& levelEnds)
+{
+  levelEnds.clear();
+
+  if (count < 1)
+  {
+    return {};
+  }
+
+  // Compute bounds of the point cloud
+  double lower[3] = { points[0], points[1], points[2] };
+  double upper[3] = { points[0], points[1], points[2] };
+  for (auto const i : qtIndexRange(count))
+  {
+    auto const p = points + (3 * i);
+    for (auto const k : qtIndexRange(3))
+    {
+      lower[k] = qMin(lower[k], p[k]);
+      upper[k] = qMax(upper[k], p[k]);
+    }
+  }
+
+  auto const extent = qMax(upper[0] - lower[0],
+                     qMax(upper[1] - lower[1], upper[2] - lower[2]));
+  auto const cells = static_cast<double>(1 << octreeDepth);
+  auto const scale = (extent > 0.0 ? (cells - 1.0) / extent : 0.0);
+
+  // Compute octree (Morton) codes and sort the points by them
+  auto codes = std::vector<std::pair<unsigned int, vtkIdType>>{};
+  codes.reserve(static_cast<size_t>(count));
+  for (auto const i : qtIndexRange(count))
+  {
+    auto const p = points + (3 * i);
+    auto code = 0u;
+    for (auto const k : qtIndexRange(3))
+    {
+      auto const q = static_cast<unsigned int>((p[k] - lower[k]) * scale);
+      code |= spreadBits(qMin(q, (1u << octreeDepth) - 1)) << k;
+    }
+    codes.push_back({code, i});
+  }
+  radixSort(codes);
+
+  // Assign each point the coarsest level at which it starts a new cell
+  auto levels = std::vector<unsigned char>(codes.size());
+  auto levelSizes = std::vector<vtkIdType>(octreeDepth + 2, 0);
+  levels[0] = 0;
+  ++levelSizes[0];
+  for (size_t i = 1; i < codes.size(); ++i)
+  {
+    auto const a = codes[i - 1].first, b = codes[i].first;
+    auto level = octreeDepth + 1;
+    for (auto const l : qtIndexRange(octreeDepth + 1))
+    {
+      auto const shift = 3 * (octreeDepth - l);
+      if ((a >> shift) != (b >> shift))
+      {
+        level = l;
+        break;
+      }
+    }
+    levels[i] = static_cast<unsigned char>(level);
+    ++levelSizes[level];
+  }
+
+  // Determine how many complete levels fit in the budget
+  auto maxLevel = 0;
+  auto total = levelSizes[0];
+  while (maxLevel + 1 < static_cast<int>(levelSizes.size()) &&
+         total + levelSizes[maxLevel + 1] <= maxPoints)
+  {
+    total += levelSizes[++maxLevel];
+  }
+
+  // Collect selected points, ordered by level
+  auto result = std::vector<vtkIdType>{};
+  result.reserve(static_cast<size_t>(total));
+  for (auto const l : qtIndexRange(maxLevel + 1))
+  {
+    for (size_t i = 0; i < codes.size(); ++i)
+    {
+      if (levels[i] == l)
+      {
+        result.push_back(codes[i].second);
+      }
+    }
+    levelEnds.push_back(static_cast<vtkIdType>(result.size()));
+  }
+
+  return result;
+}
+
+//-----------------------------------------------------------------------------
+void buildVerts(vtkCellArray* verts, vtkIdType const* ids, vtkIdType count)
+{
+  vtkNew<vtkIdTypeArray> connectivity;
+  auto const out = connectivity->WritePointer(0, 2 * count);
+  for (auto const i : qtIndexRange(count))
+  {
+    out[(2 * i) + 0] = 1;
+    out[(2 * i) + 1] = (ids ? ids[i] : i);
+  }
+
+  verts->SetCells(count, connectivity.GetPointer());
+}
+
+} // namespace <anonymous>
+
 //-----------------------------------------------------------------------------
 class WorldViewPrivate
 {
 public:
   WorldViewPrivate()
-    : rangeUpdateNeeded(false),
+    : imagePyramid(0),
+      rangeUpdateNeeded(false),
       validDepthInput(false),
       validImage(false),
       validTransform(false),
@@ -115,6 +292,7 @@ public:
                double ui, double uj, double uk);
 
   void updateImageTransform();
+  void updateImageLevel();
   void updateCameras(WorldView*);
   void updateScale(WorldView*);
   void updateAxes(WorldView*, bool immediate = false);
@@ -133,10 +311,21 @@ public:
   vtkNew<vtkUnsignedCharArray> landmarkColors;
   vtkNew<vtkUnsignedIntArray> landmarkObservations;
   vtkNew<vtkPolyDataMapper> landmarkMapper;
-  vtkNew<vtkActor> landmarkActor;
+  vtkNew<vtkLODActor> landmarkActor;
+
+  struct LandmarkLod
+  {
+    vtkNew<vtkPolyData> polyData;
+    vtkNew<vtkCellArray> verts;
+    vtkNew<vtkPolyDataMapper> mapper;
+  };
+  LandmarkLod landmarkLods[landmarkLodCount];
+  QHash<QString, FieldInformation> landmarkFields;
 
   vtkNew<vtkImageActor> imageActor;
   vtkNew<vtkImageData> emptyImage;
+  vtkSmartPointer<vtkImageData> imageData;
+  ImagePyramid* imagePyramid;
 
   vtkNew<vtkPlaneSource> groundPlane;
   vtkNew<vtkActor> groundActor;
@@ -238,6 +427,32 @@ void WorldViewPrivate::updateImageTransform()
   this->imageActor->SetUserMatrix(xf.GetPointer());
 }
 
+//-----------------------------------------------------------------------------
+void WorldViewPrivate::updateImageLevel()
+{
+  // The projected image is small on screen, so large images are shown using
+  // a pyramid level that fits in a single modest texture
+  static auto const maximumTextureSize = 2048;
+
+  if (!this->imageData)
+  {
+    this->imageActor->SetInputData(this->emptyImage.GetPointer());
+    return;
+  }
+
+  auto data = vtkSmartPointer<vtkImageData>(this->imageData);
+  auto const pyramid = this->imagePyramid;
+  if (pyramid && pyramid->image() == this->imageData)
+  {
+    data = pyramid->level(pyramid->levelForSize(maximumTextureSize));
+  }
+
+  if (this->imageActor->GetInput() != data)
+  {
+    this->imageActor->SetInputData(data);
+  }
+}
+
 //-----------------------------------------------------------------------------
 void WorldViewPrivate::updateCameras(WorldView* q)
 {
@@ -401,6 +616,10 @@ WorldView::WorldView(QWidget* parent, Qt::WindowFlags flags)
   d->landmarkObservations->SetName(Observations);
   d->landmarkObservations->SetNumberOfComponents(1);
 
+  // Landmarks may be in geographic (e.g. UTM) coordinates, whose magnitude
+  // leaves too little precision in single precision floating point
+  d->landmarkPoints->SetDataTypeToDouble();
+
   landmarkPolyData->SetPoints(d->landmarkPoints.GetPointer());
   landmarkPolyData->SetVerts(d->landmarkVerts.GetPointer());
   landmarkPointData->AddArray(d->landmarkColors.GetPointer());
@@ -414,6 +633,25 @@ WorldView::WorldView(QWidget* parent, Qt::WindowFlags flags)
 
   d->landmarkOptions->addMapper(d->landmarkMapper.GetPointer());
 
+  // Set up reduced levels of detail for the landmarks; these share the points
+  // and point data of the full landmark set, but use only a subset of the
+  // vertices, and are selected by the actor when the full set cannot be drawn
+  // within the allotted time (i.e. during interaction)
+  for (auto& lod : d->landmarkLods)
+  {
+    auto const lodPointData = lod.polyData->GetPointData();
+
+    lod.polyData->SetPoints(d->landmarkPoints.GetPointer());
+    lod.polyData->SetVerts(d->landmarkVerts.GetPointer());
+    lodPointData->AddArray(d->landmarkColors.GetPointer());
+    lodPointData->AddArray(d->landmarkElevations.GetPointer());
+    lodPointData->AddArray(d->landmarkObservations.GetPointer());
+    lod.mapper->SetInputData(lod.polyData.GetPointer());
+
+    d->landmarkActor->AddLODMapper(lod.mapper.GetPointer());
+    d->landmarkOptions->addMapper(lod.mapper.GetPointer());
+  }
+
   // Set up ground plane grid
   d->groundPlane->SetOrigin(-10.0, -10.0, 0.0);
   d->groundPlane->SetPoint1(+10.0, -10.0, 0.0);
@@ -675,7 +913,8 @@ void WorldView::setImageData(vtkImageData* data, QSize const& dimensions)
 
   auto const showImage = d->UI.actionShowFrameImage->isChecked();
   d->validImage = data;
-  d->imageActor->SetInputData(data ? data : d->emptyImage.GetPointer());
+  d->imageData = data;
+  d->updateImageLevel();
   d->imageActor->SetVisibility(data && d->validTransform && showImage);
   d->UI.renderWidget->update();
 }
@@ -693,39 +932,69 @@ void WorldView::setLandmarks(kwiver::vital::landmark_map const& lm)
   auto maxObservations = unsigned{0};
   auto minZ = qInf(), maxZ = -qInf();
 
-  d->landmarkPoints->Reset();
-  d->landmarkVerts->Reset();
-  d->landmarkColors->Reset();
-  d->landmarkElevations->Reset();
-  d->landmarkObservations->Reset();
-  d->landmarkPoints->Allocate(size);
-  d->landmarkVerts->Allocate(size);
-  d->landmarkColors->Allocate(3 * size);
-  d->landmarkElevations->Allocate(size);
-  d->landmarkObservations->Allocate(size);
-
-  vtkIdType vertIndex = 0;
+  // Fill the landmark arrays in place
+  d->landmarkPoints->SetNumberOfPoints(size);
+  auto const points =
+    static_cast<double*>(d->landmarkPoints->GetVoidPointer(0));
+  auto const colors = d->landmarkColors->WritePointer(0, 3 * size);
+  auto const elevations = d->landmarkElevations->WritePointer(0, size);
+  auto const observations = d->landmarkObservations->WritePointer(0, size);
+
+  vtkIdType index = 0;
   foreach (auto const& lm, landmarks)
   {
     auto const& pos = lm.second->loc();
     auto const& color = lm.second->color();
-    auto const observations = lm.second->observations();
-
-    d->landmarkPoints->InsertNextPoint(pos.data());
-    d->landmarkVerts->InsertNextCell(1);
-    d->landmarkVerts->InsertCellPoint(vertIndex++);
-    d->landmarkColors->InsertNextValue(color.r);
-    d->landmarkColors->InsertNextValue(color.g);
-    d->landmarkColors->InsertNextValue(color.b);
-    d->landmarkElevations->InsertNextValue(pos[2]);
-    d->landmarkObservations->InsertNextValue(observations);
+    auto const lmObservations = lm.second->observations();
+
+    points[(3 * index) + 0] = pos[0];
+    points[(3 * index) + 1] = pos[1];
+    points[(3 * index) + 2] = pos[2];
+    colors[(3 * index) + 0] = color.r;
+    colors[(3 * index) + 1] = color.g;
+    colors[(3 * index) + 2] = color.b;
+    elevations[index] = pos[2];
+    observations[index] = lmObservations;
+    ++index;
 
     haveColor = haveColor || (color != defaultColor);
-    maxObservations = qMax(maxObservations, observations);
+    maxObservations = qMax(maxObservations, lmObservations);
     minZ = qMin(minZ, pos[2]);
     maxZ = qMax(maxZ, pos[2]);
   }
 
+  buildVerts(d->landmarkVerts.GetPointer(), 0, size);
+
+  // Build reduced levels of detail for large landmark sets; each is the
+  // largest run of complete octree levels that fits in its point budget
+  auto lodLevelEnds = std::vector<vtkIdType>{};
+  auto const lodPoints =
+    (size > landmarkLodSizes[0]
+     ? octreeSubsample(points, size, landmarkLodSizes[0], lodLevelEnds)
+     : std::vector<vtkIdType>{});
+  for (auto const i : qtIndexRange(landmarkLodCount))
+  {
+    auto& lod = d->landmarkLods[i];
+    if (lodPoints.empty())
+    {
+      // Small enough to always draw in full
+      lod.polyData->SetVerts(d->landmarkVerts.GetPointer());
+    }
+    else
+    {
+      auto lodSize = lodLevelEnds.front();
+      foreach (auto const end, lodLevelEnds)
+      {
+        if (end <= landmarkLodSizes[i])
+        {
+          lodSize = end;
+        }
+      }
+      buildVerts(lod.verts.GetPointer(), lodPoints.data(), lodSize);
+      lod.polyData->SetVerts(lod.verts.GetPointer());
+    }
+  }
+
   auto fields = QHash<QString, FieldInformation>{};
   fields.insert("Elevation", FieldInformation{Elevation, {minZ, maxZ}});
   if (maxObservations)
@@ -734,18 +1003,95 @@ void WorldView::setLandmarks(kwiver::vital::landmark_map const& lm)
     fields.insert("Observations", FieldInformation{Observations, {0.0, upper}});
   }
 
+  d->landmarkFields = fields;
   d->landmarkOptions->setTrueColorAvailable(haveColor);
   d->landmarkOptions->setDataFields(fields);
 
   d->landmarkPoints->Modified();
   d->landmarkVerts->Modified();
   d->landmarkColors->Modified();
+  d->landmarkElevations->Modified();
   d->landmarkObservations->Modified();
 
   d->updateScale(this);
   d->updateAxes(this);
 }
 
+//-----------------------------------------------------------------------------
+void WorldView::moveLandmarks(
+  Eigen::Matrix3Xd const& positions, QVector<int> const& indices)
+{
+  QTE_D();
+
+  auto const size = d->landmarkPoints->GetNumberOfPoints();
+  if (positions.cols() != size)
+  {
+    qWarning() << "WorldView::moveLandmarks: expected" << size
+               << "positions, but got" << positions.cols();
+    return;
+  }
+
+  auto const points =
+    static_cast<double*>(d->landmarkPoints->GetVoidPointer(0));
+  auto const elevations = d->landmarkElevations->GetPointer(0);
+
+  foreach (auto const i, indices)
+  {
+    auto const& pos = positions.col(i);
+    points[(3 * i) + 0] = pos[0];
+    points[(3 * i) + 1] = pos[1];
+    points[(3 * i) + 2] = pos[2];
+    elevations[i] = pos[2];
+  }
+
+  // Update elevation range, if it changed
+  if (size)
+  {
+    auto const& z = positions.row(2);
+    auto& elevation = d->landmarkFields["Elevation"];
+    if (elevation.range[0] != z.minCoeff() ||
+        elevation.range[1] != z.maxCoeff())
+    {
+      elevation.range[0] = z.minCoeff();
+      elevation.range[1] = z.maxCoeff();
+      d->landmarkOptions->setDataFields(d->landmarkFields);
+    }
+  }
+
+  d->landmarkPoints->Modified();
+  d->landmarkElevations->Modified();
+
+  d->updateScale(this);
+  d->updateAxes(this);
+}
+
+//-----------------------------------------------------------------------------
+void WorldView::setImagePyramid(ImagePyramid* pyramid)
+{
+  QTE_D();
+
+  if (d->imagePyramid)
+  {
+    disconnect(d->imagePyramid, 0, this, 0);
+  }
+
+  d->imagePyramid = pyramid;
+
+  if (pyramid)
+  {
+    connect(pyramid, SIGNAL(levelReady(int)), this, SLOT(updateImageLevel()));
+  }
+}
+
+//-----------------------------------------------------------------------------
+void WorldView::updateImageLevel()
+{
+  QTE_D();
+
+  d->updateImageLevel();
+  d->UI.renderWidget->update();
+}
+
 //-----------------------------------------------------------------------------
 void WorldView::setImageVisible(bool state)
 {
@@ -31,10 +31,14 @@
 #ifndef MAPTK_WORLDVIEW_H_
 #define MAPTK_WORLDVIEW_H_
 
+#include <vital/types/vector.h>
+
 #include <qtGlobal.h>
 
 #include <QtGui/QWidget>
 
+#include <QtCore/QVector>
+
 class vtkMaptkImageDataGeometryFilter;
 class vtkImageData;
 class vtkPolyData;
@@ -43,6 +47,7 @@ namespace kwiver { namespace vital { class landmark_map; } }
 
 class vtkMaptkCamera;
 
+class ImagePyramid;
 class WorldViewPrivate;
 
 class WorldView : public QWidget
@@ -53,6 +58,20 @@ public:
   explicit WorldView(QWidget* parent = 0, Qt::WindowFlags flags = 0);
   virtual ~WorldView();
 
+  /// Set the pyramid used to display large images.
+  ///
+  /// When the image passed to setImageData() is the source of \p pyramid,
+  /// a reduced resolution level of the pyramid is displayed instead.
+  void setImagePyramid(ImagePyramid* pyramid);
+
+  /// Update the positions of existing landmarks.
+  ///
+  /// \p positions holds the positions of all landmarks, in the order in which
+  /// they were given to setLandmarks(). Only the landmarks at \p indices are
+  /// updated; all other landmark data is unchanged.
+  void moveLandmarks(Eigen::Matrix3Xd const& positions,
+                     QVector<int> const& indices);
+
 signals:
   void depthMapThresholdsChanged();
   void depthMapEnabled(bool);
@@ -104,6 +123,7 @@ protected slots:
   void increaseDepthMapPointSize();
   void decreaseDepthMapPointSize();
   void updateThresholdRanges();
+  void updateImageLevel();
 
 private:
   QTE_DECLARE_PRIVATE_RPTR(WorldView)
@@ -30,16 +30,70 @@
 
 #include "AbstractTool.h"
 
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QMutex>
 #include <QtCore/QThread>
+#include <QtCore/QTimer>
 
 #include <atomic>
 
+namespace // anonymous
+{
+
+//-----------------------------------------------------------------------------
+// Find the landmarks that moved between two landmark maps
+//
+// Returns false if the maps differ in any other way. Since unchanged
+// landmarks are shared between successive maps, this only needs to examine
+// those whose pointers differ.
+bool findMovedLandmarks(kwiver::vital::landmark_map_sptr const& before,
+                        kwiver::vital::landmark_map_sptr const& after,
+                        ToolData::landmark_moves_t& moves)
+{
+  if (!before || !after || before->size() != after->size())
+  {
+    return false;
+  }
+
+  auto const& oldMap = before->landmarks();
+  auto const& newMap = after->landmarks();
+
+  auto oldIter = oldMap.cbegin();
+  for (auto newIter = newMap.cbegin(); newIter != newMap.cend();
+       ++newIter, ++oldIter)
+  {
+    auto const& lm = newIter->second;
+    auto const& oldLm = oldIter->second;
+    if (newIter->first != oldIter->first)
+    {
+      return false;
+    }
+    if (lm != oldLm)
+    {
+      if (!lm || !oldLm ||
+          lm->color() != oldLm->color() ||
+          lm->observations() != oldLm->observations())
+      {
+        return false;
+      }
+      moves.insert(moves.end(), std::make_pair(newIter->first, lm->loc()));
+    }
+  }
+
+  return true;
+}
+
+} // namespace <anonymous>
+
 //-----------------------------------------------------------------------------
 class AbstractToolPrivate : public QThread
 {
 public:
   AbstractToolPrivate(AbstractTool* q)
-    : data(std::make_shared<ToolData>()), q_ptr(q) {}
+    : data(std::make_shared<ToolData>()),
+      updateInterval(AbstractTool::defaultUpdateInterval()),
+      progressQueued(false),
+      q_ptr(q) {}
 
   virtual void run() QTE_OVERRIDE;
 
@@ -47,6 +101,17 @@ public:
 
   std::atomic<bool> cancelRequested;
 
+  // Progress is double buffered; the tool thread replaces progressData with
+  // each report, and the owning thread takes it when it is ready for an update
+  int updateInterval;
+  QElapsedTimer progressTimer; // Time since the last delivered update
+  QMutex progressMutex;
+  std::shared_ptr<ToolData> progressData;
+  bool progressQueued;
+
+  // Landmarks of the last report, used by the tool thread to find moves
+  kwiver::vital::landmark_map_sptr reportedLandmarks;
+
 protected:
   QTE_DECLARE_PUBLIC_PTR(AbstractTool)
   QTE_DECLARE_PUBLIC(AbstractTool)
@@ -61,9 +126,86 @@ void AbstractToolPrivate::run()
   q->run();
 }
 
+//-----------------------------------------------------------------------------
+ToolData::ToolData()
+  : landmarksMoved(false),
+    tracksShared(false), camerasShared(false), landmarksShared(false)
+{
+}
+
+//-----------------------------------------------------------------------------
+void ToolData::shareTracks(track_set_sptr const& newTracks)
+{
+  this->tracks = newTracks;
+  this->tracksShared = true;
+}
+
+//-----------------------------------------------------------------------------
+void ToolData::shareCameras(camera_map_sptr const& newCameras)
+{
+  this->cameras = newCameras;
+  this->camerasShared = true;
+}
+
+//-----------------------------------------------------------------------------
+void ToolData::shareLandmarks(landmark_map_sptr const& newLandmarks)
+{
+  this->landmarks = newLandmarks;
+  this->landmarksShared = true;
+}
+
+//-----------------------------------------------------------------------------
+void ToolData::detachTracks()
+{
+  if (this->tracksShared)
+  {
+    this->copyTracks(this->tracks);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void ToolData::detachCameras()
+{
+  if (this->camerasShared)
+  {
+    this->copyCameras(this->cameras);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void ToolData::detachLandmarks()
+{
+  if (this->landmarksShared)
+  {
+    this->copyLandmarks(this->landmarks);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void ToolData::mergeLandmarkMoves(ToolData const& earlier)
+{
+  if (!this->landmarksMoved)
+  {
+    return;
+  }
+
+  if (!earlier.landmarksMoved)
+  {
+    this->landmarksMoved = false;
+    this->movedLandmarks.clear();
+    return;
+  }
+
+  // Inserting does not replace existing entries, so newer positions are kept
+  this->movedLandmarks.insert(earlier.movedLandmarks.cbegin(),
+                              earlier.movedLandmarks.cend());
+}
+
 //-----------------------------------------------------------------------------
 void ToolData::copyTracks(track_set_sptr const& newTracks)
 {
+  this->tracksShared = false;
+
   if (newTracks)
   {
     auto copiedTracks = std::vector<kwiver::vital::track_sptr>{};
@@ -83,6 +225,7 @@ void ToolData::copyTracks(track_set_sptr const& newTracks)
 //-----------------------------------------------------------------------------
 void ToolData::copyCameras(camera_map_sptr const& newCameras)
 {
+  this->camerasShared = false;
   if (newCameras)
   {
     auto copiedCameras = kwiver::vital::camera_map::map_camera_t{};
@@ -102,6 +245,7 @@ void ToolData::copyCameras(camera_map_sptr const& newCameras)
 //-----------------------------------------------------------------------------
 void ToolData::copyLandmarks(landmark_map_sptr const& newLandmarks)
 {
+  this->landmarksShared = false;
   if (newLandmarks)
   {
     auto copiedLandmarks = kwiver::vital::landmark_map::map_landmark_t{};
@@ -161,6 +305,93 @@ AbstractTool::landmark_map_sptr AbstractTool::landmarks() const
   return d->data->landmarks;
 }
 
+//-----------------------------------------------------------------------------
+int AbstractTool::updateInterval() const
+{
+  QTE_D();
+  return d->updateInterval;
+}
+
+//-----------------------------------------------------------------------------
+void AbstractTool::setUpdateInterval(int interval)
+{
+  QTE_D();
+  d->updateInterval = interval;
+}
+
+//-----------------------------------------------------------------------------
+int AbstractTool::defaultUpdateInterval()
+{
+  return 100;
+}
+
+//-----------------------------------------------------------------------------
+void AbstractTool::reportProgress(std::shared_ptr<ToolData> const& data)
+{
+  QTE_D();
+
+  // Compare the landmarks with those of the previous report here, so that
+  // the receiving (UI) thread only needs to apply the moves
+  data->movedLandmarks.clear();
+  data->landmarksMoved =
+    data->landmarks == d->reportedLandmarks ||
+    findMovedLandmarks(d->reportedLandmarks, data->landmarks,
+                       data->movedLandmarks);
+  if (!data->landmarksMoved)
+  {
+    data->movedLandmarks.clear();
+  }
+  d->reportedLandmarks = data->landmarks;
+
+  QMutexLocker locker(&d->progressMutex);
+
+  // Data that has not been delivered is replaced, so its moves must be
+  // carried over
+  if (d->progressData)
+  {
+    data->mergeLandmarkMoves(*d->progressData);
+  }
+  d->progressData = data;
+  if (!d->progressQueued)
+  {
+    d->progressQueued = true;
+    QMetaObject::invokeMethod(this, "deliverProgress", Qt::QueuedConnection);
+  }
+}
+
+//-----------------------------------------------------------------------------
+void AbstractTool::deliverProgress()
+{
+  QTE_D();
+
+  // Wait until the update interval has elapsed; anything reported in the
+  // mean time replaces the pending data
+  if (d->progressTimer.isValid())
+  {
+    auto const remaining =
+      d->updateInterval - static_cast<int>(d->progressTimer.elapsed());
+    if (remaining > 0)
+    {
+      QTimer::singleShot(remaining, this, SLOT(deliverProgress()));
+      return;
+    }
+  }
+
+  auto data = std::shared_ptr<ToolData>{};
+  d->progressMutex.lock();
+  data.swap(d->progressData);
+  d->progressQueued = false;
+  d->progressMutex.unlock();
+
+  // Drop progress that arrives after the tool has finished, as the final
+  // results have already been delivered
+  if (data && d->isRunning())
+  {
+    d->progressTimer.start();
+    emit this->updated(data);
+  }
+}
+
 //-----------------------------------------------------------------------------
 void AbstractTool::cancel()
 {
@@ -172,21 +403,21 @@ void AbstractTool::cancel()
 void AbstractTool::setTracks(track_set_sptr const& newTracks)
 {
   QTE_D();
-  d->data->copyTracks(newTracks);
+  d->data->shareTracks(newTracks);
 }
 
 //-----------------------------------------------------------------------------
 void AbstractTool::setCameras(camera_map_sptr const& newCameras)
 {
   QTE_D();
-  d->data->copyCameras(newCameras);
+  d->data->shareCameras(newCameras);
 }
 
 //-----------------------------------------------------------------------------
 void AbstractTool::setLandmarks(landmark_map_sptr const& newLandmarks)
 {
   QTE_D();
-  d->data->copyLandmarks(newLandmarks);
+  d->data->shareLandmarks(newLandmarks);
 }
 
 //-----------------------------------------------------------------------------
@@ -195,6 +426,13 @@ bool AbstractTool::execute(QWidget* window)
   QTE_D();
 
   d->cancelRequested = false;
+
+  d->progressMutex.lock();
+  d->progressData.reset();
+  d->progressMutex.unlock();
+  d->progressTimer.invalidate();
+  d->reportedLandmarks = d->data->landmarks;
+
   d->start();
   return true;
 }
@@ -39,15 +39,38 @@
 
 #include <QtGui/QAction>
 
+#include <map>
+
 class AbstractToolPrivate;
 
 /// A class to hold data that is modified by the tool
+///
+/// Data may be either shared with or copied from its source. Shared data is a
+/// snapshot that references the same maps and elements as the source, which
+/// (as is the convention for vital data types) are treated as immutable;
+/// algorithms that produce new data replace the maps and any changed elements
+/// rather than modifying them in place. Code which needs to modify elements in
+/// place must first detach the data, which makes a deep copy only if the data
+/// is still shared.
 class ToolData
 {
 public:
   typedef kwiver::vital::track_set_sptr track_set_sptr;
   typedef kwiver::vital::camera_map_sptr camera_map_sptr;
   typedef kwiver::vital::landmark_map_sptr landmark_map_sptr;
+  typedef std::map<kwiver::vital::landmark_id_t, kwiver::vital::vector_3d>
+    landmark_moves_t;
+
+  ToolData();
+
+  /// Share the tracks with this data class
+  void shareTracks(track_set_sptr const&);
+
+  /// Share the cameras with this data class
+  void shareCameras(camera_map_sptr const&);
+
+  /// Share the landmarks with this data class
+  void shareLandmarks(landmark_map_sptr const&);
 
   /// Deep copy the tracks into this data class
   void copyTracks(track_set_sptr const&);
@@ -58,9 +81,49 @@ public:
   /// Deep copy the landmarks into this data class
   void copyLandmarks(landmark_map_sptr const&);
 
+  /// Replace shared tracks with a deep copy
+  ///
+  /// This must be called before modifying any track in place. It does
+  /// nothing if the tracks are not shared.
+  void detachTracks();
+
+  /// Replace shared cameras with a deep copy
+  ///
+  /// This must be called before modifying any camera in place. It does
+  /// nothing if the cameras are not shared.
+  void detachCameras();
+
+  /// Replace shared landmarks with a deep copy
+  ///
+  /// This must be called before modifying any landmark in place. It does
+  /// nothing if the landmarks are not shared.
+  void detachLandmarks();
+
+  /// Combine the landmark moves of an earlier update with those of this data
+  ///
+  /// This is used when \p earlier was never applied, so that the moves of
+  /// this data become relative to the landmarks that \p earlier was relative
+  /// to. Moves in this data take precedence over those in \p earlier.
+  void mergeLandmarkMoves(ToolData const& earlier);
+
   track_set_sptr tracks;
   camera_map_sptr cameras;
   landmark_map_sptr landmarks;
+
+  /// Whether #movedLandmarks fully describes the change to the landmarks
+  ///
+  /// This is set by AbstractTool for intermediate results whose landmarks
+  /// differ from the previously reported landmarks only in the positions of
+  /// some landmarks. When \c false, the receiver must use #landmarks.
+  bool landmarksMoved;
+
+  /// New positions of the landmarks that moved since the previous update
+  landmark_moves_t movedLandmarks;
+
+private:
+  bool tracksShared;
+  bool camerasShared;
+  bool landmarksShared;
 };
 
 Q_DECLARE_METATYPE(std::shared_ptr<ToolData>)
@@ -95,6 +158,18 @@ public:
   /// \c true implies that calling cancel() may have an effect.
   virtual bool isCancelable() const = 0;
 
+  /// Get the minimum interval between progress updates, in milliseconds.
+  int updateInterval() const;
+
+  /// Set the minimum interval between progress updates, in milliseconds.
+  ///
+  /// Intermediate results reported by the tool more often than this are
+  /// coalesced, such that only the most recent is delivered.
+  void setUpdateInterval(int);
+
+  /// Get the default minimum interval between progress updates.
+  static int defaultUpdateInterval();
+
   /// Return a shared pointer to the tools data
   std::shared_ptr<ToolData> data();
 
@@ -126,7 +201,8 @@ public:
   /// tracks.
   ///
   /// This may also be used by tool implementations to get the input tracks.
-  /// (The tracks will be a copy that can be safely modified.)
+  /// (The tracks may be shared with the caller, and must not be modified in
+  /// place without first calling ToolData::detachTracks() on data().)
   ///
   /// \warning Users must not call this method while the tool is executing,
   ///          as doing so may not be thread safe.
@@ -139,7 +215,8 @@ public:
   /// cameras.
   ///
   /// This may also be used by tool implementations to get the input cameras.
-  /// (The cameras will be a copy that can be safely modified.)
+  /// (The cameras may be shared with the caller, and must not be modified in
+  /// place without first calling ToolData::detachCameras() on data().)
   ///
   /// \warning Users must not call this method while the tool is executing,
   ///          as doing so may not be thread safe.
@@ -152,7 +229,8 @@ public:
   /// landmarks.
   ///
   /// This may also be used by tool implementations to get the input landmarks.
-  /// (The landmarks will be a copy that can be safely modified.)
+  /// (The landmarks may be shared with the caller, and must not be modified in
+  /// place without first calling ToolData::detachLandmarks() on data().)
   ///
   /// \warning Users must not call this method while the tool is executing,
   ///          as doing so may not be thread safe.
@@ -162,6 +240,8 @@ signals:
   /// Emitted when the tool execution is completed.
   void completed();
   /// Emitted when an intermediate update of the data is available to show progress.
+  ///
+  /// \sa reportProgress
   void updated(std::shared_ptr<ToolData>);
 
   /// Emitted when the tool execution terminates due to user cancellation.
@@ -186,6 +266,19 @@ protected:
   /// Check if the user has requested that tool execution be canceled.
   bool isCanceled() const;
 
+  /// Report intermediate results.
+  ///
+  /// This may be called from run() to make intermediate results available to
+  /// the user. The data is held until the receiving thread is ready for it,
+  /// and replaces any previously reported data that has not yet been
+  /// delivered; updated() is emitted (in the thread that owns the tool) at
+  /// most once per updateInterval().
+  ///
+  /// If the landmarks have only moved since the previous report, the moved
+  /// landmarks are recorded in ToolData::movedLandmarks, so that receivers
+  /// need not compare the landmark maps themselves.
+  void reportProgress(std::shared_ptr<ToolData> const&);
+
   /// Test if the tool has track data.
   ///
   /// \return \c true if the tool data has a non-zero number of feature tracks,
@@ -206,22 +299,22 @@ protected:
 
   /// Set the tracks produced by the tool.
   ///
-  /// This sets the tracks that are produced by the tool as output. Unlike
-  /// setTracks, this does not make a deep copy of the provided tracks.
+  /// This sets the tracks that are produced by the tool as output.
   void updateTracks(track_set_sptr const&);
 
   /// Set the cameras produced by the tool.
   ///
-  /// This sets the cameras that are produced by the tool as output. Unlike
-  /// setCameras, this does not make a deep copy of the provided cameras.
+  /// This sets the cameras that are produced by the tool as output.
   void updateCameras(camera_map_sptr const&);
 
   /// Set the landmarks produced by the tool.
   ///
-  /// This sets the landmarks that are produced by the tool as output. Unlike
-  /// setCameras, this does not make a deep copy of the provided landmarks.
+  /// This sets the landmarks that are produced by the tool as output.
   void updateLandmarks(landmark_map_sptr const&);
 
+private slots:
+  void deliverProgress();
+
 private:
   QTE_DECLARE_PRIVATE_RPTR(AbstractTool)
   QTE_DECLARE_PRIVATE(AbstractTool)
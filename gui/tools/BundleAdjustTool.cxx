@@ -30,12 +30,11 @@
 
 #include "BundleAdjustTool.h"
 
+#include <maptk/config_cache.h>
 #include <maptk/version.h>
 
 #include <vital/algo/bundle_adjust.h>
 
-#include <vital/config/config_block_io.h>
-
 #include <qtStlUtil.h>
 
 #include <QtGui/QApplication>
@@ -55,11 +54,11 @@ kwiver::vital::config_block_sptr readConfig(std::string const& name)
 {
   try
   {
-    using kwiver::vital::read_config_file;
+    using kwiver::maptk::read_cached_config_file;
 
     auto const exeDir = QDir(QApplication::applicationDirPath());
     auto const prefix = stdString(exeDir.absoluteFilePath(".."));
-    return read_config_file(name, "maptk", MAPTK_VERSION, prefix);
+    return read_cached_config_file(name, "maptk", MAPTK_VERSION, prefix);
   }
   catch (...)
   {
@@ -166,11 +165,12 @@ void BundleAdjustTool::run()
 bool BundleAdjustTool::callback_handler(camera_map_sptr cameras,
                                         landmark_map_sptr landmarks)
 {
-  // make a copy of the tool data
+  // share the intermediate results; the algorithm builds new maps for each
+  // update rather than modifying those it has already passed on
   auto data = std::make_shared<ToolData>();
-  data->copyCameras(cameras);
-  data->copyLandmarks(landmarks);
+  data->shareCameras(cameras);
+  data->shareLandmarks(landmarks);
 
-  emit updated(data);
+  this->reportProgress(data);
   return !this->isCanceled();
 }
@@ -30,12 +30,11 @@
 
 #include "CanonicalTransformTool.h"
 
+#include <maptk/config_cache.h>
 #include <maptk/version.h>
 
 #include <vital/algo/estimate_canonical_transform.h>
 
-#include <vital/config/config_block_io.h>
-
 #include <arrows/core/transform.h>
 
 #include <qtStlUtil.h>
@@ -57,11 +56,11 @@ kwiver::vital::config_block_sptr readConfig(std::string const& name)
 {
   try
   {
-    using kwiver::vital::read_config_file;
+    using kwiver::maptk::read_cached_config_file;
 
     auto const exeDir = QDir(QApplication::applicationDirPath());
     auto const prefix = stdString(exeDir.absoluteFilePath(".."));
-    return read_config_file(name, "maptk", MAPTK_VERSION, prefix);
+    return read_cached_config_file(name, "maptk", MAPTK_VERSION, prefix);
   }
   catch (...)
   {
@@ -30,11 +30,11 @@
 
 #include "InitCamerasLandmarksTool.h"
 
+#include <maptk/config_cache.h>
 #include <maptk/version.h>
 
 #include <vital/algo/initialize_cameras_landmarks.h>
 
-#include <vital/config/config_block_io.h>
 #include <vital/vital_foreach.h>
 
 #include <qtStlUtil.h>
@@ -57,11 +57,11 @@ kwiver::vital::config_block_sptr readConfig(std::string const& name)
 {
   try
   {
-    using kwiver::vital::read_config_file;
+    using kwiver::maptk::read_cached_config_file;
 
     auto const exeDir = QDir(QApplication::applicationDirPath());
     auto const prefix = stdString(exeDir.absoluteFilePath(".."));
-    return read_config_file(name, "maptk", MAPTK_VERSION, prefix);
+    return read_cached_config_file(name, "maptk", MAPTK_VERSION, prefix);
   }
   catch (...)
   {
@@ -208,11 +208,12 @@ void InitCamerasLandmarksTool::run()
 bool InitCamerasLandmarksTool::callback_handler(camera_map_sptr cameras,
                                                 landmark_map_sptr landmarks)
 {
-  // make a copy of the tool data
+  // share the intermediate results; the algorithm builds new maps for each
+  // update rather than modifying those it has already passed on
   auto data = std::make_shared<ToolData>();
-  data->copyCameras(cameras);
-  data->copyLandmarks(landmarks);
+  data->shareCameras(cameras);
+  data->shareLandmarks(landmarks);
 
-  emit updated(data);
+  this->reportProgress(data);
   return !this->isCanceled();
 }
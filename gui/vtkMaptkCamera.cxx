@@ -31,6 +31,7 @@
 #include "vtkMaptkCamera.h"
 
 #include <vital/io/camera_io.h>
+#include <vital/vital_foreach.h>
 
 #include <vtkMath.h>
 #include <vtkMatrix4x4.h>
@@ -114,6 +115,69 @@ bool vtkMaptkCamera::ProjectPoint(kwiver::vital::vector_3d const& in,
   out[1] = ppos[1];
   return true;
 }
+
+//-----------------------------------------------------------------------------
+void vtkMaptkCamera::ProjectPoints(Eigen::Matrix3Xd const& in,
+                                   std::vector<int>& indices,
+                                   Eigen::Matrix2Xd& out)
+{
+  auto const count = static_cast<int>(in.cols());
+
+  // Transform all points to camera space at once, so that Eigen can use
+  // vectorized arithmetic, then divide by depth to get normalized image
+  // coordinates (points behind the camera are dropped below)
+  auto const& R = this->MaptkCamera->rotation().matrix();
+  auto const& center = this->MaptkCamera->center();
+  Eigen::Matrix3Xd const cameraPoints = R * (in.colwise() - center);
+  Eigen::Matrix2Xd normPoints =
+    cameraPoints.topRows<2>().array().rowwise() /
+    cameraPoints.row(2).array();
+
+  // Apply intrinsics; without lens distortion, this is just an affine
+  // transform that is also applied to all points at once
+  auto const& ci = this->MaptkCamera->intrinsics();
+  auto distorted = false;
+  VITAL_FOREACH (auto const d, ci->dist_coeffs())
+  {
+    distorted = distorted || (d != 0.0);
+  }
+  if (!distorted)
+  {
+    Eigen::Matrix3d const K = ci->as_matrix();
+    normPoints = (K.topLeftCorner<2, 2>() * normPoints).colwise() +
+                 K.topRightCorner<2, 1>();
+  }
+
+  // Cull points outside the camera frustum
+  auto const w = this->ImageDimensions[0];
+  auto const h = this->ImageDimensions[1];
+  auto const cullToImage = (w > 0 && h > 0);
+
+  indices.clear();
+  out.resize(2, count);
+  for (int i = 0; i < count; ++i)
+  {
+    if (cameraPoints(2, i) <= 0.0)
+    {
+      continue;
+    }
+
+    auto p = kwiver::vital::vector_2d(normPoints.col(i));
+    if (distorted)
+    {
+      p = ci->map(p);
+    }
+
+    if (cullToImage && (p[0] < 0.0 || p[0] > w || p[1] < 0.0 || p[1] > h))
+    {
+      continue;
+    }
+
+    out.col(static_cast<int>(indices.size())) = p;
+    indices.push_back(i);
+  }
+  out.conservativeResize(2, static_cast<int>(indices.size()));
+}
 /**
   *
   * WARNING: The convention here is that depth is NOT the distance between the
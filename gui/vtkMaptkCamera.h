@@ -36,6 +36,8 @@
 #include <vtkCamera.h>
 #include <vtkSmartPointer.h>
 
+#include <vector>
+
 class vtkMaptkCamera : public vtkCamera
 {
 public:
@@ -54,6 +56,16 @@ public:
   bool ProjectPoint(kwiver::vital::vector_3d const& point,
                     double (&projPoint)[2]);
 
+  // Description:
+  // Project many 3D points (one per column) to 2D using the internal maptk
+  // camera. Points behind the camera, or outside the image if
+  // ImageDimensions is set, are culled. The indices of the remaining points
+  // are returned in \p indices, and their projections in the corresponding
+  // columns of \p projPoints.
+  void ProjectPoints(Eigen::Matrix3Xd const& points,
+                     std::vector<int>& indices,
+                     Eigen::Matrix2Xd& projPoints);
+
   // Description:
   // Reverse project 2D point to 3D using the internal maptk camera and
   // specified depth
@@ -36,51 +36,207 @@
 #include <vtkCellArray.h>
 #include <vtkNew.h>
 #include <vtkObjectFactory.h>
+#include <vtkPoints.h>
 #include <vtkPolyData.h>
 #include <vtkPolyDataMapper.h>
+#include <vtkSmartPointer.h>
 
-#include <map>
+#include <algorithm>
+#include <vector>
 
 vtkStandardNewMacro(vtkMaptkFeatureTrackRepresentation);
 
 typedef vtkMaptkFeatureTrackRepresentation::TrailStyleEnum TrailStyleEnum;
 
+//-----------------------------------------------------------------------------
+class vtkMaptkFeatureTrackRepresentation::TrackData
+{
+public:
+  TrackData()
+    : Points(vtkSmartPointer<vtkPoints>::New()), IndexDirty(false) {}
+
+  void UpdateIndex();
+  void UpdateFrameIndex();
+  void UpdateTrackPoints();
+
+  vtkSmartPointer<vtkPoints> Points;
+
+  struct TrackPoint
+  {
+    unsigned Track;
+    unsigned Frame;
+    vtkIdType Point;
+  };
+
+  struct TrackInfo
+  {
+    unsigned Id;
+    unsigned FirstFrame;
+    unsigned LastFrame;
+    size_t Begin; // Index of the first state in StateFrames / StatePoints
+    size_t End;
+  };
+
+  // Track points added one at a time, in the order they were added; the
+  // index below is rebuilt from these when points have been added
+  std::vector<TrackPoint> TrackPoints;
+  bool IndexDirty;
+
+  // Track states, sorted by track and then by frame; each track's states are
+  // a contiguous range
+  std::vector<unsigned> StateFrames;
+  std::vector<vtkIdType> StatePoints;
+  std::vector<unsigned> StateTracks; // Track index of each state
+  std::vector<TrackInfo> Tracks;
+
+  // States of each frame, in compressed row form: the states of frame f are
+  // FrameStates[FrameOffsets[f]] to FrameStates[FrameOffsets[f + 1] - 1]
+  std::vector<size_t> FrameOffsets;
+  std::vector<size_t> FrameStates;
+};
+
 //-----------------------------------------------------------------------------
 class vtkMaptkFeatureTrackRepresentation::vtkInternal
 {
 public:
+  vtkInternal() : Data(std::make_shared<TrackData>()), Query(0) {}
+
   void UpdateActivePoints(unsigned activeFrame);
   void UpdateTrails(unsigned activeFrame, unsigned trailLength,
                     TrailStyleEnum style);
 
-  vtkNew<vtkPoints> Points;
-
   vtkNew<vtkCellArray> PointsCells;
   vtkNew<vtkCellArray> TrailsCells;
 
   vtkNew<vtkPolyData> PointsPolyData;
   vtkNew<vtkPolyData> TrailsPolyData;
 
-  typedef std::map<unsigned, vtkIdType> TrackType;
-  typedef std::map<unsigned, TrackType> TrackMapType;
+  std::shared_ptr<TrackData> Data;
 
-  TrackMapType Tracks;
+  // Per-track marks used to visit each track once per query
+  std::vector<unsigned> TrackVisited;
+  unsigned Query;
 };
 
+//-----------------------------------------------------------------------------
+void vtkMaptkFeatureTrackRepresentation::TrackData::UpdateIndex()
+{
+  if (!this->IndexDirty)
+  {
+    return;
+  }
+  this->IndexDirty = false;
+
+  // Sort points by track, then frame; a later point for the same track and
+  // frame replaces an earlier one (stable sort keeps insertion order)
+  auto& points = this->TrackPoints;
+  std::stable_sort(points.begin(), points.end(),
+                   [](TrackPoint const& a, TrackPoint const& b){
+                     return (a.Track < b.Track ||
+                             (a.Track == b.Track && a.Frame < b.Frame));
+                   });
+
+  this->StateFrames.clear();
+  this->StatePoints.clear();
+  this->StateTracks.clear();
+  this->Tracks.clear();
+
+  for (size_t i = 0; i < points.size(); ++i)
+  {
+    auto const& p = points[i];
+    if (i + 1 < points.size() && points[i + 1].Track == p.Track &&
+        points[i + 1].Frame == p.Frame)
+    {
+      continue;
+    }
+
+    if (this->Tracks.empty() || p.Track != this->Tracks.back().Id)
+    {
+      auto const begin = this->StateFrames.size();
+      this->Tracks.push_back(
+        TrackInfo{p.Track, p.Frame, p.Frame, begin, begin});
+    }
+
+    auto& track = this->Tracks.back();
+    track.LastFrame = p.Frame;
+    ++track.End;
+
+    this->StateFrames.push_back(p.Frame);
+    this->StatePoints.push_back(p.Point);
+    this->StateTracks.push_back(
+      static_cast<unsigned>(this->Tracks.size() - 1));
+  }
+
+  this->UpdateFrameIndex();
+}
+
+//-----------------------------------------------------------------------------
+void vtkMaptkFeatureTrackRepresentation::TrackData::UpdateFrameIndex()
+{
+  // Bucket states by frame
+  auto frameCount = size_t{0};
+  VITAL_FOREACH (auto const f, this->StateFrames)
+  {
+    frameCount = std::max(frameCount, size_t{f} + 1);
+  }
+
+  this->FrameOffsets.assign(frameCount + 1, 0);
+  VITAL_FOREACH (auto const f, this->StateFrames)
+  {
+    ++this->FrameOffsets[f + 1];
+  }
+  for (size_t f = 0; f < frameCount; ++f)
+  {
+    this->FrameOffsets[f + 1] += this->FrameOffsets[f];
+  }
+
+  auto next = std::vector<size_t>(this->FrameOffsets.begin(),
+                                  this->FrameOffsets.end() - 1);
+  this->FrameStates.resize(this->StateFrames.size());
+  for (size_t i = 0; i < this->StateFrames.size(); ++i)
+  {
+    this->FrameStates[next[this->StateFrames[i]]++] = i;
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkMaptkFeatureTrackRepresentation::TrackData::UpdateTrackPoints()
+{
+  // Recover the list of added points from an index that was built in bulk,
+  // so that more points can be added to it
+  if (!this->TrackPoints.empty() || this->StateFrames.empty())
+  {
+    return;
+  }
+
+  this->TrackPoints.reserve(this->StateFrames.size());
+  VITAL_FOREACH (auto const& track, this->Tracks)
+  {
+    for (auto i = track.Begin; i < track.End; ++i)
+    {
+      this->TrackPoints.push_back(
+        TrackPoint{track.Id, this->StateFrames[i], this->StatePoints[i]});
+    }
+  }
+}
+
 //-----------------------------------------------------------------------------
 void vtkMaptkFeatureTrackRepresentation::vtkInternal::UpdateActivePoints(
   unsigned activeFrame)
 {
+  auto& data = *this->Data;
+  data.UpdateIndex();
+
   this->PointsCells->Reset();
 
-  VITAL_FOREACH(auto const& t, this->Tracks)
+  if (size_t{activeFrame} + 1 < data.FrameOffsets.size())
   {
-    auto const& track = t.second;
-    auto const fi = track.find(activeFrame);
-    if (fi != track.cend())
+    auto const begin = data.FrameOffsets[activeFrame];
+    auto const end = data.FrameOffsets[activeFrame + 1];
+    for (auto i = begin; i < end; ++i)
     {
       this->PointsCells->InsertNextCell(1);
-      this->PointsCells->InsertCellPoint(fi->second);
+      this->PointsCells->InsertCellPoint(data.StatePoints[data.FrameStates[i]]);
     }
   }
 
@@ -91,7 +247,16 @@ void vtkMaptkFeatureTrackRepresentation::vtkInternal::UpdateActivePoints(
 void vtkMaptkFeatureTrackRepresentation::vtkInternal::UpdateTrails(
   unsigned activeFrame, unsigned trailLength, TrailStyleEnum style)
 {
+  auto& data = *this->Data;
+  data.UpdateIndex();
+
   this->TrailsCells->Reset();
+  this->TrailsPolyData->Modified();
+
+  if (data.FrameOffsets.size() < 2)
+  {
+    return;
+  }
 
   auto const symmetric =
     (style == vtkMaptkFeatureTrackRepresentation::Symmetric);
@@ -100,36 +265,58 @@ void vtkMaptkFeatureTrackRepresentation::vtkInternal::UpdateTrails(
     (trailLength > activeFrame ? 0 : activeFrame - trailLength);
   auto const maxFrame = (symmetric ? activeFrame + trailLength : activeFrame);
 
-  std::vector<vtkIdType> points;
-
-  VITAL_FOREACH (auto const& ti, this->Tracks)
+  // A trail needs at least two points within the trail window, so only
+  // tracks with a state in the window need to be considered; visit each of
+  // those once
+  if (this->TrackVisited.size() != data.Tracks.size())
   {
-    auto const& track = ti.second;
-    if (track.cbegin()->first > activeFrame ||
-        (--track.cend())->first < activeFrame)
-    {
-      // Skip tracks that are not active on the active frame
-      continue;
-    }
-
-    // Build list of relevant points
-    points.clear();
-
-    auto const fe = track.upper_bound(maxFrame);
-    for (auto fi = track.lower_bound(minFrame); fi != fe; ++fi)
-    {
-      points.push_back(fi->second);
-    }
+    this->TrackVisited.assign(data.Tracks.size(), 0);
+    this->Query = 0;
+  }
+  if (++this->Query == 0)
+  {
+    std::fill(this->TrackVisited.begin(), this->TrackVisited.end(), 0);
+    this->Query = 1;
+  }
 
-    // Create cell for trail (only if trail is non-empty)
-    auto const n = static_cast<vtkIdType>(points.size());
-    if (n > 1)
+  auto const lastFrame =
+    std::min<size_t>(maxFrame, data.FrameOffsets.size() - 2);
+  for (size_t f = minFrame; f <= lastFrame; ++f)
+  {
+    auto const begin = data.FrameOffsets[f];
+    auto const end = data.FrameOffsets[f + 1];
+    for (auto i = begin; i < end; ++i)
     {
-      this->TrailsCells->InsertNextCell(points.size(), points.data());
+      auto const t = data.StateTracks[data.FrameStates[i]];
+      if (this->TrackVisited[t] == this->Query)
+      {
+        continue;
+      }
+      this->TrackVisited[t] = this->Query;
+
+      auto const& track = data.Tracks[t];
+      if (track.FirstFrame > activeFrame || track.LastFrame < activeFrame)
+      {
+        // Skip tracks that are not active on the active frame
+        continue;
+      }
+
+      // Find the (contiguous) states of the track within the trail window
+      auto const frames = data.StateFrames.cbegin();
+      auto const first =
+        std::lower_bound(frames + track.Begin, frames + track.End, minFrame);
+      auto const last =
+        std::upper_bound(first, frames + track.End, maxFrame);
+
+      // Create cell for trail (only if trail is non-empty)
+      auto const n = static_cast<vtkIdType>(last - first);
+      if (n > 1)
+      {
+        this->TrailsCells->InsertNextCell(
+          n, data.StatePoints.data() + (first - frames));
+      }
     }
   }
-
-  this->TrailsPolyData->Modified();
 }
 
 //-----------------------------------------------------------------------------
@@ -143,8 +330,7 @@ vtkMaptkFeatureTrackRepresentation::vtkMaptkFeatureTrackRepresentation()
   // Set up actors and data
   vtkNew<vtkPolyDataMapper> pointsMapper;
 
-  this->Internal->PointsPolyData->SetPoints(
-    this->Internal->Points.GetPointer());
+  this->Internal->PointsPolyData->SetPoints(this->Internal->Data->Points);
   this->Internal->PointsPolyData->SetVerts(
     this->Internal->PointsCells.GetPointer());
 
@@ -152,8 +338,7 @@ vtkMaptkFeatureTrackRepresentation::vtkMaptkFeatureTrackRepresentation()
 
   vtkNew<vtkPolyDataMapper> trailsMapper;
 
-  this->Internal->TrailsPolyData->SetPoints(
-    this->Internal->Points.GetPointer());
+  this->Internal->TrailsPolyData->SetPoints(this->Internal->Data->Points);
   this->Internal->TrailsPolyData->SetLines(
     this->Internal->TrailsCells.GetPointer());
 
@@ -175,8 +360,87 @@ vtkMaptkFeatureTrackRepresentation::~vtkMaptkFeatureTrackRepresentation()
 void vtkMaptkFeatureTrackRepresentation::AddTrackPoint(
   unsigned trackId, unsigned frameId, double x, double y)
 {
-  auto const id = this->Internal->Points->InsertNextPoint(x, y, 0.0);
-  this->Internal->Tracks[trackId][frameId] = id;
+  auto& data = *this->Internal->Data;
+  data.UpdateTrackPoints();
+
+  auto const id = data.Points->InsertNextPoint(x, y, 0.0);
+  data.TrackPoints.push_back({trackId, frameId, id});
+  data.IndexDirty = true;
+}
+
+//-----------------------------------------------------------------------------
+std::shared_ptr<vtkMaptkFeatureTrackRepresentation::TrackData>
+vtkMaptkFeatureTrackRepresentation::BuildTrackData(
+  kwiver::vital::track_set_sptr const& trackSet)
+{
+  auto const data = std::make_shared<TrackData>();
+  if (!trackSet)
+  {
+    return data;
+  }
+
+  auto const& tracks = trackSet->tracks();
+
+  // Preallocate everything, then fill it in a single pass; states of a
+  // vital track are already ordered by frame
+  auto count = size_t{0};
+  VITAL_FOREACH (auto const& track, tracks)
+  {
+    count += track->size();
+  }
+
+  data->Points->SetNumberOfPoints(static_cast<vtkIdType>(count));
+  data->StateFrames.reserve(count);
+  data->StatePoints.reserve(count);
+  data->StateTracks.reserve(count);
+  data->Tracks.reserve(tracks.size());
+
+  auto id = vtkIdType{0};
+  VITAL_FOREACH (auto const& track, tracks)
+  {
+    auto const begin = data->StateFrames.size();
+    auto const trackIndex = static_cast<unsigned>(data->Tracks.size());
+
+    VITAL_FOREACH (auto const& state, *track)
+    {
+      if (!state.feat)
+      {
+        continue;
+      }
+
+      auto const& loc = state.feat->loc();
+      data->Points->SetPoint(id, loc[0], loc[1], 0.0);
+
+      data->StateFrames.push_back(static_cast<unsigned>(state.frame_id));
+      data->StatePoints.push_back(id);
+      data->StateTracks.push_back(trackIndex);
+      ++id;
+    }
+
+    auto const end = data->StateFrames.size();
+    if (end > begin)
+    {
+      data->Tracks.push_back(TrackData::TrackInfo{
+        static_cast<unsigned>(track->id()),
+        data->StateFrames[begin], data->StateFrames[end - 1], begin, end});
+    }
+  }
+
+  data->Points->SetNumberOfPoints(id);
+  data->UpdateFrameIndex();
+
+  return data;
+}
+
+//-----------------------------------------------------------------------------
+void vtkMaptkFeatureTrackRepresentation::SetTrackData(
+  std::shared_ptr<TrackData> const& data)
+{
+  this->Internal->Data = (data ? data : std::make_shared<TrackData>());
+  this->Internal->PointsPolyData->SetPoints(this->Internal->Data->Points);
+  this->Internal->TrailsPolyData->SetPoints(this->Internal->Data->Points);
+
+  this->Update();
 }
 
 //-----------------------------------------------------------------------------
@@ -232,7 +496,7 @@ void vtkMaptkFeatureTrackRepresentation::PrintSelf(
   this->Superclass::PrintSelf(os, indent);
 
   os << indent << "Number Of Points: "
-     << this->Internal->Points->GetNumberOfPoints() << endl;
+     << this->Internal->Data->Points->GetNumberOfPoints() << endl;
   os << indent << "ActiveFrame: "
      << this->ActiveFrame << endl;
   os << indent << "TrailLength: "
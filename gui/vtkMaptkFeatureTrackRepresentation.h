@@ -31,6 +31,8 @@
 #ifndef MAPTK_VTKMAPTKFEATURETRACKREPRESENTATION_H_
 #define MAPTK_VTKMAPTKFEATURETRACKREPRESENTATION_H_
 
+#include <vital/types/track_set.h>
+
 #include <vtkCamera.h>
 #include <vtkCollection.h>
 #include <vtkSmartPointer.h>
@@ -55,6 +57,22 @@ public:
 
   void AddTrackPoint(unsigned trackId, unsigned frameId, double x, double y);
 
+  // Description:
+  // Feature track points with their per-frame index
+  class TrackData;
+
+  // Description:
+  // Build the track data for a whole track set in one pass. This does not
+  // modify any representation, and may be called from any thread.
+  static std::shared_ptr<TrackData> BuildTrackData(
+    kwiver::vital::track_set_sptr const&);
+
+  // Description:
+  // Replace all track points with data from BuildTrackData. The
+  // representation takes ownership of the data, which must not be used
+  // otherwise afterwards.
+  void SetTrackData(std::shared_ptr<TrackData> const&);
+
   // Description:
   // Get/Set the active frame
   void SetActiveFrame(unsigned);
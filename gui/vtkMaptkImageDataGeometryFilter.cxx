@@ -33,19 +33,104 @@
 #include <vtkCellData.h>
 #include <vtkExecutive.h>
 #include <vtkFloatArray.h>
+#include <vtkIdTypeArray.h>
 #include <vtkImageData.h>
 #include <vtkInformation.h>
 #include <vtkInformationVector.h>
+#include <vtkNew.h>
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
 #include <vtkPolyData.h>
+#include <vtkSmartPointer.h>
 
 #include <vital/vital_foreach.h>
 
+#include <algorithm>
 #include <map>
+#include <vector>
 
 vtkStandardNewMacro(vtkMaptkImageDataGeometryFilter);
 
+namespace // anonymous
+{
+
+// Number of value buckets used to find points affected by a range change
+static const int bucketCount = 4096;
+
+//-----------------------------------------------------------------------------
+template <typename T>
+void ComputeFailures(T const* data, int stride, vtkIdType count,
+                     double minValue, double maxValue, unsigned int bit,
+                     unsigned int* mask, bool& validityChanged)
+{
+  for (vtkIdType i = 0; i < count; ++i, data += stride)
+  {
+    auto const value = static_cast<double>(*data);
+    auto const old = mask[i];
+    mask[i] = (value < minValue || value > maxValue ? old | bit : old & ~bit);
+    validityChanged = validityChanged || ((old == 0) != (mask[i] == 0));
+  }
+}
+
+//-----------------------------------------------------------------------------
+template <typename T>
+void ComputeValueRange(T const* data, int stride, vtkIdType count,
+                       double& lower, double& upper)
+{
+  for (vtkIdType i = 0; i < count; ++i, data += stride)
+  {
+    auto const value = static_cast<double>(*data);
+    if (value == value) // skip NaN
+    {
+      lower = std::min(lower, value);
+      upper = std::max(upper, value);
+    }
+  }
+}
+
+//-----------------------------------------------------------------------------
+template <typename T>
+void ComputeBuckets(T const* data, int stride, vtkIdType count,
+                    double lower, double upper, double scale,
+                    std::vector<vtkIdType>& offsets,
+                    std::vector<unsigned int>& ids)
+{
+  auto const bucket = [&](double value) {
+    return (value <= lower ? 0 : value >= upper ? bucketCount - 1 :
+            std::min(static_cast<int>((value - lower) * scale),
+                     bucketCount - 1));
+  };
+
+  offsets.assign(bucketCount + 1, 0);
+  auto p = data;
+  for (vtkIdType i = 0; i < count; ++i, p += stride)
+  {
+    auto const value = static_cast<double>(*p);
+    if (value == value) // skip NaN, which never fail a constraint
+    {
+      ++offsets[bucket(value) + 1];
+    }
+  }
+  for (int i = 0; i < bucketCount; ++i)
+  {
+    offsets[i + 1] += offsets[i];
+  }
+
+  ids.resize(static_cast<size_t>(offsets.back()));
+  auto next = std::vector<vtkIdType>(offsets.begin(), offsets.end() - 1);
+  p = data;
+  for (vtkIdType i = 0; i < count; ++i, p += stride)
+  {
+    auto const value = static_cast<double>(*p);
+    if (value == value)
+    {
+      ids[next[bucket(value)]++] = static_cast<unsigned int>(i);
+    }
+  }
+}
+
+} // namespace <anonymous>
+
 //-----------------------------------------------------------------------------
 class vtkMaptkImageDataGeometryFilter::vtkInternal
 {
@@ -70,9 +155,321 @@ public:
 
   typedef std::map<std::string, ConstraintRange> ConstraintType;
 
+  // State of a constraint as currently reflected in the failure masks
+  struct AppliedConstraint
+  {
+    AppliedConstraint()
+    {
+      this->Array = 0;
+      this->ArrayMTime = 0;
+      this->Bit = 0;
+      this->MinValue = 1;
+      this->MaxValue = -1;
+      this->BucketLower = 0;
+      this->BucketUpper = 0;
+      this->BucketScale = 0;
+    }
+
+    vtkDataArray* Array;
+    unsigned long ArrayMTime;
+    unsigned int Bit;
+    double MinValue;
+    double MaxValue;
+
+    // Point ids bucketed by value (excluding NaN); built on demand
+    std::vector<vtkIdType> BucketOffsets;
+    std::vector<unsigned int> BucketIds;
+    double BucketLower;
+    double BucketUpper;
+    double BucketScale;
+  };
+
+  typedef std::map<std::string, AppliedConstraint> AppliedConstraintType;
+
+  vtkInternal() : UsedBits(0), CellsValid(false),
+                  LastThresholdCells(-1), LastGenerateTriangleOutput(-1) {}
+
+  void UpdateGeometry(int const extents[6], double const origin[3],
+                      double const spacing[3]);
+
+  bool UpdateConstraints(vtkPointData* pointData);
+  void ApplyConstraint(AppliedConstraint& constraint,
+                       double minValue, double maxValue);
+  void UpdateConstraint(AppliedConstraint& constraint,
+                        double minValue, double maxValue);
+  void UpdateConstraintValues(AppliedConstraint& constraint,
+                              double lower, double upper);
+  void ClearConstraint(AppliedConstraint const& constraint);
+
+  bool IsValid(vtkIdType id) const { return !this->FailMask[id]; }
+
   ConstraintType Constraints;
+
+  // Per-point bitmask of constraints which the point fails; a point is valid
+  // if it fails no constraints
+  AppliedConstraintType AppliedConstraints;
+  std::vector<unsigned int> FailMask;
+  unsigned int UsedBits;
+  bool ValidityChanged;
+
+  // Cached outputs, reused when the input geometry and validity of each point
+  // are unchanged
+  int Extents[6];
+  double Origin[3];
+  double Spacing[3];
+  vtkSmartPointer<vtkPoints> Points;
+  vtkSmartPointer<vtkCellArray> Verts;
+  vtkSmartPointer<vtkCellArray> Polys;
+  bool CellsValid;
+  int LastThresholdCells;
+  int LastGenerateTriangleOutput;
 };
 
+//-----------------------------------------------------------------------------
+void vtkMaptkImageDataGeometryFilter::vtkInternal::UpdateGeometry(
+  int const extents[6], double const origin[3], double const spacing[3])
+{
+  if (this->Points &&
+      std::equal(extents, extents + 6, this->Extents) &&
+      std::equal(origin, origin + 3, this->Origin) &&
+      std::equal(spacing, spacing + 3, this->Spacing))
+  {
+    return;
+  }
+
+  std::copy(extents, extents + 6, this->Extents);
+  std::copy(origin, origin + 3, this->Origin);
+  std::copy(spacing, spacing + 3, this->Spacing);
+
+  auto const numberOfPoints =
+    static_cast<vtkIdType>(extents[1] - extents[0] + 1) *
+    static_cast<vtkIdType>(extents[3] - extents[2] + 1);
+
+  this->Points = vtkSmartPointer<vtkPoints>::New();
+  this->Points->SetNumberOfPoints(numberOfPoints);
+
+  float* pointsPtr =
+    vtkFloatArray::SafeDownCast(this->Points->GetData())->GetPointer(0);
+  for (int row = extents[2]; row <= extents[3]; ++row)
+  {
+    float y = origin[1] + row * spacing[1];
+    for (int column = extents[0]; column <= extents[1]; ++column)
+    {
+      *pointsPtr = origin[0] + column * spacing[0];
+      *(++pointsPtr) = y;
+      *(++pointsPtr) = origin[2];
+      ++pointsPtr;
+    }
+  }
+
+  // Any previously applied constraints no longer match the points
+  this->FailMask.assign(static_cast<size_t>(numberOfPoints), 0u);
+  this->AppliedConstraints.clear();
+  this->UsedBits = 0;
+  this->CellsValid = false;
+}
+
+//-----------------------------------------------------------------------------
+bool vtkMaptkImageDataGeometryFilter::vtkInternal::UpdateConstraints(
+  vtkPointData* pointData)
+{
+  this->ValidityChanged = false;
+
+  // Remove constraints which no longer exist or no longer have data
+  auto iter = this->AppliedConstraints.begin();
+  while (iter != this->AppliedConstraints.end())
+  {
+    if (!this->Constraints.count(iter->first) ||
+        !pointData->GetArray(iter->first.c_str()))
+    {
+      this->ClearConstraint(iter->second);
+      iter = this->AppliedConstraints.erase(iter);
+    }
+    else
+    {
+      ++iter;
+    }
+  }
+
+  // Apply new or changed constraints
+  VITAL_FOREACH (auto const& constraint, this->Constraints)
+  {
+    auto const dataArray = pointData->GetArray(constraint.first.c_str());
+    if (!dataArray)
+    {
+      continue;
+    }
+
+    auto const& range = constraint.second;
+    auto applied = this->AppliedConstraints.find(constraint.first);
+    if (applied == this->AppliedConstraints.end())
+    {
+      if (this->UsedBits == ~0u)
+      {
+        vtkGenericWarningMacro(<< "Too many constraints; ignoring constraint"
+                               << " on " << constraint.first);
+        continue;
+      }
+
+      // Allocate an unused bit for the new constraint
+      auto bit = 1u;
+      while (this->UsedBits & bit)
+      {
+        bit <<= 1;
+      }
+      this->UsedBits |= bit;
+
+      AppliedConstraint newConstraint;
+      newConstraint.Bit = bit;
+      applied = this->AppliedConstraints.insert(
+        std::make_pair(constraint.first, newConstraint)).first;
+    }
+
+    auto& state = applied->second;
+    if (state.Array != dataArray || state.ArrayMTime != dataArray->GetMTime())
+    {
+      // Data has changed; recompute the constraint for every point
+      state.Array = dataArray;
+      state.ArrayMTime = dataArray->GetMTime();
+      state.BucketOffsets.clear();
+      state.BucketIds.clear();
+      this->ApplyConstraint(state, range.MinValue, range.MaxValue);
+    }
+    else if (state.MinValue != range.MinValue ||
+             state.MaxValue != range.MaxValue)
+    {
+      // Only the range has changed; update only the points whose values lie
+      // between the old and new range limits
+      this->UpdateConstraint(state, range.MinValue, range.MaxValue);
+    }
+  }
+
+  return this->ValidityChanged;
+}
+
+//-----------------------------------------------------------------------------
+void vtkMaptkImageDataGeometryFilter::vtkInternal::ApplyConstraint(
+  AppliedConstraint& constraint, double minValue, double maxValue)
+{
+  auto const array = constraint.Array;
+  auto const count = std::min(array->GetNumberOfTuples(),
+                              static_cast<vtkIdType>(this->FailMask.size()));
+  auto const stride = array->GetNumberOfComponents();
+
+  switch (array->GetDataType())
+  {
+    vtkTemplateMacro(
+      ComputeFailures(static_cast<VTK_TT const*>(array->GetVoidPointer(0)),
+                      stride, count, minValue, maxValue, constraint.Bit,
+                      this->FailMask.data(), this->ValidityChanged));
+  }
+
+  constraint.MinValue = minValue;
+  constraint.MaxValue = maxValue;
+}
+
+//-----------------------------------------------------------------------------
+void vtkMaptkImageDataGeometryFilter::vtkInternal::UpdateConstraint(
+  AppliedConstraint& constraint, double minValue, double maxValue)
+{
+  auto const array = constraint.Array;
+  auto const count = std::min(array->GetNumberOfTuples(),
+                              static_cast<vtkIdType>(this->FailMask.size()));
+  auto const stride = array->GetNumberOfComponents();
+
+  // Sort points into buckets by value, if not already done
+  if (constraint.BucketOffsets.empty())
+  {
+    auto lower = VTK_DOUBLE_MAX, upper = VTK_DOUBLE_MIN;
+    switch (array->GetDataType())
+    {
+      vtkTemplateMacro(
+        ComputeValueRange(static_cast<VTK_TT const*>(array->GetVoidPointer(0)),
+                          stride, count, lower, upper));
+    }
+
+    constraint.BucketLower = lower;
+    constraint.BucketUpper = upper;
+    constraint.BucketScale =
+      (upper > lower ? bucketCount / (upper - lower) : 0.0);
+
+    switch (array->GetDataType())
+    {
+      vtkTemplateMacro(
+        ComputeBuckets(static_cast<VTK_TT const*>(array->GetVoidPointer(0)),
+                       stride, count, lower, upper, constraint.BucketScale,
+                       constraint.BucketOffsets, constraint.BucketIds));
+    }
+  }
+
+  auto const oldMin = constraint.MinValue, oldMax = constraint.MaxValue;
+  constraint.MinValue = minValue;
+  constraint.MaxValue = maxValue;
+
+  // Points whose state may change are those with values between the old and
+  // new lower limits, or between the old and new upper limits
+  if (oldMin != minValue)
+  {
+    this->UpdateConstraintValues(constraint, std::min(oldMin, minValue),
+                                 std::max(oldMin, minValue));
+  }
+  if (oldMax != maxValue)
+  {
+    this->UpdateConstraintValues(constraint, std::min(oldMax, maxValue),
+                                 std::max(oldMax, maxValue));
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkMaptkImageDataGeometryFilter::vtkInternal::UpdateConstraintValues(
+  AppliedConstraint& constraint, double lower, double upper)
+{
+  if (upper < constraint.BucketLower || lower > constraint.BucketUpper)
+  {
+    // No values in the affected range
+    return;
+  }
+
+  auto const bucket = [&constraint](double value) {
+    return (value <= constraint.BucketLower ? 0 :
+            value >= constraint.BucketUpper ? bucketCount - 1 :
+            std::min(static_cast<int>((value - constraint.BucketLower) *
+                                      constraint.BucketScale),
+                     bucketCount - 1));
+  };
+
+  auto const first = constraint.BucketOffsets[bucket(lower)];
+  auto const last = constraint.BucketOffsets[bucket(upper) + 1];
+  auto const bit = constraint.Bit;
+  for (auto i = first; i < last; ++i)
+  {
+    auto const id = constraint.BucketIds[i];
+    auto const value = constraint.Array->GetComponent(id, 0);
+    auto& mask = this->FailMask[id];
+    auto const old = mask;
+    mask = (value < constraint.MinValue || value > constraint.MaxValue
+            ? old | bit : old & ~bit);
+    this->ValidityChanged =
+      this->ValidityChanged || ((old == 0) != (mask == 0));
+  }
+}
+
+//-----------------------------------------------------------------------------
+void vtkMaptkImageDataGeometryFilter::vtkInternal::ClearConstraint(
+  AppliedConstraint const& constraint)
+{
+  auto const bit = constraint.Bit;
+  VITAL_FOREACH (auto& mask, this->FailMask)
+  {
+    if (mask == bit)
+    {
+      this->ValidityChanged = true;
+    }
+    mask &= ~bit;
+  }
+  this->UsedBits &= ~bit;
+}
+
 // Construct with initial extent of all the data
 vtkMaptkImageDataGeometryFilter::vtkMaptkImageDataGeometryFilter()
   : Internal(new vtkInternal)
@@ -90,6 +487,7 @@ vtkMaptkImageDataGeometryFilter::vtkMaptkImageDataGeometryFilter()
 vtkMaptkImageDataGeometryFilter::~vtkMaptkImageDataGeometryFilter()
 {
   this->SetUnprojectedPointArrayName(0);
+  delete this->Internal;
 }
 
 //-----------------------------------------------------------------------------
@@ -140,7 +538,6 @@ int vtkMaptkImageDataGeometryFilter::RequestData(
   vtkPolyData* outputUnprojected = vtkPolyData::GetData(outputVector, 1);
   vtkPolyData* outputUnprojectedPolys = vtkPolyData::GetData(outputVector, 2);
 
-  vtkPoints *newPts=0;
   vtkDebugMacro(<< "Extracting structured points geometry");
 
   // Output points are the full set of image points (and retain all PointData);
@@ -160,10 +557,13 @@ int vtkMaptkImageDataGeometryFilter::RequestData(
     return 1;
   }
 
-  newPts = vtkPoints::New();
+  // Generate the points, unless the geometry is unchanged from the previous
+  // execution
+  auto const internal = this->Internal;
+  internal->UpdateGeometry(extents, origin, spacing);
+
+  vtkPoints* newPts = internal->Points;
   output->SetPoints(newPts);
-  newPts->FastDelete();
-  newPts->SetNumberOfPoints(numberOfPoints);
 
   // Expect 3D point data for the 2nd output; if not present, use same points
   // as 1st input
@@ -184,121 +584,93 @@ int vtkMaptkImageDataGeometryFilter::RequestData(
     points3D->FastDelete();
   }
 
-  float* pointsPtr =
-    vtkFloatArray::SafeDownCast(newPts->GetData())->GetPointer(0);
-  for (int row = extents[2]; row <= extents[3]; ++row)
-  {
-    float y = origin[1] + row * spacing[1];
-    for (int column = extents[0]; column <= extents[1]; ++column)
-    {
-      *pointsPtr = origin[0] + column * spacing[0];
-      *(++pointsPtr) = y;
-      *(++pointsPtr) = origin[2];
-      ++pointsPtr;
-    }
-  }
-
   // Copy the pointData from input to output
   vtkPointData* pointData = input->GetPointData();
   output->GetPointData()->ShallowCopy(pointData);
   outputUnprojected->GetPointData()->ShallowCopy(pointData);
   outputUnprojectedPolys->GetPointData()->ShallowCopy(pointData);
 
-  struct ConstraintType
+  // Update the per-point constraint failure masks; only points whose data
+  // changed, or whose values lie between the old and new limits of a changed
+  // constraint range, are tested
+  if (this->ThresholdCells && internal->UpdateConstraints(pointData))
   {
-    vtkDataArray* Array;
-    double MinValue;
-    double MaxValue;
-  };
-
-  std::vector<ConstraintType> constraints;
+    internal->CellsValid = false;
+  }
 
-  // Check any / all constraints
-  bool completelyFiltered = false;
-  VITAL_FOREACH(auto const constraint, this->Internal->Constraints)
+  if (internal->LastThresholdCells != this->ThresholdCells ||
+      internal->LastGenerateTriangleOutput != this->GenerateTriangleOutput)
   {
-    vtkDataArray* dataArray = pointData->GetArray(constraint.first.c_str());
-    if (dataArray)
-    {
-      double* range = dataArray->GetRange();
-      if (constraint.second.MinValue <= range[0] &&
-        constraint.second.MaxValue >= range[1])
-      {
-        // Doesn't result in any filtering, so skip this filter
-        continue;
-      }
-      else if (constraint.second.MinValue > range[1] ||
-        constraint.second.MaxValue < range[0])
-      {
-        completelyFiltered = true;
-        break;
-      }
-
-      // add this filter to our filter list
-      ConstraintType newConstraint;
-      newConstraint.Array = dataArray;
-      newConstraint.MinValue = constraint.second.MinValue;
-      newConstraint.MaxValue = constraint.second.MaxValue;
-      constraints.emplace_back(newConstraint);
-    }
+    internal->LastThresholdCells = this->ThresholdCells;
+    internal->LastGenerateTriangleOutput = this->GenerateTriangleOutput;
+    internal->CellsValid = false;
   }
 
-  if (completelyFiltered)
+  // If the validity of every point is unchanged, reuse the previous cells
+  if (internal->CellsValid)
   {
+    output->SetVerts(internal->Verts);
+    outputUnprojected->SetVerts(internal->Verts);
+    if (this->GenerateTriangleOutput)
+    {
+      outputUnprojectedPolys->SetPolys(internal->Polys);
+    }
+    else
+    {
+      outputUnprojectedPolys->SetVerts(internal->Verts);
+    }
     return 1;
   }
 
   // Add vertices for each point that passes filtering, or all if not
   // threshold cells
-  vtkCellArray* newVerts = vtkCellArray::New();
-  newVerts->Allocate(numberOfPoints);
-  output->SetVerts(newVerts);
-  outputUnprojected->SetVerts(newVerts);
-  newVerts->FastDelete();
+  auto const threshold = (this->ThresholdCells != 0);
+  vtkIdType numberOfValidPoints = numberOfPoints;
+  if (threshold)
+  {
+    numberOfValidPoints = static_cast<vtkIdType>(
+      std::count(internal->FailMask.begin(), internal->FailMask.end(), 0u));
+  }
 
-  vtkIdType* validPoints = new vtkIdType[numberOfPoints];
-  vtkIdType* currentPt = validPoints;
-  // Check each constrainst
+  vtkNew<vtkIdTypeArray> vertIds;
+  vtkIdType* vertPtr = vertIds->WritePointer(0, 2 * numberOfValidPoints);
   for (vtkIdType i = 0; i < numberOfPoints; ++i)
   {
-    if (this->ThresholdCells && constraints.size())
+    if (!threshold || internal->IsValid(i))
     {
-      bool skipCell = false;
-      VITAL_FOREACH(auto const constraint, constraints)
-      {
-        double value = constraint.Array->GetTuple1(i);
-        if (value < constraint.MinValue || value > constraint.MaxValue)
-        {
-          skipCell = true;
-          break;
-        }
-      }
-
-      if (skipCell)
-      {
-        *currentPt++ = -1;
-        continue;
-      }
+      *vertPtr++ = 1;
+      *vertPtr++ = i;
     }
-
-    *currentPt++ = i;
-    newVerts->InsertNextCell(1, &i);
   }
 
+  vtkCellArray* newVerts = vtkCellArray::New();
+  newVerts->SetCells(numberOfValidPoints, vertIds.GetPointer());
+  output->SetVerts(newVerts);
+  outputUnprojected->SetVerts(newVerts);
+  internal->Verts = newVerts;
+  newVerts->FastDelete();
+
   if (this->GenerateTriangleOutput)
   {
     // Add triangles according to the validPoints; all 3 points making up a
     // triangle must be valid
+    std::vector<vtkIdType> validPoints(static_cast<size_t>(numberOfPoints));
+    for (vtkIdType i = 0; i < numberOfPoints; ++i)
+    {
+      validPoints[i] = (!threshold || internal->IsValid(i) ? i : -1);
+    }
+
     vtkCellArray* newPolys = vtkCellArray::New();
     int numberOfRowsMinus1 = extents[3] - extents[2];
     int numberOfColumnsMinus1 = extents[1] - extents[0];
     newPolys->Allocate(2 * 4 * numberOfRowsMinus1 * numberOfColumnsMinus1);
     outputUnprojectedPolys->SetPolys(newPolys);
+    internal->Polys = newPolys;
     newPolys->FastDelete();
 
     // Setup pointers to two first rows of validPoints
-    vtkIdType* thisRow = validPoints;
-    vtkIdType* nextRow = validPoints + (numberOfColumnsMinus1 + 1);
+    vtkIdType* thisRow = validPoints.data();
+    vtkIdType* nextRow = thisRow + (numberOfColumnsMinus1 + 1);
     vtkIdType triIds[3];
     for (int i = 0; i < numberOfRowsMinus1; ++i, ++thisRow, ++nextRow)
     {
@@ -352,6 +724,8 @@ int vtkMaptkImageDataGeometryFilter::RequestData(
   {
     outputUnprojectedPolys->SetVerts(newVerts);
   }
+
+  internal->CellsValid = true;
   return 1;
 }
 
@@ -36,13 +36,141 @@
 #include <vtkImageData.h>
 #include <vtkObjectFactory.h>
 #include <vtkPointData.h>
+#include <vtkSMPTools.h>
+
+#include <algorithm>
+#include <vector>
 
 vtkStandardNewMacro(vtkMaptkImageUnprojectDepth);
 
 vtkCxxSetObjectMacro(vtkMaptkImageUnprojectDepth, Camera, vtkMaptkCamera);
 
+namespace // anonymous
+{
+
+//-----------------------------------------------------------------------------
+struct ComputeRaysFunctor
+{
+  kwiver::vital::camera_intrinsics const* Intrinsics;
+  double* Rays;
+  int Extents[6];
+  double Origin[2];
+  double Spacing[2];
+  int Height;
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    auto const columns = this->Extents[1] - this->Extents[0] + 1;
+    for (auto row = begin; row < end; ++row)
+    {
+      auto const y = this->Height - 1 -
+        (this->Origin[1] + (row + this->Extents[2]) * this->Spacing[1]);
+      auto rayPtr = this->Rays + (2 * row * columns);
+      for (int column = this->Extents[0]; column <= this->Extents[1]; ++column)
+      {
+        auto const x = this->Origin[0] + column * this->Spacing[0];
+        auto const normPoint =
+          this->Intrinsics->unmap(kwiver::vital::vector_2d{x, y});
+        *(rayPtr++) = normPoint[0];
+        *(rayPtr++) = normPoint[1];
+      }
+    }
+  }
+};
+
+//-----------------------------------------------------------------------------
+struct UnprojectFunctor
+{
+  double const* Depths;
+  double const* Rays;
+  float* Points;
+  double Axes[3][3];
+  double Center[3];
+
+  void operator()(vtkIdType begin, vtkIdType end) const
+  {
+    auto const& a = this->Axes;
+    auto const& c = this->Center;
+    for (auto i = begin; i < end; ++i)
+    {
+      auto const x = this->Rays[2 * i];
+      auto const y = this->Rays[(2 * i) + 1];
+      auto const d = this->Depths[i];
+      auto const p = this->Points + (3 * i);
+      for (int k = 0; k < 3; ++k)
+      {
+        auto const ray = x * a[0][k] + y * a[1][k] + a[2][k];
+        p[k] = static_cast<float>(c[k] + d * ray);
+      }
+    }
+  }
+};
+
+} // namespace <anonymous>
+
+//-----------------------------------------------------------------------------
+class vtkMaptkImageUnprojectDepth::vtkInternal
+{
+public:
+  void UpdateRays(kwiver::vital::camera_intrinsics const& intrinsics,
+                  int const extents[6], double const origin[3],
+                  double const spacing[3], int height);
+
+  // Normalized image coordinates of each pixel, which depend only on the
+  // camera intrinsics and the image geometry
+  std::vector<double> Rays;
+
+  kwiver::vital::matrix_3x3d K;
+  std::vector<double> DistortionCoefficients;
+  int Extents[6];
+  double Origin[2];
+  double Spacing[2];
+  int Height = -1;
+};
+
+//-----------------------------------------------------------------------------
+void vtkMaptkImageUnprojectDepth::vtkInternal::UpdateRays(
+  kwiver::vital::camera_intrinsics const& intrinsics, int const extents[6],
+  double const origin[3], double const spacing[3], int height)
+{
+  auto const& K = intrinsics.as_matrix();
+  auto const& dc = intrinsics.dist_coeffs();
+
+  // Check if the cached rays are still valid
+  if (this->Height == height && this->K == K &&
+      this->DistortionCoefficients == dc &&
+      std::equal(extents, extents + 6, this->Extents) &&
+      std::equal(origin, origin + 2, this->Origin) &&
+      std::equal(spacing, spacing + 2, this->Spacing))
+  {
+    return;
+  }
+
+  this->K = K;
+  this->DistortionCoefficients = dc;
+  this->Height = height;
+  std::copy(extents, extents + 6, this->Extents);
+  std::copy(origin, origin + 2, this->Origin);
+  std::copy(spacing, spacing + 2, this->Spacing);
+
+  auto const columns = extents[1] - extents[0] + 1;
+  auto const rows = extents[3] - extents[2] + 1;
+  this->Rays.resize(2 * static_cast<size_t>(columns) * rows);
+
+  ComputeRaysFunctor functor;
+  functor.Intrinsics = &intrinsics;
+  functor.Rays = this->Rays.data();
+  functor.Height = height;
+  std::copy(extents, extents + 6, functor.Extents);
+  std::copy(origin, origin + 2, functor.Origin);
+  std::copy(spacing, spacing + 2, functor.Spacing);
+
+  vtkSMPTools::For(0, rows, functor);
+}
+
 //-----------------------------------------------------------------------------
 vtkMaptkImageUnprojectDepth::vtkMaptkImageUnprojectDepth()
+  : Internal(new vtkInternal)
 {
   this->Camera = 0;
 
@@ -124,22 +252,32 @@ void vtkMaptkImageUnprojectDepth::SimpleExecute(vtkImageData* input,
   output->GetPointData()->AddArray(points);
   points->FastDelete();
 
-  // loop over each point / depth in the image, computing the unprojected point
-  double* depthPtr = depths->GetPointer(0);
-  float* pointsPtr = points->GetPointer(0);
-  double pixel[2];
-  for (int row = extents[2]; row <= extents[3]; ++row)
+  // Compute (or reuse) the normalized image coordinates of each pixel; these
+  // only change when the intrinsics or image geometry change, so are usually
+  // shared across all frames
+  auto const& camera = scaledCamera->GetCamera();
+  this->Internal->UpdateRays(*camera->intrinsics(), extents, origin, spacing,
+                             height);
+
+  // Unproject each depth along its ray; the world space ray is the rotation of
+  // the normalized image coordinate, such that the unprojected point is
+  // center + depth * (x * R[0] + y * R[1] + R[2]), where R[i] are the rows of
+  // the rotation matrix
+  auto const R = camera->rotation().matrix();
+  auto const center = camera->center();
+
+  UnprojectFunctor functor;
+  functor.Depths = depths->GetPointer(0);
+  functor.Rays = this->Internal->Rays.data();
+  functor.Points = points->GetPointer(0);
+  for (int i = 0; i < 3; ++i)
   {
-    pixel[1] = height - 1 - (origin[1] + row * spacing[1]);
-    for (int column = extents[0]; column <= extents[1]; ++column, ++depthPtr)
+    functor.Center[i] = center[i];
+    for (int j = 0; j < 3; ++j)
     {
-      pixel[0] = origin[0] + column * spacing[0];
-
-      auto const p = scaledCamera->UnprojectPoint(pixel, *depthPtr);
-      *pointsPtr = p[0];
-      *(++pointsPtr) = p[1];
-      *(++pointsPtr) = p[2];
-      ++pointsPtr;
+      functor.Axes[i][j] = R(i, j);
     }
   }
+
+  vtkSMPTools::For(0, numberOfPoints, functor);
 }
@@ -33,6 +33,8 @@
 
 #include "vtkSimpleImageToImageFilter.h"
 
+#include <memory>
+
 class vtkMaptkCamera;
 
 class vtkMaptkImageUnprojectDepth : public vtkSimpleImageToImageFilter
@@ -69,6 +71,9 @@ private:
 
   char* DepthArrayName;
   char* UnprojectedPointArrayName;
+
+  class vtkInternal;
+  std::unique_ptr<vtkInternal> const Internal;
 };
 
 #endif
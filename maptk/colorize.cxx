@@ -46,10 +46,16 @@ vital::track_set_sptr
 extract_feature_colors(
   vital::track_set const& tracks,
   vital::image_container const& image,
-  vital::frame_id_t frame_id)
+  vital::frame_id_t frame_id,
+  std::vector<vital::track_id_t>* frame_track_ids)
 {
   const vital::image_of<uint8_t> image_data(image.get_image());
 
+  if (frame_track_ids)
+  {
+    frame_track_ids->clear();
+  }
+
   auto tracks_copy = tracks.tracks();
   VITAL_FOREACH (auto& track, tracks_copy)
   {
@@ -81,6 +87,11 @@ extract_feature_colors(
       }
 
       track = new_track;
+
+      if (frame_track_ids)
+      {
+        frame_track_ids->push_back(track->id());
+      }
     }
   }
 
@@ -42,6 +42,8 @@
 #include <vital/types/landmark_map.h>
 #include <vital/types/track_set.h>
 
+#include <vector>
+
 
 namespace kwiver {
 namespace maptk {
@@ -56,13 +58,16 @@ namespace maptk {
  *  \param [in] tracks a set of tracks in which to colorize feature points
  *  \param [in] image the image from which to take colors
  *  \param [in] frame_id the frame number of the image
+ *  \param [out] frame_track_ids if not null, receives the ids of the tracks
+ *                               with a feature on \p frame_id
  *  \return a track set with updated features
  */
 MAPTK_EXPORT
 vital::track_set_sptr extract_feature_colors(
   vital::track_set const& tracks,
   vital::image_container const& image,
-  vital::frame_id_t frame_id);
+  vital::frame_id_t frame_id,
+  std::vector<vital::track_id_t>* frame_track_ids = nullptr);
 
 /// Compute colors for landmarks
 /**
@@ -0,0 +1,472 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Implementation of maptk::read_cached_config_file
+ */
+
+#include "config_cache.h"
+
+#include <vital/config/config_block_io.h>
+#include <vital/vital_foreach.h>
+
+#include <kwiversys/SystemTools.hxx>
+
+#include <cctype>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <random>
+#include <sstream>
+
+
+namespace kwiver {
+namespace maptk {
+
+typedef kwiversys::SystemTools     ST;
+
+namespace {
+
+char const compiled_header[] = "# MAP-Tk compiled configuration v2";
+std::string const key_prefix = "# key ";
+std::string const source_prefix = "# source ";
+std::string const entry_prefix = "# entry ";
+
+/// Source files of a configuration and their stamps
+typedef std::map<vital::path_t, std::string> source_map_t;
+
+/// A resolved configuration and the sources it was read from
+struct cache_entry
+{
+  source_map_t sources;
+  vital::config_block_sptr config;
+};
+
+std::mutex memory_cache_mutex;
+std::map<std::string, cache_entry> memory_cache;
+
+/// Modification time and size of a file, or "-" if it does not exist
+std::string
+file_stamp(vital::path_t const& path)
+{
+  if (!ST::FileExists(path, true))
+  {
+    return "-";
+  }
+  std::ostringstream ss;
+  ss << ST::ModifiedTime(path) << ":" << ST::FileLength(path);
+  return ss.str();
+}
+
+/// Check that no source file has changed since its stamp was taken
+bool
+is_fresh(source_map_t const& sources)
+{
+  VITAL_FOREACH (auto const& s, sources)
+  {
+    if (file_stamp(s.first) != s.second)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Copy a config block so callers can not modify a cached one
+/**
+ * Values are copied with their descriptions and read-only flags.
+ */
+vital::config_block_sptr
+copy_config(vital::config_block_sptr const& config)
+{
+  auto copy = vital::config_block::empty_config();
+  VITAL_FOREACH (auto const& key, config->available_values())
+  {
+    copy->set_value(key, config->get_value<std::string>(key, ""),
+                    config->get_description(key));
+    if (config->is_read_only(key))
+    {
+      copy->mark_read_only(key);
+    }
+  }
+  return copy;
+}
+
+/// Remove leading and trailing white space
+std::string
+trim(std::string const& s)
+{
+  auto const begin = s.find_first_not_of(" \t\r\n");
+  if (begin == std::string::npos)
+  {
+    return std::string();
+  }
+  auto const end = s.find_last_not_of(" \t\r\n");
+  return s.substr(begin, end - begin + 1);
+}
+
+/// Add a file and, recursively, the files it includes to a source map
+/**
+ * Include paths are resolved relative to the including file, then in the
+ * configuration search paths.
+ *
+ * \return false if an include can not be resolved here, or if a file uses
+ *         macros, whose values (e.g. environment variables) may change
+ *         without any source file changing
+ */
+bool
+add_sources(vital::path_t const& file,
+            vital::config_path_list_t const& search_paths,
+            source_map_t& sources)
+{
+  vital::path_t const path = ST::CollapseFullPath(file);
+  if (sources.count(path))
+  {
+    return true;
+  }
+  sources[path] = file_stamp(path);
+
+  std::ifstream ifs(path.c_str());
+  if (!ifs)
+  {
+    return false;
+  }
+  vital::path_t const dir = ST::GetFilenamePath(path);
+  for (std::string line; std::getline(ifs, line); )
+  {
+    line = trim(line);
+    if (line.empty() || line[0] == '#')
+    {
+      continue;
+    }
+    if (line.find('$') != std::string::npos)
+    {
+      // the line may use a macro, which only the config parser can expand
+      return false;
+    }
+    if (line.size() < 8 || line.compare(0, 7, "include") != 0 ||
+        !std::isspace(static_cast<unsigned char>(line[7])))
+    {
+      continue;
+    }
+    std::string const include = trim(line.substr(7));
+
+    vital::path_t resolved;
+    if (ST::FileIsFullPath(include))
+    {
+      resolved = include;
+    }
+    else if (ST::FileExists(dir + "/" + include, true))
+    {
+      resolved = dir + "/" + include;
+    }
+    else
+    {
+      VITAL_FOREACH (auto const& sp, search_paths)
+      {
+        if (resolved.empty() && ST::FileExists(sp + "/" + include, true))
+        {
+          resolved = sp + "/" + include;
+        }
+      }
+    }
+    if (resolved.empty() || !add_sources(resolved, search_paths, sources))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Read a compiled configuration if it matches \p key and is fresh
+vital::config_block_sptr
+read_compiled(vital::path_t const& compiled_path, std::string const& key,
+              source_map_t& sources)
+{
+  std::ifstream ifs(compiled_path.c_str(), std::ios::in | std::ios::binary);
+  std::string line;
+  if (!ifs || !std::getline(ifs, line) || line != compiled_header ||
+      !std::getline(ifs, line) || line != key_prefix + key)
+  {
+    return vital::config_block_sptr();
+  }
+  bool more = false;
+  while ((more = static_cast<bool>(std::getline(ifs, line))) &&
+         line.compare(0, source_prefix.size(), source_prefix) == 0)
+  {
+    std::istringstream ss(line.substr(source_prefix.size()));
+    std::string stamp, path;
+    ss >> stamp;
+    std::getline(ss >> std::ws, path);
+    sources[path] = stamp;
+  }
+
+  if (sources.empty() || !is_fresh(sources))
+  {
+    return vital::config_block_sptr();
+  }
+
+  // Each entry is a line with the read-only flag and the sizes of the key,
+  // value and description, followed by their text and a newline
+  try
+  {
+    auto config = vital::config_block::empty_config();
+    for (; more; more = static_cast<bool>(std::getline(ifs, line)))
+    {
+      if (line.compare(0, entry_prefix.size(), entry_prefix) != 0)
+      {
+        return vital::config_block_sptr();
+      }
+      std::istringstream ss(line.substr(entry_prefix.size()));
+      int read_only;
+      size_t key_size, value_size, descr_size;
+      if (!(ss >> read_only >> key_size >> value_size >> descr_size))
+      {
+        return vital::config_block_sptr();
+      }
+      std::string entry_key(key_size, '\0');
+      std::string value(value_size, '\0');
+      std::string descr(descr_size, '\0');
+      if (!ifs.read(&entry_key[0], key_size) ||
+          !ifs.read(&value[0], value_size) ||
+          !ifs.read(&descr[0], descr_size) || ifs.get() != '\n')
+      {
+        return vital::config_block_sptr();
+      }
+      config->set_value(entry_key, value, descr);
+      if (read_only)
+      {
+        config->mark_read_only(entry_key);
+      }
+    }
+    return config;
+  }
+  catch (...)
+  {
+    // a corrupt entry size, for example, is treated as a stale file
+    return vital::config_block_sptr();
+  }
+}
+
+/// Write a compiled configuration, replacing any existing one
+void
+write_compiled(vital::path_t const& compiled_path, std::string const& key,
+               source_map_t const& sources,
+               vital::config_block_sptr const& config)
+{
+  if (!ST::MakeDirectory(ST::GetFilenamePath(compiled_path)))
+  {
+    return;
+  }
+  // write to a uniquely named file, then rename it into place so concurrent
+  // readers never see a partial file and concurrent writers do not collide
+  std::random_device rd;
+  std::ostringstream tmp_name;
+  tmp_name << compiled_path << "." << std::hex << rd() << ".tmp";
+  vital::path_t const tmp_path = tmp_name.str();
+  {
+    std::ofstream ofs(tmp_path.c_str(), std::ios::out | std::ios::binary);
+    if (!ofs)
+    {
+      return;
+    }
+    ofs << compiled_header << "\n" << key_prefix << key << "\n";
+    VITAL_FOREACH (auto const& s, sources)
+    {
+      ofs << source_prefix << s.second << " " << s.first << "\n";
+    }
+    // entries are stored with their sizes rather than in the configuration
+    // file syntax, so that read-only flags and descriptions are kept and
+    // nothing is parsed (or expanded) again
+    VITAL_FOREACH (auto const& k, config->available_values())
+    {
+      std::string const value = config->get_value<std::string>(k, "");
+      std::string const descr = config->get_description(k);
+      ofs << entry_prefix << (config->is_read_only(k) ? 1 : 0) << " "
+          << k.size() << " " << value.size() << " " << descr.size() << "\n"
+          << k << value << descr << "\n";
+    }
+    ofs.close();
+    if (!ofs)
+    {
+      std::remove(tmp_path.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), compiled_path.c_str()) != 0)
+  {
+    std::remove(tmp_path.c_str());
+  }
+}
+
+}
+
+
+/// Forget the configurations cached in memory
+void
+clear_config_memory_cache()
+{
+  std::lock_guard<std::mutex> lock(memory_cache_mutex);
+  memory_cache.clear();
+}
+
+
+/// Per-user directory for MAP-Tk cache files
+vital::path_t
+user_cache_directory()
+{
+  std::string path;
+#ifdef _WIN32
+  if (ST::GetEnv("LOCALAPPDATA", path) && !path.empty())
+  {
+    return path + "/maptk";
+  }
+#else
+  if (ST::GetEnv("XDG_CACHE_HOME", path) && !path.empty())
+  {
+    return path + "/maptk";
+  }
+  if (ST::GetEnv("HOME", path) && !path.empty())
+  {
+    return path + "/.cache/maptk";
+  }
+#endif
+  return vital::path_t();
+}
+
+
+/// Default directory for compiled configuration files
+vital::path_t
+config_cache_directory()
+{
+  std::string path;
+  if (ST::GetEnv("MAPTK_CONFIG_CACHE", path))
+  {
+    return path;
+  }
+  path = user_cache_directory();
+  return path.empty() ? path : path + "/config";
+}
+
+
+/// Read a configuration file, using a pre-resolved copy when it is fresh
+vital::config_block_sptr
+read_cached_config_file(vital::config_path_t const& file_path,
+                        std::string const& application_name,
+                        std::string const& application_version,
+                        vital::config_path_t const& install_prefix,
+                        vital::path_t const& cache_dir)
+{
+  // relative paths depend on the working directory, so it is part of the key
+  std::string const key = file_path + "|" + application_name + "|" +
+                          application_version + "|" + install_prefix + "|" +
+                          ST::GetCurrentWorkingDirectory();
+  {
+    std::lock_guard<std::mutex> lock(memory_cache_mutex);
+    auto const it = memory_cache.find(key);
+    if (it != memory_cache.end() && is_fresh(it->second.sources))
+    {
+      return copy_config(it->second.config);
+    }
+  }
+
+  vital::path_t compiled_path;
+  if (!cache_dir.empty())
+  {
+    std::ostringstream name;
+    name << std::hex << std::setw(16) << std::setfill('0')
+         << static_cast<unsigned long long>(std::hash<std::string>()(key));
+    compiled_path = cache_dir + "/" + name.str() + ".conf";
+  }
+
+  source_map_t sources;
+  vital::config_block_sptr config;
+  if (!compiled_path.empty())
+  {
+    config = read_compiled(compiled_path, key, sources);
+  }
+
+  if (!config)
+  {
+    // Find every file the configuration may be read from: the file itself
+    // and its name in each search path, including those that do not exist
+    // yet, so that adding one is noticed.
+    sources.clear();
+    auto const search_paths =
+      vital::application_config_file_paths(application_name,
+                                           application_version,
+                                           install_prefix);
+    std::vector<vital::path_t> roots(1, file_path);
+    if (!ST::FileIsFullPath(file_path))
+    {
+      VITAL_FOREACH (auto const& sp, search_paths)
+      {
+        roots.push_back(sp + "/" + file_path);
+      }
+    }
+    bool cacheable = true;
+    VITAL_FOREACH (auto const& root, roots)
+    {
+      if (ST::FileExists(root, true))
+      {
+        cacheable = add_sources(root, search_paths, sources) && cacheable;
+      }
+      else
+      {
+        sources[ST::CollapseFullPath(root)] = "-";
+      }
+    }
+
+    config = vital::read_config_file(file_path, application_name,
+                                     application_version, install_prefix);
+    if (!cacheable)
+    {
+      return config;
+    }
+    if (!compiled_path.empty())
+    {
+      write_compiled(compiled_path, key, sources, config);
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(memory_cache_mutex);
+  cache_entry& entry = memory_cache[key];
+  entry.sources = sources;
+  entry.config = config;
+  return copy_config(config);
+}
+
+
+} // end namespace maptk
+} // end namespace kwiver
@@ -0,0 +1,113 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Header for maptk::read_cached_config_file and related functions
+ */
+
+#ifndef MAPTK_CONFIG_CACHE_H_
+#define MAPTK_CONFIG_CACHE_H_
+
+
+#include <vital/vital_config.h>
+#include <maptk/maptk_export.h>
+
+#include <vital/config/config_block.h>
+#include <vital/vital_types.h>
+
+#include <string>
+
+
+namespace kwiver {
+namespace maptk {
+
+
+/// Per-user directory for MAP-Tk cache files
+/**
+ * This is maptk in the platform user cache directory (LOCALAPPDATA on
+ * Windows, otherwise XDG_CACHE_HOME or ~/.cache), or empty if none is known.
+ */
+MAPTK_EXPORT
+vital::path_t
+user_cache_directory();
+
+
+/// Default directory for compiled configuration files
+/**
+ * This is the MAPTK_CONFIG_CACHE environment variable if set, otherwise
+ * config in user_cache_directory().  An empty path disables the on-disk
+ * cache.
+ */
+MAPTK_EXPORT
+vital::path_t
+config_cache_directory();
+
+
+/// Read a configuration file, using a pre-resolved copy when it is fresh
+/**
+ * This returns the same configuration as vital::read_config_file with the
+ * same arguments.  The first read resolves all includes and stores the
+ * flattened result, together with the modification time of every source
+ * file, both in memory and as a compiled file in \p cache_dir.  Later reads,
+ * in this process or another, use the flattened result as long as no source
+ * file has been modified, added or removed, so only the compiled file is
+ * parsed (or nothing, when cached in memory).
+ *
+ * Values are kept with their descriptions and read-only flags.  Files which
+ * use macros (such as \c $ENV{...} or \c $LOCAL{...}) anywhere are always
+ * read directly, since their expanded values may change without any source
+ * file changing.
+ *
+ * \returns a new config block, which the caller may modify freely
+ */
+MAPTK_EXPORT
+vital::config_block_sptr
+read_cached_config_file(vital::config_path_t const& file_path,
+                        std::string const& application_name,
+                        std::string const& application_version,
+                        vital::config_path_t const& install_prefix,
+                        vital::path_t const& cache_dir = config_cache_directory());
+
+
+/// Forget the configurations cached in memory by read_cached_config_file
+/**
+ * Compiled files are kept, so later reads use them as a new process would.
+ */
+MAPTK_EXPORT
+void
+clear_config_memory_cache();
+
+
+} // end namespace maptk
+} // end namespace kwiver
+
+
+#endif // MAPTK_CONFIG_CACHE_H_
@@ -0,0 +1,214 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Implementation of maptk::covisibility_index
+ */
+
+#include "covisibility_index.h"
+
+#include <maptk/parallel.h>
+
+#include <vital/exceptions.h>
+#include <vital/vital_foreach.h>
+
+#include <algorithm>
+#include <cstdlib>
+
+
+namespace kwiver {
+namespace maptk {
+
+namespace {
+
+typedef covisibility_index::neighbor neighbor;
+
+/// Order neighbors by decreasing count, then increasing frame
+bool
+stronger(neighbor const& a, neighbor const& b)
+{
+  return a.count > b.count || (a.count == b.count && a.frame < b.frame);
+}
+
+/// Add a symmetric pair of neighbors
+void
+add_pair(std::unordered_map<vital::frame_id_t, std::vector<neighbor> >& n,
+         vital::frame_id_t a, vital::frame_id_t b, unsigned int count)
+{
+  neighbor na = { b, count };
+  neighbor nb = { a, count };
+  n[a].push_back(na);
+  n[b].push_back(nb);
+}
+
+}
+
+
+/// Constructor
+covisibility_index
+::covisibility_index(unsigned num_threads)
+  : num_threads_(num_threads)
+{
+}
+
+
+/// Build the index from the frame pair counts of a match matrix builder
+void
+covisibility_index
+::build(match_matrix_builder const& builder)
+{
+  std::unordered_map<vital::frame_id_t, std::vector<neighbor> > neighbors;
+  VITAL_FOREACH (auto const& c, builder.pair_counts())
+  {
+    // the diagonal holds the number of tracks on a frame, not a neighbor
+    if (c.first.first != c.first.second && c.second > 0)
+    {
+      add_pair(neighbors, c.first.first, c.first.second,
+               static_cast<unsigned int>(c.second));
+    }
+  }
+  this->set_neighbors(neighbors);
+}
+
+
+/// Build the index from a match matrix
+void
+covisibility_index
+::build(Eigen::SparseMatrix<unsigned int> const& mm,
+        std::vector<vital::frame_id_t> const& frames)
+{
+  if (static_cast<size_t>(mm.rows()) != frames.size() ||
+      static_cast<size_t>(mm.cols()) != frames.size())
+  {
+    throw vital::invalid_value("Match matrix size does not match the "
+                               "number of frames");
+  }
+
+  std::unordered_map<vital::frame_id_t, std::vector<neighbor> > neighbors;
+  for (int k = 0; k < mm.outerSize(); ++k)
+  {
+    for (Eigen::SparseMatrix<unsigned int>::InnerIterator it(mm, k); it; ++it)
+    {
+      // use the upper triangle so each symmetric pair is added once
+      if (it.row() < it.col() && it.value() > 0)
+      {
+        add_pair(neighbors, frames[it.row()], frames[it.col()], it.value());
+      }
+    }
+  }
+  this->set_neighbors(neighbors);
+}
+
+
+/// Sort the neighbor lists and swap them into place
+void
+covisibility_index
+::set_neighbors(std::unordered_map<vital::frame_id_t,
+                                   std::vector<neighbor> >& neighbors)
+{
+  std::vector<std::vector<neighbor>*> lists;
+  lists.reserve(neighbors.size());
+  VITAL_FOREACH (auto& n, neighbors)
+  {
+    lists.push_back(&n.second);
+  }
+  parallel_for_chunks(lists.size(), num_threads_,
+                      [&lists](size_t begin, size_t end)
+  {
+    for (size_t i = begin; i < end; ++i)
+    {
+      std::sort(lists[i]->begin(), lists[i]->end(), stronger);
+    }
+  });
+  neighbors_.swap(neighbors);
+}
+
+
+/// Find the frames sharing the most tracks with a frame
+std::vector<covisibility_index::neighbor>
+covisibility_index
+::top_k(vital::frame_id_t frame, size_t k,
+        vital::frame_id_t exclusion_window,
+        unsigned int min_count, bool earlier_only) const
+{
+  std::vector<neighbor> result;
+  auto const it = neighbors_.find(frame);
+  if (it == neighbors_.end())
+  {
+    return result;
+  }
+
+  VITAL_FOREACH (auto const& n, it->second)
+  {
+    if (result.size() >= k || n.count < min_count)
+    {
+      break;
+    }
+    if ((earlier_only && n.frame > frame) ||
+        std::abs(n.frame - frame) <= exclusion_window)
+    {
+      continue;
+    }
+    result.push_back(n);
+  }
+  return result;
+}
+
+
+/// Find loop closure candidate pairs for every indexed frame
+std::vector<std::pair<vital::frame_id_t, vital::frame_id_t> >
+covisibility_index
+::candidate_pairs(size_t k, vital::frame_id_t exclusion_window,
+                  unsigned int min_count) const
+{
+  std::vector<vital::frame_id_t> frames;
+  frames.reserve(neighbors_.size());
+  VITAL_FOREACH (auto const& n, neighbors_)
+  {
+    frames.push_back(n.first);
+  }
+  std::sort(frames.begin(), frames.end());
+
+  std::vector<std::pair<vital::frame_id_t, vital::frame_id_t> > pairs;
+  VITAL_FOREACH (auto const f, frames)
+  {
+    VITAL_FOREACH (auto const& n,
+                   this->top_k(f, k, exclusion_window, min_count, true))
+    {
+      pairs.push_back(std::make_pair(n.frame, f));
+    }
+  }
+  return pairs;
+}
+
+
+} // end namespace maptk
+} // end namespace kwiver
@@ -0,0 +1,148 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Header for maptk::covisibility_index
+ */
+
+#ifndef MAPTK_COVISIBILITY_INDEX_H_
+#define MAPTK_COVISIBILITY_INDEX_H_
+
+
+#include <vital/vital_config.h>
+#include <maptk/maptk_export.h>
+
+#include <maptk/match_matrix_builder.h>
+
+#include <vital/vital_types.h>
+
+#include <Eigen/SparseCore>
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+namespace kwiver {
+namespace maptk {
+
+
+/// Per-frame index of the frames sharing the most tracks with each frame
+/**
+ * This index is built from match matrix data and answers "which frames
+ * share the most tracks with frame f?" without scanning a row of the match
+ * matrix.  The neighbors of each frame are stored sorted by decreasing
+ * shared track count, so a top-K query walks at most K entries plus those
+ * rejected by the temporal exclusion window.  This is intended for selecting
+ * loop closure candidates, where frames close in time to the query are
+ * already connected by tracking and should be skipped.
+ */
+class MAPTK_EXPORT covisibility_index
+{
+public:
+  /// A co-visible frame and the number of tracks it shares with the query
+  struct neighbor
+  {
+    vital::frame_id_t frame;
+    unsigned int count;
+  };
+
+  /// Constructor
+  /**
+   * \param num_threads number of threads used to sort the neighbor lists,
+   *                    or zero to use the number of hardware threads
+   */
+  explicit covisibility_index(unsigned num_threads = 1);
+
+  /// Set the number of threads to use
+  void set_num_threads(unsigned num_threads) { num_threads_ = num_threads; }
+
+  /// Build the index from the frame pair counts of a match matrix builder
+  void build(match_matrix_builder const& builder);
+
+  /// Build the index from a match matrix
+  /**
+   * \param mm a symmetric match matrix as produced by match_matrix_builder
+   * \param frames the frame numbers of the rows and columns of \p mm
+   */
+  void build(Eigen::SparseMatrix<unsigned int> const& mm,
+             std::vector<vital::frame_id_t> const& frames);
+
+  /// Remove all indexed frames
+  void clear() { neighbors_.clear(); }
+
+  /// Number of frames with at least one co-visible frame
+  size_t num_frames() const { return neighbors_.size(); }
+
+  /// Find the frames sharing the most tracks with a frame
+  /**
+   * \param frame the query frame
+   * \param k the maximum number of frames to return
+   * \param exclusion_window frames within this many frames of \p frame
+   *                         (inclusive) are not returned
+   * \param min_count frames sharing fewer tracks than this are not returned
+   * \param earlier_only if true, only frames before \p frame are returned
+   * \return up to \p k neighbors sorted by decreasing shared track count,
+   *         ties broken by increasing frame number
+   */
+  std::vector<neighbor>
+  top_k(vital::frame_id_t frame, size_t k,
+        vital::frame_id_t exclusion_window = 0,
+        unsigned int min_count = 1,
+        bool earlier_only = false) const;
+
+  /// Find loop closure candidate pairs for every indexed frame
+  /**
+   * Runs top_k() with \p earlier_only set on every indexed frame, so each
+   * pair is reported once, as (earlier frame, later frame).  Pairs are
+   * sorted by the later frame, then by decreasing shared track count.
+   */
+  std::vector<std::pair<vital::frame_id_t, vital::frame_id_t> >
+  candidate_pairs(size_t k, vital::frame_id_t exclusion_window,
+                  unsigned int min_count = 1) const;
+
+private:
+  /// Sort the neighbor lists and swap them into place
+  void set_neighbors(std::unordered_map<vital::frame_id_t,
+                                        std::vector<neighbor> >& neighbors);
+
+  unsigned num_threads_;
+
+  /// Co-visible frames of each frame, by decreasing shared track count
+  std::unordered_map<vital::frame_id_t, std::vector<neighbor> > neighbors_;
+};
+
+
+} // end namespace maptk
+} // end namespace kwiver
+
+
+#endif // MAPTK_COVISIBILITY_INDEX_H_
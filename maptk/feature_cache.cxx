@@ -0,0 +1,590 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Implementation of maptk::feature_cache
+ */
+
+#include "feature_cache.h"
+
+#include <vital/exceptions.h>
+#include <vital/types/covariance.h>
+#include <vital/types/descriptor.h>
+#include <vital/types/feature.h>
+#include <vital/vital_foreach.h>
+
+#include <kwiversys/SystemTools.hxx>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+
+namespace kwiver {
+namespace maptk {
+
+typedef kwiversys::SystemTools     ST;
+
+namespace {
+
+char const cache_magic[8] = { 'M', 'A', 'P', 'T', 'K', 'F', 'D', 'C' };
+uint32_t const cache_version = 2;
+
+// Feature element type codes
+enum feature_type : uint32_t
+{
+  FLOAT_FEATURES = 1,
+  DOUBLE_FEATURES = 2
+};
+
+// Size of each stored feature: location, magnitude, scale, angle and the
+// upper triangle of the location covariance, then the color
+size_t const feature_record_size = 8 * sizeof(double) + 3;
+
+// Descriptor element type codes
+enum descriptor_type : uint32_t
+{
+  NO_DESCRIPTORS = 0,
+  BYTE_DESCRIPTORS = 1,
+  FLOAT_DESCRIPTORS = 2,
+  DOUBLE_DESCRIPTORS = 3
+};
+
+// 64-bit FNV-1a hash
+uint64_t const fnv_offset = 14695981039346656037ULL;
+uint64_t const fnv_prime = 1099511628211ULL;
+
+uint64_t
+fnv1a(uint64_t h, char const* data, size_t size)
+{
+  for (size_t i = 0; i < size; ++i)
+  {
+    h ^= static_cast<unsigned char>(data[i]);
+    h *= fnv_prime;
+  }
+  return h;
+}
+
+std::string
+to_hex(uint64_t v)
+{
+  std::ostringstream ss;
+  ss << std::hex << std::setw(16) << std::setfill('0') << v;
+  return ss.str();
+}
+
+// Write a POD value or array in host byte order
+template <typename T>
+void write_binary(std::ostream& os, T const* data, size_t count)
+{
+  os.write(reinterpret_cast<char const*>(data), sizeof(T) * count);
+}
+
+// Read a POD value or array in host byte order
+template <typename T>
+void read_binary(std::istream& is, T* data, size_t count)
+{
+  is.read(reinterpret_cast<char*>(data), sizeof(T) * count);
+  if (!is)
+  {
+    throw vital::invalid_data("Unexpected end of feature cache data");
+  }
+}
+
+// Number of bytes left in a stream, or the largest value if it can not seek
+uint64_t
+remaining_bytes(std::istream& is)
+{
+  auto const pos = is.tellg();
+  if (pos == std::istream::pos_type(-1))
+  {
+    return std::numeric_limits<uint64_t>::max();
+  }
+  is.seekg(0, std::ios::end);
+  auto const end = is.tellg();
+  is.seekg(pos);
+  if (end == std::istream::pos_type(-1) || !is)
+  {
+    is.clear();
+    is.seekg(pos);
+    return std::numeric_limits<uint64_t>::max();
+  }
+  return static_cast<uint64_t>(end - pos);
+}
+
+// Check that a count of records of the given size fits in the remaining
+// data, so a corrupt count fails before anything is allocated for it
+void
+check_count(uint64_t count, uint64_t record_size, uint64_t& remaining)
+{
+  if (count > remaining / record_size)
+  {
+    throw vital::invalid_data("Unexpected end of feature cache data");
+  }
+  remaining -= count * record_size;
+}
+
+// Element type code of a feature
+uint32_t
+type_code(vital::feature const& f)
+{
+  if (f.data_type() == typeid(float))
+  {
+    return FLOAT_FEATURES;
+  }
+  return DOUBLE_FEATURES;
+}
+
+// Create a feature of element type T from stored values
+template <typename T>
+vital::feature_sptr
+make_feature(double const* values, unsigned char const* color)
+{
+  auto f = std::make_shared<vital::feature_<T> >(
+    Eigen::Matrix<T, 2, 1>(static_cast<T>(values[0]),
+                           static_cast<T>(values[1])),
+    static_cast<T>(values[2]), static_cast<T>(values[3]),
+    static_cast<T>(values[4]),
+    vital::rgb_color(color[0], color[1], color[2]));
+  Eigen::Matrix<T, 2, 2> covar;
+  covar << static_cast<T>(values[5]), static_cast<T>(values[6]),
+           static_cast<T>(values[6]), static_cast<T>(values[7]);
+  f->set_covar(vital::covariance_<2, T>(covar));
+  return f;
+}
+
+// Element type code of a descriptor
+uint32_t
+type_code(vital::descriptor const& d)
+{
+  if (d.data_type() == typeid(unsigned char))
+  {
+    return BYTE_DESCRIPTORS;
+  }
+  if (d.data_type() == typeid(float))
+  {
+    return FLOAT_DESCRIPTORS;
+  }
+  if (d.data_type() == typeid(double))
+  {
+    return DOUBLE_DESCRIPTORS;
+  }
+  throw vital::invalid_data("Unsupported descriptor element type for "
+                            "the feature cache");
+}
+
+// Read one descriptor of element type T
+template <typename T>
+vital::descriptor_sptr
+read_descriptor(std::istream& is, uint32_t size, uint64_t& remaining)
+{
+  check_count(size, sizeof(T), remaining);
+  auto d = std::make_shared<vital::descriptor_dynamic<T> >(size);
+  read_binary(is, d->raw_data(), size);
+  return d;
+}
+
+}
+
+
+/// Write features and descriptors in the binary feature cache format
+void
+write_feature_cache(std::ostream& os,
+                    vital::feature_set const& features,
+                    vital::descriptor_set const* descriptors)
+{
+  std::vector<vital::feature_sptr> const feat = features.features();
+  uint32_t feat_type = 0;
+  VITAL_FOREACH (auto const& f, feat)
+  {
+    if (!f)
+    {
+      continue;
+    }
+    uint32_t const t = type_code(*f);
+    if (feat_type != 0 && t != feat_type)
+    {
+      throw vital::invalid_data("Features of mixed element types can "
+                                "not be written to the feature cache");
+    }
+    feat_type = t;
+  }
+  if (feat_type == 0)
+  {
+    feat_type = DOUBLE_FEATURES;
+  }
+
+  std::vector<vital::descriptor_sptr> desc;
+  uint32_t desc_type = NO_DESCRIPTORS;
+  if (descriptors)
+  {
+    desc = descriptors->descriptors();
+    VITAL_FOREACH (auto const& d, desc)
+    {
+      if (!d)
+      {
+        continue;
+      }
+      uint32_t const t = type_code(*d);
+      if (desc_type != NO_DESCRIPTORS && t != desc_type)
+      {
+        throw vital::invalid_data("Descriptors of mixed element types can "
+                                  "not be written to the feature cache");
+      }
+      desc_type = t;
+    }
+  }
+
+  uint64_t const num_features = feat.size();
+  write_binary(os, cache_magic, sizeof(cache_magic));
+  write_binary(os, &cache_version, 1);
+  write_binary(os, &feat_type, 1);
+  write_binary(os, &num_features, 1);
+
+  VITAL_FOREACH (auto const& f, feat)
+  {
+    double values[8] = { 0, 0, 0, 1, 0, 1, 0, 1 };
+    unsigned char color[3] = { 0, 0, 0 };
+    if (f)
+    {
+      auto const covar = f->covar();
+      values[0] = f->loc()[0];
+      values[1] = f->loc()[1];
+      values[2] = f->magnitude();
+      values[3] = f->scale();
+      values[4] = f->angle();
+      values[5] = covar(0, 0);
+      values[6] = covar(0, 1);
+      values[7] = covar(1, 1);
+      color[0] = f->color().r;
+      color[1] = f->color().g;
+      color[2] = f->color().b;
+    }
+    write_binary(os, values, 8);
+    write_binary(os, color, 3);
+  }
+
+  uint64_t const num_descriptors = desc.size();
+  write_binary(os, &desc_type, 1);
+  write_binary(os, &num_descriptors, 1);
+  VITAL_FOREACH (auto const& d, desc)
+  {
+    // a length of zero marks a missing descriptor
+    std::vector<vital::byte> const bytes =
+      d ? d->as_bytes() : std::vector<vital::byte>();
+    uint32_t const size = d ? static_cast<uint32_t>(d->size()) : 0;
+    write_binary(os, &size, 1);
+    write_binary(os, bytes.data(), bytes.size());
+  }
+
+  if (!os)
+  {
+    throw vital::invalid_data("Failed to write feature cache data");
+  }
+}
+
+
+/// Read features and descriptors in the binary feature cache format
+void
+read_feature_cache(std::istream& is,
+                   vital::feature_set_sptr& features,
+                   vital::descriptor_set_sptr& descriptors)
+{
+  char magic[sizeof(cache_magic)];
+  read_binary(is, magic, sizeof(magic));
+  if (std::memcmp(magic, cache_magic, sizeof(magic)) != 0)
+  {
+    throw vital::invalid_data("Not a feature cache file");
+  }
+  uint32_t version, feat_type;
+  read_binary(is, &version, 1);
+  read_binary(is, &feat_type, 1);
+  if (version != cache_version)
+  {
+    throw vital::invalid_data("Unsupported feature cache version");
+  }
+  if (feat_type != FLOAT_FEATURES && feat_type != DOUBLE_FEATURES)
+  {
+    throw vital::invalid_data("Unknown feature type in feature cache");
+  }
+
+  uint64_t num_features;
+  read_binary(is, &num_features, 1);
+  uint64_t remaining = remaining_bytes(is);
+  check_count(num_features, feature_record_size, remaining);
+  std::vector<vital::feature_sptr> feat;
+  feat.reserve(static_cast<size_t>(num_features));
+  for (uint64_t i = 0; i < num_features; ++i)
+  {
+    double values[8];
+    unsigned char color[3];
+    read_binary(is, values, 8);
+    read_binary(is, color, 3);
+    feat.push_back(feat_type == FLOAT_FEATURES
+                   ? make_feature<float>(values, color)
+                   : make_feature<double>(values, color));
+  }
+
+  uint32_t desc_type;
+  uint64_t num_descriptors;
+  check_count(1, sizeof(desc_type) + sizeof(num_descriptors), remaining);
+  read_binary(is, &desc_type, 1);
+  read_binary(is, &num_descriptors, 1);
+  // each descriptor takes at least its length
+  check_count(num_descriptors, sizeof(uint32_t), remaining);
+  std::vector<vital::descriptor_sptr> desc;
+  desc.reserve(static_cast<size_t>(num_descriptors));
+  for (uint64_t i = 0; i < num_descriptors; ++i)
+  {
+    uint32_t size;
+    read_binary(is, &size, 1);
+    if (size == 0)
+    {
+      desc.push_back(vital::descriptor_sptr());
+      continue;
+    }
+    switch (desc_type)
+    {
+      case BYTE_DESCRIPTORS:
+        desc.push_back(read_descriptor<unsigned char>(is, size, remaining));
+        break;
+      case FLOAT_DESCRIPTORS:
+        desc.push_back(read_descriptor<float>(is, size, remaining));
+        break;
+      case DOUBLE_DESCRIPTORS:
+        desc.push_back(read_descriptor<double>(is, size, remaining));
+        break;
+      default:
+        throw vital::invalid_data("Unknown descriptor type in feature cache");
+    }
+  }
+
+  features = std::make_shared<vital::simple_feature_set>(feat);
+  descriptors = std::make_shared<vital::simple_descriptor_set>(desc);
+}
+
+
+/// Constructor
+feature_cache
+::feature_cache(vital::path_t const& directory)
+  : directory_(directory)
+{
+}
+
+
+/// Hash the values of a configuration block
+uint64_t
+feature_cache
+::hash_config(vital::config_block_sptr const& config)
+{
+  uint64_t h = fnv_offset;
+  if (!config)
+  {
+    return h;
+  }
+  auto keys = config->available_values();
+  std::sort(keys.begin(), keys.end());
+  VITAL_FOREACH (auto const& k, keys)
+  {
+    std::string const entry =
+      k + "=" + config->get_value<std::string>(k, "") + "\n";
+    h = fnv1a(h, entry.data(), entry.size());
+  }
+  return h;
+}
+
+
+/// Gather the configuration of the algorithms that produce cached features
+vital::config_block_sptr
+feature_cache
+::detection_config(vital::config_block_sptr const& image_reader,
+                   vital::config_block_sptr const& image_converter,
+                   vital::config_block_sptr const& feature_detector,
+                   vital::config_block_sptr const& descriptor_extractor)
+{
+  auto config = vital::config_block::empty_config();
+  std::pair<char const*, vital::config_block_sptr> const blocks[] = {
+    { "image_reader", image_reader },
+    { "image_converter", image_converter },
+    { "feature_detector", feature_detector },
+    { "descriptor_extractor", descriptor_extractor }
+  };
+  VITAL_FOREACH (auto const& b, blocks)
+  {
+    if (!b.second)
+    {
+      continue;
+    }
+    VITAL_FOREACH (auto const& key, b.second->available_values())
+    {
+      config->set_value(std::string(b.first) + ":" + key,
+                        b.second->get_value<std::string>(key, ""));
+    }
+  }
+  return config;
+}
+
+
+/// Hash the contents of a file
+uint64_t
+feature_cache
+::hash_file(vital::path_t const& file_path)
+{
+  std::ifstream ifs(file_path.c_str(), std::ios::in | std::ios::binary);
+  if (!ifs)
+  {
+    throw vital::file_not_read_exception(file_path, "Could not open file");
+  }
+  uint64_t h = fnv_offset;
+  std::vector<char> buffer(1 << 16);
+  while (ifs)
+  {
+    ifs.read(buffer.data(), buffer.size());
+    h = fnv1a(h, buffer.data(), static_cast<size_t>(ifs.gcount()));
+  }
+  return h;
+}
+
+
+/// Compute the cache key for an image
+std::string
+feature_cache
+::make_key(vital::path_t const& image_file, uint64_t config_hash,
+           vital::path_t const& mask_file)
+{
+  uint64_t settings = config_hash;
+  if (!mask_file.empty())
+  {
+    uint64_t const mask_hash = hash_file(mask_file);
+    settings = fnv1a(settings, reinterpret_cast<char const*>(&mask_hash),
+                     sizeof(mask_hash));
+  }
+  return to_hex(hash_file(image_file)) + "-" + to_hex(settings);
+}
+
+
+/// Path of the cache file for a key
+vital::path_t
+feature_cache
+::entry_path(std::string const& key) const
+{
+  // spread entries over subdirectories named by the first two key digits
+  return directory_ + "/" + key.substr(0, 2) + "/" + key + ".mfc";
+}
+
+
+/// Load the features and descriptors stored for a key
+bool
+feature_cache
+::load(std::string const& key,
+       vital::feature_set_sptr& features,
+       vital::descriptor_set_sptr& descriptors) const
+{
+  std::ifstream ifs(entry_path(key).c_str(), std::ios::in | std::ios::binary);
+  if (!ifs)
+  {
+    return false;
+  }
+  try
+  {
+    vital::feature_set_sptr f;
+    vital::descriptor_set_sptr d;
+    read_feature_cache(ifs, f, d);
+    features = f;
+    descriptors = d;
+    return true;
+  }
+  catch (...)
+  {
+    // any unreadable entry, however it fails, is a cache miss
+    return false;
+  }
+}
+
+
+/// Store features and descriptors for a key
+bool
+feature_cache
+::store(std::string const& key,
+        vital::feature_set_sptr const& features,
+        vital::descriptor_set_sptr const& descriptors) const
+{
+  if (!features)
+  {
+    return false;
+  }
+  vital::path_t const path = entry_path(key);
+  if (!ST::MakeDirectory(ST::GetFilenamePath(path)))
+  {
+    return false;
+  }
+
+  // write to a uniquely named file, then rename it into place so readers
+  // never see a partial entry
+  std::random_device rd;
+  vital::path_t const tmp_path = path + "." + to_hex(rd()) + ".tmp";
+  try
+  {
+    std::ofstream ofs(tmp_path.c_str(), std::ios::out | std::ios::binary);
+    if (!ofs)
+    {
+      return false;
+    }
+    write_feature_cache(ofs, *features, descriptors.get());
+    ofs.close();
+    if (!ofs)
+    {
+      throw vital::invalid_data("Failed to write feature cache data");
+    }
+  }
+  catch (vital::invalid_data const&)
+  {
+    std::remove(tmp_path.c_str());
+    return false;
+  }
+  if (std::rename(tmp_path.c_str(), path.c_str()) != 0)
+  {
+    std::remove(tmp_path.c_str());
+    return false;
+  }
+  return true;
+}
+
+
+} // end namespace maptk
+} // end namespace kwiver
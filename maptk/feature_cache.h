@@ -0,0 +1,183 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Header for maptk::feature_cache, an on-disk feature and descriptor
+ *        cache
+ */
+
+#ifndef MAPTK_FEATURE_CACHE_H_
+#define MAPTK_FEATURE_CACHE_H_
+
+
+#include <vital/vital_config.h>
+#include <maptk/maptk_export.h>
+
+#include <vital/config/config_block.h>
+#include <vital/types/descriptor_set.h>
+#include <vital/types/feature_set.h>
+#include <vital/vital_types.h>
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+
+namespace kwiver {
+namespace maptk {
+
+
+/// Write features and descriptors in the binary feature cache format
+/**
+ * The format stores, in host byte order, a header ("MAPTKFDC", a version,
+ * the feature element type and the feature count), then for each feature its
+ * location, magnitude, scale, angle, location covariance and color, then the
+ * descriptor element type and each descriptor's length and raw values.
+ * Descriptors are optional.  Features are read back with the element type
+ * (float or double) they were written with.
+ *
+ * \throws vital::invalid_data if the features or descriptors are not all of
+ *         the same element type, or if the descriptors are of an element
+ *         type the format does not support (unsigned char, float or double)
+ */
+MAPTK_EXPORT
+void
+write_feature_cache(std::ostream& os,
+                    vital::feature_set const& features,
+                    vital::descriptor_set const* descriptors);
+
+/// Read features and descriptors in the binary feature cache format
+/**
+ * Counts are checked against the size of the remaining data before anything
+ * is allocated for them.
+ *
+ * \throws vital::invalid_data if the stream is not in the expected format
+ */
+MAPTK_EXPORT
+void
+read_feature_cache(std::istream& is,
+                   vital::feature_set_sptr& features,
+                   vital::descriptor_set_sptr& descriptors);
+
+
+/// A content-addressed on-disk cache of detected features and descriptors
+/**
+ * Entries are keyed by a hash of the image file contents, of the optional
+ * mask file contents, and of the configuration of the algorithms that
+ * produced the features (typically the image converter, feature detector
+ * and descriptor extractor).  Changing any of them gives a different key,
+ * so stale entries are never returned; they are simply not used again.
+ *
+ * Entries are written to a temporary file and renamed into place, so
+ * several processes may share a cache directory.
+ */
+class MAPTK_EXPORT feature_cache
+{
+public:
+  /// Constructor
+  /**
+   * \param directory the cache directory, created on first store if needed
+   */
+  explicit feature_cache(vital::path_t const& directory);
+
+  /// The cache directory
+  vital::path_t const& directory() const { return directory_; }
+
+  /// Hash the values of a configuration block
+  /**
+   * Keys are hashed in sorted order with their values, so the hash does not
+   * depend on the order in which values were set.
+   */
+  static uint64_t hash_config(vital::config_block_sptr const& config);
+
+  /// Gather the configuration of the algorithms that produce cached features
+  /**
+   * Each block is copied under a fixed name (image_reader, image_converter,
+   * feature_detector and descriptor_extractor), so tools which nest these
+   * algorithms differently, e.g. within a feature tracker, hash the same
+   * settings to the same value.  Null blocks are skipped.
+   */
+  static vital::config_block_sptr
+  detection_config(vital::config_block_sptr const& image_reader,
+                   vital::config_block_sptr const& image_converter,
+                   vital::config_block_sptr const& feature_detector,
+                   vital::config_block_sptr const& descriptor_extractor);
+
+  /// Hash the contents of a file
+  /**
+   * \throws vital::file_not_read_exception if the file cannot be read
+   */
+  static uint64_t hash_file(vital::path_t const& file_path);
+
+  /// Compute the cache key for an image
+  /**
+   * \param image_file the image the features are detected on
+   * \param config_hash the hash of the configuration used for detection
+   *                    and extraction, from hash_config()
+   * \param mask_file the detection mask, or empty if none
+   */
+  static std::string make_key(vital::path_t const& image_file,
+                              uint64_t config_hash,
+                              vital::path_t const& mask_file = "");
+
+  /// Load the features and descriptors stored for a key
+  /**
+   * \return true if an entry was found and read; a missing, corrupt or
+   *         otherwise unreadable entry returns false and leaves the outputs
+   *         unchanged
+   */
+  bool load(std::string const& key,
+            vital::feature_set_sptr& features,
+            vital::descriptor_set_sptr& descriptors) const;
+
+  /// Store features and descriptors for a key
+  /**
+   * \return true if the entry was written; failures (e.g. an unsupported
+   *         descriptor type or an unwritable directory) are not fatal to
+   *         callers, which can continue without the cache
+   */
+  bool store(std::string const& key,
+             vital::feature_set_sptr const& features,
+             vital::descriptor_set_sptr const& descriptors) const;
+
+  /// Path of the cache file for a key
+  vital::path_t entry_path(std::string const& key) const;
+
+private:
+  vital::path_t directory_;
+};
+
+
+} // end namespace maptk
+} // end namespace kwiver
+
+
+#endif // MAPTK_FEATURE_CACHE_H_
@@ -0,0 +1,339 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Implementation of maptk::match_matrix_builder
+ */
+
+#include "match_matrix_builder.h"
+
+#include <maptk/parallel.h>
+
+#include <vital/vital_foreach.h>
+
+#include <algorithm>
+#include <iterator>
+#include <unordered_set>
+
+
+namespace kwiver {
+namespace maptk {
+
+namespace {
+
+typedef std::vector<vital::frame_id_t> frame_list_t;
+typedef match_matrix_builder::pair_count_map_t pair_count_map_t;
+
+/// Add \p delta to the count of every pair of frames within \p a and every
+/// pair with one frame from \p a and the other from \p b
+void
+add_pairs(pair_count_map_t& counts, frame_list_t const& a,
+          frame_list_t const& b, long long delta)
+{
+  for (size_t i = 0; i < a.size(); ++i)
+  {
+    for (size_t j = i; j < a.size(); ++j)
+    {
+      counts[std::make_pair(a[i], a[j])] += delta;
+    }
+    VITAL_FOREACH (auto const f, b)
+    {
+      counts[std::make_pair(std::min(a[i], f), std::max(a[i], f))] += delta;
+    }
+  }
+}
+
+/// Merge a sparse count buffer into another, dropping entries that reach zero
+void
+merge_counts(pair_count_map_t& counts, pair_count_map_t const& delta)
+{
+  VITAL_FOREACH (auto const& d, delta)
+  {
+    if (d.second == 0)
+    {
+      continue;
+    }
+    auto const it = counts.insert(std::make_pair(d.first, 0LL)).first;
+    it->second += d.second;
+    if (it->second == 0)
+    {
+      counts.erase(it);
+    }
+  }
+}
+
+/// Sorted, unique frames of a track
+frame_list_t
+track_frame_list(vital::track const& t)
+{
+  frame_list_t frames;
+  frames.reserve(t.size());
+  VITAL_FOREACH (auto const& ts, t)
+  {
+    frames.push_back(ts.frame_id);
+  }
+  std::sort(frames.begin(), frames.end());
+  frames.erase(std::unique(frames.begin(), frames.end()), frames.end());
+  return frames;
+}
+
+/// Test if a remembered track refers to the same object as \p t
+/**
+ * This compares ownership rather than addresses, so a new track allocated
+ * where a destroyed one used to be is not mistaken for it.
+ */
+bool
+same_track(std::weak_ptr<vital::track> const& w, vital::track_sptr const& t)
+{
+  return !w.owner_before(t) && !t.owner_before(w);
+}
+
+/// Changed track, to be stored after the parallel pass
+struct track_change
+{
+  vital::track_sptr track;
+  frame_list_t frames;
+};
+
+}
+
+
+/// Constructor
+match_matrix_builder
+::match_matrix_builder(unsigned num_threads)
+  : num_threads_(num_threads)
+{
+}
+
+
+/// Update the accumulated counts to reflect a set of tracks
+void
+match_matrix_builder
+::update(std::vector<vital::track_sptr> const& tracks, bool remove_missing)
+{
+  size_t const num_chunks =
+    std::max<size_t>(std::min<size_t>(resolve_num_threads(num_threads_),
+                                      tracks.size()), 1);
+  std::vector<pair_count_map_t> chunk_counts(num_chunks);
+  std::vector< std::vector<track_change> > chunk_changes(num_chunks);
+
+  // Compute count changes in parallel; the stored tracks are only read
+  // during this pass
+  parallel_for(num_chunks, num_chunks, [&](size_t c)
+  {
+    size_t const begin = (tracks.size() * c) / num_chunks;
+    size_t const end = (tracks.size() * (c + 1)) / num_chunks;
+    auto& counts = chunk_counts[c];
+    auto& changes = chunk_changes[c];
+    frame_list_t const none;
+
+    for (size_t i = begin; i < end; ++i)
+    {
+      auto const& t = tracks[i];
+      if (!t)
+      {
+        continue;
+      }
+
+      // Skip tracks that are the same object, with the same size, as the
+      // last time they were seen
+      auto const it = tracks_.find(t->id());
+      if (it != tracks_.end() && it->second.size == t->size() &&
+          same_track(it->second.track, t))
+      {
+        continue;
+      }
+
+      track_change change;
+      change.track = t;
+      change.frames = track_frame_list(*t);
+
+      if (it == tracks_.end())
+      {
+        add_pairs(counts, change.frames, none, 1);
+      }
+      else if (it->second.frames != change.frames)
+      {
+        frame_list_t const& old_frames = it->second.frames;
+        frame_list_t kept, removed, added;
+        std::set_intersection(old_frames.begin(), old_frames.end(),
+                              change.frames.begin(), change.frames.end(),
+                              std::back_inserter(kept));
+        std::set_difference(old_frames.begin(), old_frames.end(),
+                            change.frames.begin(), change.frames.end(),
+                            std::back_inserter(removed));
+        std::set_difference(change.frames.begin(), change.frames.end(),
+                            old_frames.begin(), old_frames.end(),
+                            std::back_inserter(added));
+        add_pairs(counts, removed, kept, -1);
+        add_pairs(counts, added, kept, 1);
+      }
+      // The track is remembered again even if its frames are unchanged, so
+      // that it is skipped next time
+      changes.push_back(change);
+    }
+  });
+
+  // Merge the per-thread buffers and store the changed tracks
+  for (size_t c = 0; c < num_chunks; ++c)
+  {
+    merge_counts(counts_, chunk_counts[c]);
+    VITAL_FOREACH (auto& change, chunk_changes[c])
+    {
+      auto const id = change.track->id();
+      if (change.frames.empty())
+      {
+        tracks_.erase(id);
+      }
+      else
+      {
+        auto& entry = tracks_[id];
+        entry.track = change.track;
+        entry.size = change.track->size();
+        entry.frames.swap(change.frames);
+      }
+    }
+  }
+
+  // Remove tracks that are no longer present
+  if (remove_missing)
+  {
+    std::unordered_set<vital::track_id_t> ids;
+    VITAL_FOREACH (auto const& t, tracks)
+    {
+      if (t)
+      {
+        ids.insert(t->id());
+      }
+    }
+
+    pair_count_map_t removed_counts;
+    frame_list_t const none;
+    for (auto it = tracks_.begin(); it != tracks_.end(); )
+    {
+      if (ids.count(it->first))
+      {
+        ++it;
+      }
+      else
+      {
+        add_pairs(removed_counts, it->second.frames, none, -1);
+        it = tracks_.erase(it);
+      }
+    }
+    merge_counts(counts_, removed_counts);
+  }
+}
+
+
+/// Remove all accumulated tracks
+void
+match_matrix_builder
+::clear()
+{
+  tracks_.clear();
+  counts_.clear();
+}
+
+
+/// Frames with at least one track state, in increasing order
+std::vector<vital::frame_id_t>
+match_matrix_builder
+::frames() const
+{
+  std::vector<vital::frame_id_t> frames;
+  VITAL_FOREACH (auto const& c, counts_)
+  {
+    if (c.first.first == c.first.second && c.second > 0)
+    {
+      frames.push_back(c.first.first);
+    }
+  }
+  std::sort(frames.begin(), frames.end());
+  return frames;
+}
+
+
+/// Number of tracks shared by two frames
+unsigned int
+match_matrix_builder
+::count(vital::frame_id_t a, vital::frame_id_t b) const
+{
+  auto const it = counts_.find(std::make_pair(std::min(a, b), std::max(a, b)));
+  return (it == counts_.end()) ? 0 : static_cast<unsigned int>(it->second);
+}
+
+
+/// Build the match matrix
+Eigen::SparseMatrix<unsigned int>
+match_matrix_builder
+::matrix(std::vector<vital::frame_id_t>& frames) const
+{
+  if (frames.empty())
+  {
+    frames = this->frames();
+  }
+
+  std::unordered_map<vital::frame_id_t, int> frame_index;
+  for (size_t i = 0; i < frames.size(); ++i)
+  {
+    frame_index[frames[i]] = static_cast<int>(i);
+  }
+
+  typedef Eigen::Triplet<unsigned int> triplet_t;
+  std::vector<triplet_t> triplets;
+  triplets.reserve(2 * counts_.size());
+  auto const no_index = frame_index.end();
+  VITAL_FOREACH (auto const& c, counts_)
+  {
+    auto const ia = frame_index.find(c.first.first);
+    auto const ib = frame_index.find(c.first.second);
+    if (ia == no_index || ib == no_index || c.second <= 0)
+    {
+      continue;
+    }
+    auto const value = static_cast<unsigned int>(c.second);
+    triplets.push_back(triplet_t(ia->second, ib->second, value));
+    if (ia->second != ib->second)
+    {
+      triplets.push_back(triplet_t(ib->second, ia->second, value));
+    }
+  }
+
+  int const n = static_cast<int>(frames.size());
+  Eigen::SparseMatrix<unsigned int> mm(n, n);
+  mm.setFromTriplets(triplets.begin(), triplets.end());
+  return mm;
+}
+
+
+} // end namespace maptk
+} // end namespace kwiver
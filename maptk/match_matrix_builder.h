@@ -0,0 +1,171 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Header for maptk::match_matrix_builder
+ */
+
+#ifndef MAPTK_MATCH_MATRIX_BUILDER_H_
+#define MAPTK_MATCH_MATRIX_BUILDER_H_
+
+
+#include <vital/vital_config.h>
+#include <maptk/maptk_export.h>
+
+#include <vital/types/track_set.h>
+#include <vital/vital_types.h>
+
+#include <Eigen/SparseCore>
+
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+
+namespace kwiver {
+namespace maptk {
+
+
+/// Incrementally maintained, multi-threaded match matrix computation
+/**
+ * This class accumulates the number of tracks shared by each pair of frames,
+ * the same quantity computed by kwiver::arrows::match_matrix.  Tracks are
+ * processed in parallel, with each thread accumulating frame pair counts in
+ * its own sparse buffer, and the buffers are merged at the end.
+ *
+ * The builder remembers each track it has seen, along with its size and
+ * frames, so calling update() again after tracks have been extended, added
+ * or removed only touches the frame pairs that changed rather than
+ * recomputing the matrix.  A track is only examined again if it has been
+ * replaced by a different track object or its size has changed; tracks that
+ * are modified in place must therefore change size (as when states are
+ * appended) for the change to be seen.
+ */
+class MAPTK_EXPORT match_matrix_builder
+{
+public:
+  /// A frame pair, with the lower frame first
+  typedef std::pair<vital::frame_id_t, vital::frame_id_t> frame_pair_t;
+
+  /// Hash function for frame pairs
+  struct frame_pair_hash
+  {
+    size_t operator()(frame_pair_t const& p) const
+    {
+      size_t const h = std::hash<vital::frame_id_t>()(p.first);
+      return h ^ (std::hash<vital::frame_id_t>()(p.second) +
+                  0x9e3779b9 + (h << 6) + (h >> 2));
+    }
+  };
+
+  /// Sparse map from frame pair to count
+  typedef std::unordered_map<frame_pair_t, long long, frame_pair_hash>
+    pair_count_map_t;
+
+  /// Constructor
+  /**
+   * \param num_threads number of threads to use, or zero to use the number
+   *                    of hardware threads
+   */
+  explicit match_matrix_builder(unsigned num_threads = 1);
+
+  /// Set the number of threads to use
+  void set_num_threads(unsigned num_threads) { num_threads_ = num_threads; }
+
+  /// Update the accumulated counts to reflect a set of tracks
+  /**
+   * New tracks are added, and tracks seen before have their changed states
+   * applied.  If \p remove_missing is true, previously seen tracks which are
+   * not in \p tracks are removed; otherwise they are left as they are, which
+   * allows new tracks to be appended without passing the whole set again.
+   */
+  void update(std::vector<vital::track_sptr> const& tracks,
+              bool remove_missing = true);
+
+  /// Update the accumulated counts to reflect a track set
+  void update(vital::track_set const& tracks, bool remove_missing = true)
+  {
+    this->update(tracks.tracks(), remove_missing);
+  }
+
+  /// Remove all accumulated tracks
+  void clear();
+
+  /// Number of tracks currently accumulated
+  size_t num_tracks() const { return tracks_.size(); }
+
+  /// Frames with at least one track state, in increasing order
+  std::vector<vital::frame_id_t> frames() const;
+
+  /// Number of tracks shared by two frames
+  unsigned int count(vital::frame_id_t a, vital::frame_id_t b) const;
+
+  /// Access the sparse frame pair counts (upper triangle only)
+  pair_count_map_t const& pair_counts() const { return counts_; }
+
+  /// Build the match matrix
+  /**
+   * \param [in,out] frames the frame numbers to use for the rows and columns
+   *                 of the matrix; if empty it is filled with frames()
+   * \return a symmetric matrix where entry (i, j) is the number of tracks
+   *         shared by frames[i] and frames[j]
+   */
+  Eigen::SparseMatrix<unsigned int>
+  matrix(std::vector<vital::frame_id_t>& frames) const;
+
+private:
+  unsigned num_threads_;
+
+  /// What is remembered of an accumulated track
+  struct track_entry
+  {
+    /// The track object, used to detect replaced tracks
+    std::weak_ptr<vital::track> track;
+    /// Number of track states when the track was last examined
+    size_t size;
+    /// Sorted frames of the track
+    std::vector<vital::frame_id_t> frames;
+  };
+
+  /// Accumulated tracks, by track ID
+  std::unordered_map<vital::track_id_t, track_entry> tracks_;
+
+  /// Count of tracks shared by each frame pair (first <= second)
+  pair_count_map_t counts_;
+};
+
+
+} // end namespace maptk
+} // end namespace kwiver
+
+
+#endif // MAPTK_MATCH_MATRIX_BUILDER_H_
@@ -0,0 +1,554 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Implementation of file IO functions for sparse match matrices
+ */
+
+#include "match_matrix_io.h"
+
+#include <vital/exceptions.h>
+#include <vital/vital_foreach.h>
+
+#include <kwiversys/SystemTools.hxx>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+
+
+namespace kwiver {
+namespace maptk {
+
+typedef kwiversys::SystemTools     ST;
+
+namespace {
+
+char const csr_magic[8] = { 'M', 'A', 'P', 'T', 'K', 'C', 'S', 'R' };
+uint32_t const csr_version = 1;
+
+std::string const market_banner = "%%MatrixMarket";
+std::string const market_frames = "% frames:";
+size_t const market_frames_per_line = 16;
+
+typedef Eigen::SparseMatrix<unsigned int> match_matrix_t;
+typedef Eigen::Triplet<unsigned int> triplet_t;
+
+// Write a POD value or array in host byte order
+template <typename T>
+void write_binary(std::ostream& os, T const* data, size_t count)
+{
+  os.write(reinterpret_cast<char const*>(data), sizeof(T) * count);
+}
+
+// Read a POD value or array in host byte order
+template <typename T>
+void read_binary(std::istream& is, T* data, size_t count)
+{
+  is.read(reinterpret_cast<char*>(data), sizeof(T) * count);
+  if (!is)
+  {
+    throw vital::invalid_data("Unexpected end of CSR match matrix data");
+  }
+}
+
+// Number of bytes left in a stream, or the maximum value if the stream
+// cannot seek
+uint64_t remaining_bytes(std::istream& is)
+{
+  auto const pos = is.tellg();
+  if (pos < 0 || !is.seekg(0, std::ios::end))
+  {
+    is.clear();
+    return std::numeric_limits<uint64_t>::max();
+  }
+  auto const end = is.tellg();
+  is.seekg(pos);
+  if (end < pos)
+  {
+    return 0;
+  }
+  return static_cast<uint64_t>(end - pos);
+}
+
+// Read the next line that is not blank or a comment
+bool next_data_line(std::istream& is, std::string& line)
+{
+  while (std::getline(is, line))
+  {
+    auto const pos = line.find_first_not_of(" \t\r");
+    if (pos != std::string::npos && line[pos] != '#')
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+}
+
+
+/// Write a match matrix as text triplets to a stream
+void
+write_match_matrix_triplets(std::ostream& os,
+                            match_matrix_t const& mm,
+                            std::vector<vital::frame_id_t> const& frames)
+{
+  os << "# MAP-Tk match matrix: num_frames num_nonzeros, frame numbers, "
+        "then row col count" << std::endl;
+  os << mm.rows() << " " << mm.nonZeros() << std::endl;
+  for (size_t i = 0; i < frames.size(); ++i)
+  {
+    os << (i ? " " : "") << frames[i];
+  }
+  os << std::endl;
+
+  for (int k = 0; k < mm.outerSize(); ++k)
+  {
+    for (match_matrix_t::InnerIterator it(mm, k); it; ++it)
+    {
+      os << it.row() << " " << it.col() << " " << it.value() << "\n";
+    }
+  }
+  os.flush();
+}
+
+
+/// Read a match matrix in text triplet format from a stream
+void
+read_match_matrix_triplets(std::istream& is,
+                           match_matrix_t& mm,
+                           std::vector<vital::frame_id_t>& frames)
+{
+  std::string line;
+  if (!next_data_line(is, line))
+  {
+    throw vital::invalid_data("Missing match matrix triplet header");
+  }
+  size_t num_frames = 0, num_nonzeros = 0;
+  std::istringstream header(line);
+  std::string extra;
+  if (!(header >> num_frames >> num_nonzeros) || (header >> extra))
+  {
+    throw vital::invalid_data("Invalid match matrix triplet header "
+                              "(expected num_frames num_nonzeros): " + line);
+  }
+
+  frames.clear();
+  frames.reserve(num_frames);
+  if (num_frames > 0)
+  {
+    if (!next_data_line(is, line))
+    {
+      throw vital::invalid_data("Missing match matrix frame numbers");
+    }
+    std::istringstream ss(line);
+    vital::frame_id_t f;
+    while (ss >> f)
+    {
+      frames.push_back(f);
+    }
+  }
+  if (frames.size() != num_frames)
+  {
+    throw vital::invalid_data("Match matrix frame number count does not "
+                              "match the header");
+  }
+
+  std::vector<triplet_t> triplets;
+  triplets.reserve(num_nonzeros);
+  long long row, col;
+  unsigned int value;
+  while (is >> row >> col >> value)
+  {
+    if (row < 0 || col < 0 ||
+        row >= static_cast<long long>(num_frames) ||
+        col >= static_cast<long long>(num_frames))
+    {
+      throw vital::invalid_data("Match matrix triplet index out of range");
+    }
+    triplets.push_back(triplet_t(static_cast<int>(row),
+                                 static_cast<int>(col), value));
+  }
+  if (triplets.size() != num_nonzeros)
+  {
+    throw vital::invalid_data("Match matrix triplet count does not match "
+                              "the header");
+  }
+
+  mm = match_matrix_t(static_cast<int>(num_frames),
+                      static_cast<int>(num_frames));
+  mm.setFromTriplets(triplets.begin(), triplets.end());
+}
+
+
+/// Write a match matrix in binary compressed sparse row format to a stream
+void
+write_match_matrix_csr(std::ostream& os,
+                       match_matrix_t const& mm,
+                       std::vector<vital::frame_id_t> const& frames)
+{
+  Eigen::SparseMatrix<unsigned int, Eigen::RowMajor> csr(mm);
+  csr.makeCompressed();
+
+  uint32_t const reserved = 0;
+  uint64_t const num_frames = static_cast<uint64_t>(csr.rows());
+  uint64_t const num_nonzeros = static_cast<uint64_t>(csr.nonZeros());
+
+  std::vector<int64_t> frame_numbers(frames.begin(), frames.end());
+  frame_numbers.resize(num_frames, 0);
+  std::vector<uint64_t> row_offsets(csr.outerIndexPtr(),
+                                    csr.outerIndexPtr() + num_frames + 1);
+  std::vector<uint32_t> columns(csr.innerIndexPtr(),
+                                csr.innerIndexPtr() + num_nonzeros);
+
+  write_binary(os, csr_magic, sizeof(csr_magic));
+  write_binary(os, &csr_version, 1);
+  write_binary(os, &reserved, 1);
+  write_binary(os, &num_frames, 1);
+  write_binary(os, &num_nonzeros, 1);
+  write_binary(os, frame_numbers.data(), frame_numbers.size());
+  write_binary(os, row_offsets.data(), row_offsets.size());
+  write_binary(os, columns.data(), columns.size());
+  write_binary(os, csr.valuePtr(), num_nonzeros);
+  os.flush();
+}
+
+
+/// Read a match matrix in binary compressed sparse row format from a stream
+void
+read_match_matrix_csr(std::istream& is,
+                      match_matrix_t& mm,
+                      std::vector<vital::frame_id_t>& frames)
+{
+  char magic[sizeof(csr_magic)];
+  uint32_t version, reserved;
+  uint64_t num_frames, num_nonzeros;
+  read_binary(is, magic, sizeof(magic));
+  if (std::memcmp(magic, csr_magic, sizeof(magic)) != 0)
+  {
+    throw vital::invalid_data("Not a MAP-Tk CSR match matrix");
+  }
+  read_binary(is, &version, 1);
+  if (version != csr_version)
+  {
+    throw vital::invalid_data("Unsupported CSR match matrix version");
+  }
+  read_binary(is, &reserved, 1);
+  read_binary(is, &num_frames, 1);
+  read_binary(is, &num_nonzeros, 1);
+
+  // Validate the counts before allocating anything from them
+  if (num_frames > static_cast<uint64_t>(std::numeric_limits<int>::max()))
+  {
+    throw vital::invalid_data("CSR match matrix frame count is too large");
+  }
+  if (num_nonzeros > num_frames * num_frames)
+  {
+    throw vital::invalid_data("CSR match matrix has more non-zeros than "
+                              "entries");
+  }
+  uint64_t const remaining = remaining_bytes(is);
+  uint64_t const frame_data_size =
+    num_frames * sizeof(int64_t) + (num_frames + 1) * sizeof(uint64_t);
+  uint64_t const nonzero_size = sizeof(uint32_t) + sizeof(unsigned int);
+  if (frame_data_size > remaining ||
+      num_nonzeros > (remaining - frame_data_size) / nonzero_size)
+  {
+    throw vital::invalid_data("Unexpected end of CSR match matrix data");
+  }
+
+  std::vector<int64_t> frame_numbers(num_frames);
+  std::vector<uint64_t> row_offsets(num_frames + 1);
+  std::vector<uint32_t> columns(num_nonzeros);
+  std::vector<unsigned int> values(num_nonzeros);
+  read_binary(is, frame_numbers.data(), frame_numbers.size());
+  read_binary(is, row_offsets.data(), row_offsets.size());
+  read_binary(is, columns.data(), columns.size());
+  read_binary(is, values.data(), values.size());
+
+  std::vector<triplet_t> triplets;
+  triplets.reserve(num_nonzeros);
+  for (uint64_t r = 0; r < num_frames; ++r)
+  {
+    if (row_offsets[r] > row_offsets[r + 1] ||
+        row_offsets[r + 1] > num_nonzeros)
+    {
+      throw vital::invalid_data("Invalid CSR match matrix row offsets");
+    }
+    for (uint64_t k = row_offsets[r]; k < row_offsets[r + 1]; ++k)
+    {
+      if (columns[k] >= num_frames)
+      {
+        throw vital::invalid_data("CSR match matrix column index out of range");
+      }
+      triplets.push_back(triplet_t(static_cast<int>(r),
+                                   static_cast<int>(columns[k]), values[k]));
+    }
+  }
+
+  frames.assign(frame_numbers.begin(), frame_numbers.end());
+  mm = match_matrix_t(static_cast<int>(num_frames),
+                      static_cast<int>(num_frames));
+  mm.setFromTriplets(triplets.begin(), triplets.end());
+}
+
+
+/// Write a match matrix in Matrix Market coordinate format to a stream
+void
+write_match_matrix_market(std::ostream& os,
+                          match_matrix_t const& mm,
+                          std::vector<vital::frame_id_t> const& frames)
+{
+  os << market_banner << " matrix coordinate integer general" << std::endl;
+  for (size_t i = 0; i < frames.size(); i += market_frames_per_line)
+  {
+    os << market_frames;
+    size_t const end = std::min(i + market_frames_per_line, frames.size());
+    for (size_t j = i; j < end; ++j)
+    {
+      os << " " << frames[j];
+    }
+    os << std::endl;
+  }
+  os << mm.rows() << " " << mm.cols() << " " << mm.nonZeros() << std::endl;
+
+  for (int k = 0; k < mm.outerSize(); ++k)
+  {
+    for (match_matrix_t::InnerIterator it(mm, k); it; ++it)
+    {
+      os << it.row() + 1 << " " << it.col() + 1 << " " << it.value() << "\n";
+    }
+  }
+  os.flush();
+}
+
+
+/// Read a match matrix in Matrix Market coordinate format from a stream
+void
+read_match_matrix_market(std::istream& is,
+                         match_matrix_t& mm,
+                         std::vector<vital::frame_id_t>& frames)
+{
+  std::string line;
+  if (!std::getline(is, line) ||
+      line.compare(0, market_banner.size(), market_banner) != 0)
+  {
+    throw vital::invalid_data("Not a Matrix Market file");
+  }
+  std::string banner, object, format, field, symmetry;
+  std::istringstream ss(ST::LowerCase(line));
+  ss >> banner >> object >> format >> field >> symmetry;
+  if (object != "matrix" || format != "coordinate" ||
+      field == "complex" || field == "pattern")
+  {
+    throw vital::invalid_data("Unsupported Matrix Market matrix type: " + line);
+  }
+  bool const symmetric = (symmetry == "symmetric");
+
+  // Collect frame numbers from the comments preceding the size line
+  frames.clear();
+  bool have_size = false;
+  while (std::getline(is, line))
+  {
+    if (line.compare(0, market_frames.size(), market_frames) == 0)
+    {
+      std::istringstream fs(line.substr(market_frames.size()));
+      vital::frame_id_t f;
+      while (fs >> f)
+      {
+        frames.push_back(f);
+      }
+      continue;
+    }
+    auto const pos = line.find_first_not_of(" \t\r");
+    if (pos != std::string::npos && line[pos] != '%')
+    {
+      have_size = true;
+      break;
+    }
+  }
+
+  size_t rows = 0, cols = 0, num_nonzeros = 0;
+  std::istringstream size(line);
+  if (!have_size || !(size >> rows >> cols >> num_nonzeros) || rows != cols)
+  {
+    throw vital::invalid_data("Invalid Matrix Market size line "
+                              "(expected a square matrix): " + line);
+  }
+
+  std::vector<triplet_t> triplets;
+  triplets.reserve(symmetric ? 2 * num_nonzeros : num_nonzeros);
+  size_t count = 0;
+  long long row, col;
+  double value;
+  while (is >> row >> col >> value)
+  {
+    if (row < 1 || col < 1 ||
+        row > static_cast<long long>(rows) ||
+        col > static_cast<long long>(cols) || value < 0.0)
+    {
+      throw vital::invalid_data("Matrix Market entry out of range");
+    }
+    unsigned int const v = static_cast<unsigned int>(std::floor(value + 0.5));
+    int const r = static_cast<int>(row - 1);
+    int const c = static_cast<int>(col - 1);
+    triplets.push_back(triplet_t(r, c, v));
+    if (symmetric && r != c)
+    {
+      triplets.push_back(triplet_t(c, r, v));
+    }
+    ++count;
+  }
+  if (count != num_nonzeros)
+  {
+    throw vital::invalid_data("Matrix Market entry count does not match "
+                              "the size line");
+  }
+
+  if (frames.empty())
+  {
+    frames.resize(rows);
+    for (size_t i = 0; i < rows; ++i)
+    {
+      frames[i] = static_cast<vital::frame_id_t>(i);
+    }
+  }
+  else if (frames.size() != rows)
+  {
+    throw vital::invalid_data("Matrix Market frame number count does not "
+                              "match the matrix size");
+  }
+
+  mm = match_matrix_t(static_cast<int>(rows), static_cast<int>(cols));
+  mm.setFromTriplets(triplets.begin(), triplets.end());
+}
+
+
+/// Write a match matrix to a file
+void
+write_match_matrix_file(match_matrix_t const& mm,
+                        std::vector<vital::frame_id_t> const& frames,
+                        vital::path_t const& file_path,
+                        std::string const& format)
+{
+  std::string fmt = format;
+  if (fmt.empty())
+  {
+    std::string const ext =
+      ST::LowerCase(ST::GetFilenameLastExtension(file_path));
+    fmt = (ext == ".csr") ? "csr" : (ext == ".mtx") ? "mtx" : "triplets";
+  }
+  if (fmt != "csr" && fmt != "mtx" && fmt != "triplets")
+  {
+    throw vital::invalid_value("Unknown match matrix format: " + fmt);
+  }
+
+  bool const binary = (fmt == "csr");
+  std::ofstream ofs(file_path.c_str(), binary ? std::ios::out | std::ios::binary
+                                              : std::ios::out);
+  if (!ofs)
+  {
+    throw vital::file_write_exception(file_path, "Could not open file for writing");
+  }
+  if (binary)
+  {
+    write_match_matrix_csr(ofs, mm, frames);
+  }
+  else if (fmt == "mtx")
+  {
+    write_match_matrix_market(ofs, mm, frames);
+  }
+  else
+  {
+    write_match_matrix_triplets(ofs, mm, frames);
+  }
+  if (!ofs)
+  {
+    throw vital::file_write_exception(file_path, "Could not write match matrix");
+  }
+}
+
+
+/// Read a match matrix from a file in any of the supported formats
+void
+read_match_matrix_file(vital::path_t const& file_path,
+                       match_matrix_t& mm,
+                       std::vector<vital::frame_id_t>& frames)
+{
+  if (!ST::FileExists(file_path))
+  {
+    throw vital::file_not_found_exception(file_path, "File does not exist.");
+  }
+
+  std::ifstream ifs(file_path.c_str(), std::ios::in | std::ios::binary);
+  if (!ifs)
+  {
+    throw vital::file_not_read_exception(file_path, "Could not open file for reading");
+  }
+
+  // Detect the format from the leading bytes rather than the extension
+  char magic[sizeof(csr_magic)] = {};
+  ifs.read(magic, sizeof(magic));
+  size_t const num_read = static_cast<size_t>(ifs.gcount());
+  ifs.clear();
+  ifs.seekg(0);
+
+  try
+  {
+    if (num_read == sizeof(csr_magic) &&
+        std::memcmp(magic, csr_magic, sizeof(csr_magic)) == 0)
+    {
+      read_match_matrix_csr(ifs, mm, frames);
+    }
+    else if (std::string(magic, num_read).compare(0, 2, "%%") == 0)
+    {
+      read_match_matrix_market(ifs, mm, frames);
+    }
+    else
+    {
+      read_match_matrix_triplets(ifs, mm, frames);
+    }
+  }
+  catch (vital::invalid_data const& e)
+  {
+    throw vital::invalid_file(file_path, e.what());
+  }
+}
+
+
+} // end namespace maptk
+} // end namespace kwiver
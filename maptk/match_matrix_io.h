@@ -0,0 +1,186 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief File IO functions for sparse match matrices
+ *
+ * A match matrix is a symmetric sparse matrix where entry (i, j) holds the
+ * number of tracks shared by frames i and j, and the diagonal holds the
+ * number of track states on each frame.  Rows and columns are indexed into
+ * a parallel vector of frame numbers.  Three sparse file formats are
+ * supported, each of which preserves the frame numbers.
+ *
+ * The text triplet format (.txt or any other extension) is:
+ *
+ *    # optional comment lines
+ *    num_frames num_nonzeros
+ *    frame_0 frame_1 ... frame_N-1
+ *    row col count
+ *    row col count
+ *    ...
+ *
+ * where row and col are zero-based indices into the frame number list.
+ *
+ * The binary compressed sparse row format (.csr) is, in host byte order:
+ *
+ *    char[8]                 "MAPTKCSR"
+ *    uint32                  format version (1)
+ *    uint32                  reserved (0)
+ *    uint64                  num_frames
+ *    uint64                  num_nonzeros
+ *    int64[num_frames]       frame numbers
+ *    uint64[num_frames + 1]  row offsets into the arrays below
+ *    uint32[num_nonzeros]    column indices
+ *    uint32[num_nonzeros]    values
+ *
+ * The Matrix Market coordinate format (.mtx) uses one-based indices as
+ * required by that format.  Frame numbers are stored in "% frames:" comment
+ * lines following the banner, which other Matrix Market readers ignore.
+ */
+
+#ifndef MAPTK_MATCH_MATRIX_IO_H_
+#define MAPTK_MATCH_MATRIX_IO_H_
+
+
+#include <vital/vital_config.h>
+#include <maptk/maptk_export.h>
+
+#include <vital/vital_types.h>
+
+#include <Eigen/SparseCore>
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+namespace kwiver {
+namespace maptk {
+
+
+/// Write a match matrix as text triplets to a stream
+MAPTK_EXPORT
+void
+write_match_matrix_triplets(std::ostream& os,
+                            Eigen::SparseMatrix<unsigned int> const& mm,
+                            std::vector<vital::frame_id_t> const& frames);
+
+
+/// Read a match matrix in text triplet format from a stream
+/**
+ * \throws vital::invalid_data if the stream is not a valid triplet file
+ */
+MAPTK_EXPORT
+void
+read_match_matrix_triplets(std::istream& is,
+                           Eigen::SparseMatrix<unsigned int>& mm,
+                           std::vector<vital::frame_id_t>& frames);
+
+
+/// Write a match matrix in binary compressed sparse row format to a stream
+MAPTK_EXPORT
+void
+write_match_matrix_csr(std::ostream& os,
+                       Eigen::SparseMatrix<unsigned int> const& mm,
+                       std::vector<vital::frame_id_t> const& frames);
+
+
+/// Read a match matrix in binary compressed sparse row format from a stream
+/**
+ * \throws vital::invalid_data if the stream is not a valid CSR file
+ */
+MAPTK_EXPORT
+void
+read_match_matrix_csr(std::istream& is,
+                      Eigen::SparseMatrix<unsigned int>& mm,
+                      std::vector<vital::frame_id_t>& frames);
+
+
+/// Write a match matrix in Matrix Market coordinate format to a stream
+MAPTK_EXPORT
+void
+write_match_matrix_market(std::ostream& os,
+                          Eigen::SparseMatrix<unsigned int> const& mm,
+                          std::vector<vital::frame_id_t> const& frames);
+
+
+/// Read a match matrix in Matrix Market coordinate format from a stream
+/**
+ * Files without "% frames:" comments, such as those written by other tools,
+ * get the frame numbers 0 to N-1.
+ *
+ * \throws vital::invalid_data if the stream is not a valid coordinate
+ *         Matrix Market file with a square matrix
+ */
+MAPTK_EXPORT
+void
+read_match_matrix_market(std::istream& is,
+                         Eigen::SparseMatrix<unsigned int>& mm,
+                         std::vector<vital::frame_id_t>& frames);
+
+
+/// Write a match matrix to a file
+/**
+ * \p format is one of "triplets", "csr" or "mtx".  If it is empty, files
+ * ending in ".csr" are written in binary CSR format, files ending in ".mtx"
+ * in Matrix Market format, and all others as text triplets.
+ *
+ * \throws vital::invalid_value if \p format is not recognized
+ * \throws vital::file_write_exception if the file could not be written
+ */
+MAPTK_EXPORT
+void
+write_match_matrix_file(Eigen::SparseMatrix<unsigned int> const& mm,
+                        std::vector<vital::frame_id_t> const& frames,
+                        vital::path_t const& file_path,
+                        std::string const& format = std::string());
+
+
+/// Read a match matrix from a file in any of the supported formats
+/**
+ * The format is detected from the file contents, not the extension: CSR
+ * files start with "MAPTKCSR", Matrix Market files with "%%MatrixMarket",
+ * and anything else is read as text triplets.  Dense text matrices, as
+ * printed by the match matrix tool with "--matrix-format dense", cannot be
+ * read and are reported as invalid files.
+ */
+MAPTK_EXPORT
+void
+read_match_matrix_file(vital::path_t const& file_path,
+                       Eigen::SparseMatrix<unsigned int>& mm,
+                       std::vector<vital::frame_id_t>& frames);
+
+
+} // end namespace maptk
+} // end namespace kwiver
+
+
+#endif // MAPTK_MATCH_MATRIX_IO_H_
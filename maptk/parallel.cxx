@@ -0,0 +1,199 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Implementation of maptk::parallel helper functions
+ */
+
+#include "parallel.h"
+
+#include <vital/vital_foreach.h>
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace kwiver {
+namespace maptk {
+
+namespace {
+
+/// Collects the first exception thrown by any of a set of worker threads
+class exception_collector
+{
+public:
+  exception_collector() : failed_(false) {}
+
+  /// Record the exception currently being handled
+  void capture()
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!error_)
+    {
+      error_ = std::current_exception();
+    }
+    failed_ = true;
+  }
+
+  /// Return true if any exception has been captured
+  bool failed() const { return failed_; }
+
+  /// Rethrow the captured exception, if any
+  void rethrow() const
+  {
+    if (error_)
+    {
+      std::rethrow_exception(error_);
+    }
+  }
+
+private:
+  std::mutex mutex_;
+  std::exception_ptr error_;
+  std::atomic<bool> failed_;
+};
+
+}
+
+
+/// Resolve a requested number of worker threads
+unsigned
+resolve_num_threads(unsigned requested)
+{
+  if (requested == 0)
+  {
+    requested = std::thread::hardware_concurrency();
+  }
+  return std::max(requested, 1u);
+}
+
+
+/// Apply a function to contiguous chunks of an index range in parallel
+void
+parallel_for_chunks(size_t n, unsigned num_threads,
+                    std::function<void(size_t, size_t)> const& func)
+{
+  if (n == 0)
+  {
+    return;
+  }
+  size_t const num_chunks =
+    std::min(static_cast<size_t>(resolve_num_threads(num_threads)), n);
+  if (num_chunks == 1)
+  {
+    func(0, n);
+    return;
+  }
+
+  exception_collector errors;
+  std::vector<std::thread> workers;
+  workers.reserve(num_chunks);
+  for (size_t c = 0; c < num_chunks; ++c)
+  {
+    size_t const begin = (n * c) / num_chunks;
+    size_t const end = (n * (c + 1)) / num_chunks;
+    workers.emplace_back([&func, &errors, begin, end]()
+    {
+      try
+      {
+        func(begin, end);
+      }
+      catch (...)
+      {
+        errors.capture();
+      }
+    });
+  }
+  VITAL_FOREACH (auto& w, workers)
+  {
+    w.join();
+  }
+  errors.rethrow();
+}
+
+
+/// Apply a function to every index of a range in parallel
+void
+parallel_for(size_t n, unsigned num_threads,
+             std::function<void(size_t)> const& func)
+{
+  if (n == 0)
+  {
+    return;
+  }
+  size_t const num_workers =
+    std::min(static_cast<size_t>(resolve_num_threads(num_threads)), n);
+  if (num_workers == 1)
+  {
+    for (size_t i = 0; i < n; ++i)
+    {
+      func(i);
+    }
+    return;
+  }
+
+  exception_collector errors;
+  std::atomic<size_t> next(0);
+  auto worker = [&]()
+  {
+    for (size_t i = next++; i < n && !errors.failed(); i = next++)
+    {
+      try
+      {
+        func(i);
+      }
+      catch (...)
+      {
+        errors.capture();
+      }
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(num_workers);
+  for (size_t t = 0; t < num_workers; ++t)
+  {
+    workers.emplace_back(worker);
+  }
+  VITAL_FOREACH (auto& w, workers)
+  {
+    w.join();
+  }
+  errors.rethrow();
+}
+
+
+} // end namespace maptk
+} // end namespace kwiver
@@ -0,0 +1,96 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Header for maptk::parallel helper functions for multi-threaded loops
+ */
+
+#ifndef MAPTK_PARALLEL_H_
+#define MAPTK_PARALLEL_H_
+
+#include <maptk/maptk_export.h>
+
+#include <cstddef>
+#include <functional>
+
+
+namespace kwiver {
+namespace maptk {
+
+
+/// Resolve a requested number of worker threads
+/**
+ * \param [in] requested the number of threads requested, or zero to use the
+ *             number of hardware threads available
+ * \return the number of threads to use, always at least one
+ */
+MAPTK_EXPORT
+unsigned resolve_num_threads(unsigned requested);
+
+
+/// Apply a function to contiguous chunks of an index range in parallel
+/**
+ * The range [0, \p n) is split into at most \p num_threads contiguous chunks
+ * of nearly equal size and \p func is called once per chunk, each on its own
+ * thread.  If any call throws, the first exception is rethrown after all
+ * threads have finished.
+ *
+ *  \param [in] n the number of indices to process
+ *  \param [in] num_threads the number of threads (zero for hardware threads)
+ *  \param [in] func function called as func(begin, end) for each chunk
+ */
+MAPTK_EXPORT
+void parallel_for_chunks(size_t n, unsigned num_threads,
+                         std::function<void(size_t, size_t)> const& func);
+
+
+/// Apply a function to every index of a range in parallel
+/**
+ * Indices in [0, \p n) are handed out one at a time, in increasing order, to
+ * a pool of \p num_threads workers, so at most \p num_threads calls are in
+ * flight at once.  This suits loops where each item has a large and variable
+ * cost (e.g. image I/O).  If any call throws, no further indices are handed
+ * out and the first exception is rethrown after all threads have finished.
+ *
+ *  \param [in] n the number of indices to process
+ *  \param [in] num_threads the number of threads (zero for hardware threads)
+ *  \param [in] func function called as func(index) for each index
+ */
+MAPTK_EXPORT
+void parallel_for(size_t n, unsigned num_threads,
+                  std::function<void(size_t)> const& func);
+
+
+} // end namespace maptk
+} // end namespace kwiver
+
+
+#endif // MAPTK_PARALLEL_H_
@@ -0,0 +1,343 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Implementation of selective plugin loading
+ */
+
+#include "plugin_registry.h"
+
+#include <maptk/config_cache.h>
+
+#include <vital/plugin_loader/plugin_factory.h>
+#include <vital/plugin_loader/plugin_loader.h>
+#include <vital/plugin_loader/plugin_manager.h>
+#include <vital/vital_foreach.h>
+
+#include <kwiversys/Directory.hxx>
+#include <kwiversys/DynamicLoader.hxx>
+#include <kwiversys/SystemTools.hxx>
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <random>
+#include <sstream>
+
+
+namespace kwiver {
+namespace maptk {
+
+typedef kwiversys::SystemTools     ST;
+
+namespace {
+
+char const registry_header[] = "# MAP-Tk plugin registry v1";
+
+/// A plugin module file and the implementations it registers
+struct module_record
+{
+  long mtime;
+  std::set<std::string> impl_names;
+};
+
+/// Plugin modules by file path
+typedef std::map<vital::path_t, module_record> registry_t;
+
+/// Modules loaded so far by load_plugins_providing()
+std::set<vital::path_t> loaded_modules;
+
+/// Whether load_plugins_providing() has loaded all plugins
+bool loaded_all = false;
+
+/// List the plugin modules in the search path with their modification times
+registry_t
+list_modules(vital::path_list_t const& search_path)
+{
+  std::string const ext = kwiversys::DynamicLoader::LibExtension();
+  registry_t modules;
+  VITAL_FOREACH (auto const& dir_path, search_path)
+  {
+    kwiversys::Directory dir;
+    if (!dir.Load(dir_path))
+    {
+      continue;
+    }
+    for (unsigned long i = 0; i < dir.GetNumberOfFiles(); ++i)
+    {
+      std::string const name = dir.GetFile(i);
+      if (name.size() <= ext.size() ||
+          name.compare(name.size() - ext.size(), ext.size(), ext) != 0)
+      {
+        continue;
+      }
+      vital::path_t const path = dir_path + "/" + name;
+      modules[path].mtime = ST::ModifiedTime(path);
+    }
+  }
+  return modules;
+}
+
+/// Read a registry file
+/**
+ * Each module is a line "M <mtime> <path>", followed by one line
+ * "I <implementation name>" for each implementation it registers.
+ */
+bool
+read_registry(vital::path_t const& file_path, registry_t& registry)
+{
+  std::ifstream ifs(file_path.c_str());
+  std::string line;
+  if (!ifs || !std::getline(ifs, line) || line != registry_header)
+  {
+    return false;
+  }
+  module_record* current = nullptr;
+  while (std::getline(ifs, line))
+  {
+    if (line.size() < 3 || line[1] != ' ')
+    {
+      return false;
+    }
+    if (line[0] == 'M')
+    {
+      std::istringstream ss(line.substr(2));
+      long mtime;
+      std::string path;
+      if (!(ss >> mtime) || !std::getline(ss >> std::ws, path))
+      {
+        return false;
+      }
+      current = &registry[path];
+      current->mtime = mtime;
+    }
+    else if (line[0] == 'I' && current)
+    {
+      current->impl_names.insert(line.substr(2));
+    }
+    else
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Write a registry file, replacing any existing file
+void
+write_registry(vital::path_t const& file_path, registry_t const& registry)
+{
+  vital::path_t const dir = ST::GetFilenamePath(file_path);
+  if (!dir.empty() && !ST::MakeDirectory(dir))
+  {
+    return;
+  }
+  // write to a uniquely named file, then rename it into place so concurrent
+  // readers never see a partial file and concurrent writers do not collide
+  std::random_device rd;
+  std::ostringstream tmp_name;
+  tmp_name << file_path << "." << std::hex << rd() << ".tmp";
+  vital::path_t const tmp_path = tmp_name.str();
+  {
+    std::ofstream ofs(tmp_path.c_str());
+    if (!ofs)
+    {
+      return;
+    }
+    ofs << registry_header << "\n";
+    VITAL_FOREACH (auto const& m, registry)
+    {
+      ofs << "M " << m.second.mtime << " " << m.first << "\n";
+      VITAL_FOREACH (auto const& name, m.second.impl_names)
+      {
+        ofs << "I " << name << "\n";
+      }
+    }
+    ofs.close();
+    if (!ofs)
+    {
+      std::remove(tmp_path.c_str());
+      return;
+    }
+  }
+  if (std::rename(tmp_path.c_str(), file_path.c_str()) != 0)
+  {
+    std::remove(tmp_path.c_str());
+  }
+}
+
+/// Record the implementations registered by each loaded module
+void
+add_loaded_factories(registry_t& registry)
+{
+  auto& vpm = vital::plugin_manager::instance();
+  VITAL_FOREACH (auto const& interface, vpm.plugin_map())
+  {
+    VITAL_FOREACH (auto const& fact, interface.second)
+    {
+      std::string name, file;
+      if (fact->get_attribute(vital::plugin_factory::PLUGIN_NAME, name) &&
+          fact->get_attribute(vital::plugin_factory::PLUGIN_FILE_NAME, file))
+      {
+        auto const it = registry.find(file);
+        if (it != registry.end())
+        {
+          it->second.impl_names.insert(name);
+        }
+      }
+    }
+  }
+}
+
+/// Check that a registry describes the same modules as the search path
+bool
+is_current(registry_t const& registry, registry_t const& modules)
+{
+  if (registry.size() != modules.size())
+  {
+    return false;
+  }
+  auto r = registry.begin();
+  VITAL_FOREACH (auto const& m, modules)
+  {
+    if (r->first != m.first || r->second.mtime != m.second.mtime)
+    {
+      return false;
+    }
+    ++r;
+  }
+  return true;
+}
+
+}
+
+
+/// Collect the algorithm implementation names requested by a configuration
+std::set<std::string>
+algorithm_types(vital::config_block_sptr const& config)
+{
+  std::string const type_key = "type";
+  std::string const suffix = vital::config_block::block_sep + type_key;
+  std::set<std::string> names;
+  VITAL_FOREACH (auto const& key, config->available_values())
+  {
+    bool const is_type =
+      key == type_key ||
+      (key.size() > suffix.size() &&
+       key.compare(key.size() - suffix.size(), suffix.size(), suffix) == 0);
+    if (is_type)
+    {
+      std::string const value = config->get_value<std::string>(key, "");
+      if (!value.empty())
+      {
+        names.insert(value);
+      }
+    }
+  }
+  return names;
+}
+
+
+/// Default location of the plugin registry cache file
+vital::path_t
+plugin_registry_path()
+{
+  std::string path;
+  if (ST::GetEnv("MAPTK_PLUGIN_REGISTRY", path))
+  {
+    return path;
+  }
+  path = user_cache_directory();
+  return path.empty() ? path : path + "/plugin_registry.txt";
+}
+
+
+/// Load only the plugin modules providing the given implementations
+bool
+load_plugins_providing(std::set<std::string> const& impl_names,
+                       vital::path_t const& registry_file)
+{
+  auto& vpm = vital::plugin_manager::instance();
+  if (loaded_all)
+  {
+    return false;
+  }
+  if (registry_file.empty())
+  {
+    vpm.load_all_plugins();
+    loaded_all = true;
+    return true;
+  }
+
+  registry_t modules = list_modules(vpm.search_path());
+  registry_t registry;
+  if (read_registry(registry_file, registry) && is_current(registry, modules))
+  {
+    bool loaded_new = false;
+    VITAL_FOREACH (auto const& m, registry)
+    {
+      bool needed = false;
+      VITAL_FOREACH (auto const& name, impl_names)
+      {
+        needed = needed || m.second.impl_names.count(name);
+      }
+      if (needed && loaded_modules.insert(m.first).second)
+      {
+        vpm.get_loader()->load_plugin(m.first);
+        loaded_new = true;
+      }
+    }
+    return loaded_new;
+  }
+
+  // The registry is missing or stale: load everything once and record which
+  // module provides what for next time.
+  vpm.load_all_plugins();
+  loaded_all = true;
+  add_loaded_factories(modules);
+  write_registry(registry_file, modules);
+  return true;
+}
+
+
+/// Load only the plugin modules needed by a tool configuration
+bool
+load_plugins_for_config(vital::config_block_sptr const& config,
+                        std::vector<std::string> const& extra_names)
+{
+  std::set<std::string> names = algorithm_types(config);
+  names.insert(extra_names.begin(), extra_names.end());
+  return load_plugins_providing(names);
+}
+
+
+} // end namespace maptk
+} // end namespace kwiver
@@ -0,0 +1,121 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Header for selective plugin loading with a cached plugin registry
+ */
+
+#ifndef MAPTK_PLUGIN_REGISTRY_H_
+#define MAPTK_PLUGIN_REGISTRY_H_
+
+
+#include <vital/vital_config.h>
+#include <maptk/maptk_export.h>
+
+#include <vital/config/config_block.h>
+#include <vital/vital_types.h>
+
+#include <set>
+#include <string>
+#include <vector>
+
+
+namespace kwiver {
+namespace maptk {
+
+
+/// Collect the algorithm implementation names requested by a configuration
+/**
+ * Returns the non-empty value of every "type" key, at any nesting level.
+ * Some of these may not name algorithm implementations (e.g. OpenCV
+ * detector type names); callers should ignore names that no plugin provides.
+ */
+MAPTK_EXPORT
+std::set<std::string>
+algorithm_types(vital::config_block_sptr const& config);
+
+
+/// Default location of the plugin registry cache file
+/**
+ * This is the MAPTK_PLUGIN_REGISTRY environment variable if set, otherwise
+ * plugin_registry.txt in user_cache_directory().  An empty path
+ * means no cache is used.
+ */
+MAPTK_EXPORT
+vital::path_t
+plugin_registry_path();
+
+
+/// Load only the plugin modules providing the given implementations
+/**
+ * Uses a registry file that maps each plugin module in the plugin search
+ * path to the algorithm implementations it registers.  The registry records
+ * the modification time of every module and is rebuilt, by loading all
+ * plugins once, if any module was added, removed or changed.  Names no
+ * module provides are ignored.  If the registry cannot be used, all plugins
+ * are loaded, so this is never less capable than load_all_plugins().
+ *
+ * Modules already loaded by a previous call are not loaded again.
+ *
+ * \param impl_names algorithm implementation names (algorithm "type" values)
+ * \param registry_file registry cache file, or empty to always load all
+ * \return true if any module was loaded by this call
+ */
+MAPTK_EXPORT
+bool
+load_plugins_providing(std::set<std::string> const& impl_names,
+                       vital::path_t const& registry_file = plugin_registry_path());
+
+
+/// Load only the plugin modules needed by a tool configuration
+/**
+ * Equivalent to load_plugins_providing() with the algorithm_types() of
+ * \p config plus \p extra_names, for implementations a tool creates
+ * directly rather than through its configuration.
+ *
+ * Configuring an algorithm can add the "type" keys of its nested
+ * algorithms, so tools call this again after configuring their algorithms
+ * and repeat the configuration while it returns true.
+ *
+ * \return true if any module was loaded by this call
+ */
+MAPTK_EXPORT
+bool
+load_plugins_for_config(vital::config_block_sptr const& config,
+                        std::vector<std::string> const& extra_names =
+                          std::vector<std::string>());
+
+
+} // end namespace maptk
+} // end namespace kwiver
+
+
+#endif // MAPTK_PLUGIN_REGISTRY_H_
@@ -0,0 +1,438 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Implementation of maptk::track_statistics column-oriented analytics
+ */
+
+#include "track_statistics.h"
+
+#include <vital/exceptions.h>
+#include <vital/vital_foreach.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <string>
+
+
+namespace kwiver {
+namespace maptk {
+
+namespace {
+
+/// Measures reprojection error of track states against cameras and landmarks
+class reprojection_measure
+{
+public:
+  reprojection_measure(vital::camera_map_sptr cameras,
+                       vital::landmark_map_sptr landmarks)
+    : last_tid_(std::numeric_limits<vital::track_id_t>::min())
+  {
+    if (!cameras || !landmarks)
+    {
+      return;
+    }
+    // flatten the cameras into an array indexed by frame
+    VITAL_FOREACH (auto const& c, cameras->cameras())
+    {
+      if (c.first < 0)
+      {
+        continue;
+      }
+      auto const f = static_cast<size_t>(c.first);
+      if (f >= cameras_.size())
+      {
+        cameras_.resize(f + 1);
+      }
+      cameras_[f] = c.second;
+    }
+    landmarks_ = landmarks->landmarks();
+  }
+
+  /// Return true if cameras and landmarks were both provided
+  bool enabled() const { return !cameras_.empty() && !landmarks_.empty(); }
+
+  /// Compute the reprojection error of a state, if possible
+  bool error(vital::track_id_t tid, vital::frame_id_t fid,
+             vital::vector_2d const& loc, double& err)
+  {
+    if (fid < 0 || static_cast<size_t>(fid) >= cameras_.size() ||
+        !cameras_[fid])
+    {
+      return false;
+    }
+    if (tid != last_tid_)
+    {
+      last_tid_ = tid;
+      auto const lmi = landmarks_.find(static_cast<vital::landmark_id_t>(tid));
+      last_lm_ = (lmi == landmarks_.end()) ? vital::landmark_sptr() : lmi->second;
+    }
+    if (!last_lm_)
+    {
+      return false;
+    }
+    err = (cameras_[fid]->project(last_lm_->loc()) - loc).norm();
+    return true;
+  }
+
+private:
+  std::vector<vital::camera_sptr> cameras_;
+  vital::landmark_map::map_landmark_t landmarks_;
+  vital::track_id_t last_tid_;
+  vital::landmark_sptr last_lm_;
+};
+
+}
+
+
+/// Constructor
+track_columns
+::track_columns()
+  : frame_offset_(0),
+    num_states_(0),
+    last_slot_(0)
+{
+}
+
+
+/// Add a single track state
+void
+track_columns
+::add_state(vital::track_id_t tid, vital::frame_id_t fid)
+{
+  if (fid < 0)
+  {
+    throw vital::invalid_value("Track states must have non-negative frame ids");
+  }
+
+  size_t slot = last_slot_;
+  if (slot >= track_id_.size() || track_id_[slot] != tid)
+  {
+    auto const si = slot_.find(tid);
+    if (si == slot_.end())
+    {
+      slot = track_id_.size();
+      slot_[tid] = slot;
+      track_id_.push_back(tid);
+      first_frame_.push_back(fid);
+      last_frame_.push_back(fid);
+      length_.push_back(0);
+    }
+    else
+    {
+      slot = si->second;
+    }
+    last_slot_ = slot;
+  }
+
+  first_frame_[slot] = std::min(first_frame_[slot], fid);
+  last_frame_[slot] = std::max(last_frame_[slot], fid);
+  ++length_[slot];
+
+  // per-frame counts start at the earliest frame seen; when an earlier frame
+  // arrives, grow the front by at least the current size so that frames
+  // arriving in decreasing order do not shift the counts every time
+  if (frame_states_.empty())
+  {
+    frame_offset_ = fid;
+  }
+  else if (fid < frame_offset_)
+  {
+    auto const grow = std::max(frame_offset_ - fid,
+                               static_cast<vital::frame_id_t>(frame_states_.size()));
+    auto const offset = std::max(frame_offset_ - grow, vital::frame_id_t(0));
+    frame_states_.insert(frame_states_.begin(),
+                         static_cast<size_t>(frame_offset_ - offset), 0);
+    frame_offset_ = offset;
+  }
+
+  size_t const fi = static_cast<size_t>(fid - frame_offset_);
+  if (fi >= frame_states_.size())
+  {
+    frame_states_.resize(fi + 1, 0);
+  }
+  ++frame_states_[fi];
+  ++num_states_;
+}
+
+
+/// Summarize a track file into columns without building track objects
+track_columns
+read_track_file_columns(vital::path_t const& file_path,
+                        vital::camera_map_sptr cameras,
+                        vital::landmark_map_sptr landmarks)
+{
+  std::ifstream ifs(file_path.c_str());
+  if (!ifs)
+  {
+    throw vital::file_not_found_exception(file_path, "Could not open track file");
+  }
+
+  reprojection_measure measure(cameras, landmarks);
+  bool const measure_error = measure.enabled();
+
+  track_columns columns;
+  for (std::string line; std::getline(ifs, line); )
+  {
+    // each line begins: track_id frame_id feature_x feature_y ...
+    char const* p = line.c_str();
+    char* end;
+    long long const tid = std::strtoll(p, &end, 10);
+    if (end == p)
+    {
+      continue;
+    }
+    p = end;
+    unsigned long long const fid = std::strtoull(p, &end, 10);
+    if (end == p)
+    {
+      throw vital::invalid_data("Track state is missing a frame number: " + line);
+    }
+    columns.add_state(static_cast<vital::track_id_t>(tid),
+                      static_cast<vital::frame_id_t>(fid));
+
+    if (measure_error)
+    {
+      p = end;
+      double const x = std::strtod(p, &end);
+      p = end;
+      double const y = std::strtod(p, &end);
+      double err;
+      if (end != p &&
+          measure.error(static_cast<vital::track_id_t>(tid),
+                        static_cast<vital::frame_id_t>(fid),
+                        vital::vector_2d(x, y), err))
+      {
+        columns.add_reprojection_error(err);
+      }
+    }
+  }
+  return columns;
+}
+
+
+/// Summarize an in-memory track set into columns
+track_columns
+track_set_columns(vital::track_set const& tracks,
+                  vital::camera_map_sptr cameras,
+                  vital::landmark_map_sptr landmarks)
+{
+  reprojection_measure measure(cameras, landmarks);
+  bool const measure_error = measure.enabled();
+
+  track_columns columns;
+  VITAL_FOREACH (auto const& trk, tracks.tracks())
+  {
+    VITAL_FOREACH (auto const& ts, *trk)
+    {
+      columns.add_state(trk->id(), ts.frame_id);
+
+      double err;
+      if (measure_error && ts.feat &&
+          measure.error(trk->id(), ts.frame_id, ts.feat->loc(), err))
+      {
+        columns.add_reprojection_error(err);
+      }
+    }
+  }
+  return columns;
+}
+
+
+/// Constructor
+track_statistics
+::track_statistics()
+  : num_tracks(0),
+    num_states(0),
+    first_frame(0),
+    last_frame(0),
+    mean_track_length(0.0),
+    continuity_histogram(10, 0),
+    num_reprojection_errors(0),
+    reprojection_rmse(0.0),
+    reprojection_median(0.0),
+    reprojection_p90(0.0),
+    reprojection_max(0.0)
+{
+}
+
+
+/// Compute track statistics from track columns
+track_statistics
+compute_track_statistics(track_columns const& columns)
+{
+  track_statistics stats;
+  stats.num_tracks = columns.num_tracks();
+  stats.num_states = columns.num_states();
+  if (stats.num_tracks == 0)
+  {
+    return stats;
+  }
+
+  auto const& first = columns.first_frame();
+  auto const& last = columns.last_frame();
+  auto const& length = columns.length();
+  size_t const n = stats.num_tracks;
+
+  stats.first_frame = *std::min_element(first.begin(), first.end());
+  stats.last_frame = *std::max_element(last.begin(), last.end());
+  stats.mean_track_length = static_cast<double>(stats.num_states) / n;
+
+  // length and continuity histograms
+  unsigned const max_length = *std::max_element(length.begin(), length.end());
+  stats.length_histogram.assign(max_length + 1, 0);
+  for (size_t i = 0; i < n; ++i)
+  {
+    ++stats.length_histogram[length[i]];
+
+    double const span = static_cast<double>(last[i] - first[i] + 1);
+    size_t const bin = std::min(static_cast<size_t>(10.0 * length[i] / span),
+                                size_t(9));
+    ++stats.continuity_histogram[bin];
+  }
+
+  // per-frame active, new and terminated counts
+  size_t const num_frames = stats.last_frame - stats.first_frame + 1;
+  auto const frame_states = columns.frame_states().begin() +
+                            (stats.first_frame - columns.frame_offset());
+  stats.active_tracks.assign(frame_states, frame_states + num_frames);
+  stats.new_tracks.assign(num_frames, 0);
+  stats.terminated_tracks.assign(num_frames, 0);
+  for (size_t i = 0; i < n; ++i)
+  {
+    ++stats.new_tracks[first[i] - stats.first_frame];
+    ++stats.terminated_tracks[last[i] - stats.first_frame];
+  }
+
+  // reprojection error distribution
+  std::vector<float> errors = columns.reprojection_error();
+  stats.num_reprojection_errors = errors.size();
+  if (!errors.empty())
+  {
+    double sum_sq = 0.0;
+    VITAL_FOREACH (float const e, errors)
+    {
+      sum_sq += static_cast<double>(e) * e;
+    }
+    stats.reprojection_rmse = std::sqrt(sum_sq / errors.size());
+
+    auto const nth = [&errors](double q)
+    {
+      auto const it = errors.begin() + static_cast<size_t>(q * (errors.size() - 1));
+      std::nth_element(errors.begin(), it, errors.end());
+      return static_cast<double>(*it);
+    };
+    stats.reprojection_median = nth(0.5);
+    stats.reprojection_p90 = nth(0.9);
+    stats.reprojection_max = *std::max_element(errors.begin(), errors.end());
+  }
+
+  return stats;
+}
+
+
+/// Print a human readable report of track statistics
+void
+print_track_statistics(track_statistics const& stats, std::ostream& os)
+{
+  os << "Track Set Properties" << std::endl
+     << "--------------------" << std::endl
+     << std::endl
+     << "Number of tracks          : " << stats.num_tracks << std::endl
+     << "Number of track states    : " << stats.num_states << std::endl
+     << "First frame               : " << stats.first_frame << std::endl
+     << "Last frame                : " << stats.last_frame << std::endl
+     << "Mean track length         : " << stats.mean_track_length << std::endl
+     << std::endl;
+
+  if (stats.num_tracks == 0)
+  {
+    return;
+  }
+
+  os << "Track Length Histogram" << std::endl
+     << "----------------------" << std::endl
+     << std::endl;
+  for (size_t len = 1; len < stats.length_histogram.size(); ++len)
+  {
+    if (stats.length_histogram[len] > 0)
+    {
+      os << std::setw(8) << len << " : " << stats.length_histogram[len] << std::endl;
+    }
+  }
+  os << std::endl;
+
+  os << "Track Continuity Histogram (states / frame span)" << std::endl
+     << "------------------------------------------------" << std::endl
+     << std::endl;
+  for (size_t b = 0; b < stats.continuity_histogram.size(); ++b)
+  {
+    os << "  [" << std::fixed << std::setprecision(1) << b / 10.0
+       << ", " << (b + 1) / 10.0 << (b == 9 ? "]" : ")") << " : "
+       << stats.continuity_histogram[b] << std::endl;
+  }
+  os.unsetf(std::ios_base::floatfield);
+  os << std::setprecision(6) << std::endl;
+
+  if (stats.num_reprojection_errors > 0)
+  {
+    os << "Reprojection Error (pixels)" << std::endl
+       << "---------------------------" << std::endl
+       << std::endl
+       << "Number of measurements    : " << stats.num_reprojection_errors << std::endl
+       << "RMSE                      : " << stats.reprojection_rmse << std::endl
+       << "Median                    : " << stats.reprojection_median << std::endl
+       << "90th percentile           : " << stats.reprojection_p90 << std::endl
+       << "Maximum                   : " << stats.reprojection_max << std::endl
+       << std::endl;
+  }
+
+  os << "Per-Frame Track Counts" << std::endl
+     << "----------------------" << std::endl
+     << std::endl
+     << "   Frame   Active      New Terminated" << std::endl;
+  for (size_t i = 0; i < stats.active_tracks.size(); ++i)
+  {
+    os << std::setw(8) << stats.first_frame + i
+       << std::setw(9) << stats.active_tracks[i]
+       << std::setw(9) << stats.new_tracks[i]
+       << std::setw(11) << stats.terminated_tracks[i] << std::endl;
+  }
+  os << std::endl;
+}
+
+
+} // end namespace maptk
+} // end namespace kwiver
@@ -0,0 +1,212 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Header for maptk::track_statistics column-oriented track analytics
+ */
+
+#ifndef MAPTK_TRACK_STATISTICS_H_
+#define MAPTK_TRACK_STATISTICS_H_
+
+
+#include <vital/vital_config.h>
+#include <maptk/maptk_export.h>
+
+#include <vital/types/camera_map.h>
+#include <vital/types/landmark_map.h>
+#include <vital/types/track_set.h>
+#include <vital/vital_types.h>
+
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+
+namespace kwiver {
+namespace maptk {
+
+
+/// Column-oriented summary of the states in a track set
+/**
+ * Rather than holding track objects, this class keeps one flat array per
+ * attribute: per-track arrays (id, first frame, last frame, length) indexed
+ * by track slot, and a per-frame array of state counts indexed by frame id
+ * relative to frame_offset(), so that frame numbers need not start at zero.
+ * States are added one at a time so that a track file can be summarized as
+ * it is read, without ever building the full track set in memory.
+ */
+class MAPTK_EXPORT track_columns
+{
+public:
+  /// Constructor
+  track_columns();
+
+  /// Add a single track state
+  void add_state(vital::track_id_t tid, vital::frame_id_t fid);
+
+  /// Add a reprojection error measurement, in pixels
+  void add_reprojection_error(double err)
+  {
+    reprojection_error_.push_back(static_cast<float>(err));
+  }
+
+  /// Number of distinct tracks
+  size_t num_tracks() const { return track_id_.size(); }
+
+  /// Total number of track states
+  size_t num_states() const { return num_states_; }
+
+  /// Track id of each track slot
+  std::vector<vital::track_id_t> const& track_id() const { return track_id_; }
+
+  /// First frame of each track slot
+  std::vector<vital::frame_id_t> const& first_frame() const { return first_frame_; }
+
+  /// Last frame of each track slot
+  std::vector<vital::frame_id_t> const& last_frame() const { return last_frame_; }
+
+  /// Number of states in each track slot
+  std::vector<unsigned> const& length() const { return length_; }
+
+  /// Number of states on each frame, indexed by frame id - frame_offset()
+  std::vector<unsigned> const& frame_states() const { return frame_states_; }
+
+  /// Frame id of the first entry of frame_states()
+  /**
+   * This is at most the smallest frame id added; it may be smaller, as
+   * storage is extended in blocks when an earlier frame is added.
+   */
+  vital::frame_id_t frame_offset() const { return frame_offset_; }
+
+  /// Reprojection errors of states with both a camera and a landmark
+  std::vector<float> const& reprojection_error() const { return reprojection_error_; }
+
+private:
+  std::vector<vital::track_id_t> track_id_;
+  std::vector<vital::frame_id_t> first_frame_;
+  std::vector<vital::frame_id_t> last_frame_;
+  std::vector<unsigned> length_;
+  std::vector<unsigned> frame_states_;
+  std::vector<float> reprojection_error_;
+  vital::frame_id_t frame_offset_;
+  size_t num_states_;
+
+  /// Map from track id to track slot
+  std::unordered_map<vital::track_id_t, size_t> slot_;
+  /// The most recently used slot, since states usually arrive grouped by track
+  size_t last_slot_;
+};
+
+
+/// Summarize a track file into columns without building track objects
+/**
+ * The file is streamed one line at a time and only the track id, frame id
+ * and (if needed) feature location of each state are parsed.
+ *
+ *  \param [in] file_path path to a track file as written by
+ *              vital::write_track_file
+ *  \param [in] cameras optional cameras used to measure reprojection error
+ *  \param [in] landmarks optional landmarks, with ids matching track ids,
+ *              used to measure reprojection error
+ *  \return the column summary of the tracks in the file
+ */
+MAPTK_EXPORT
+track_columns
+read_track_file_columns(vital::path_t const& file_path,
+                        vital::camera_map_sptr cameras = vital::camera_map_sptr(),
+                        vital::landmark_map_sptr landmarks = vital::landmark_map_sptr());
+
+
+/// Summarize an in-memory track set into columns
+MAPTK_EXPORT
+track_columns
+track_set_columns(vital::track_set const& tracks,
+                  vital::camera_map_sptr cameras = vital::camera_map_sptr(),
+                  vital::landmark_map_sptr landmarks = vital::landmark_map_sptr());
+
+
+/// Statistics computed from track columns
+struct MAPTK_EXPORT track_statistics
+{
+  track_statistics();
+
+  /// Number of tracks
+  size_t num_tracks;
+  /// Number of track states
+  size_t num_states;
+  /// First frame with any track state
+  vital::frame_id_t first_frame;
+  /// Last frame with any track state
+  vital::frame_id_t last_frame;
+  /// Mean number of states per track
+  double mean_track_length;
+
+  /// Number of tracks of each length, indexed by length
+  std::vector<size_t> length_histogram;
+  /// Number of tracks with a state on each frame, from first_frame
+  std::vector<size_t> active_tracks;
+  /// Number of tracks starting on each frame, from first_frame
+  std::vector<size_t> new_tracks;
+  /// Number of tracks ending on each frame, from first_frame
+  std::vector<size_t> terminated_tracks;
+  /// Histogram of track continuity (length over frame span) in ten bins
+  std::vector<size_t> continuity_histogram;
+
+  /// Number of reprojection error measurements
+  size_t num_reprojection_errors;
+  /// Root mean square reprojection error
+  double reprojection_rmse;
+  /// Median reprojection error
+  double reprojection_median;
+  /// 90th percentile reprojection error
+  double reprojection_p90;
+  /// Maximum reprojection error
+  double reprojection_max;
+};
+
+
+/// Compute track statistics from track columns
+MAPTK_EXPORT
+track_statistics
+compute_track_statistics(track_columns const& columns);
+
+
+/// Print a human readable report of track statistics
+MAPTK_EXPORT
+void
+print_track_statistics(track_statistics const& stats, std::ostream& os);
+
+
+} // end namespace maptk
+} // end namespace kwiver
+
+
+#endif // MAPTK_TRACK_STATISTICS_H_
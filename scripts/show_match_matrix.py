@@ -37,7 +37,55 @@ from optparse import OptionParser
 import matplotlib.pyplot as plt
 import numpy as np
 import scipy.io as sio
-import os
+import scipy.sparse as sp
+
+
+def read_csr_match_matrix(filename):
+    """Read a binary CSR match matrix written by maptk_match_matrix
+
+    Returns the sparse matrix and the array of frame numbers
+    """
+    with open(filename, "rb") as f:
+        if f.read(8) != b"MAPTKCSR":
+            raise ValueError("%s is not a MAP-Tk CSR match matrix" % filename)
+        version, _ = np.fromfile(f, dtype=np.uint32, count=2)
+        if version != 1:
+            raise ValueError("unsupported CSR match matrix version %d" % version)
+        num_frames, nnz = np.fromfile(f, dtype=np.uint64, count=2)
+        frames = np.fromfile(f, dtype=np.int64, count=int(num_frames))
+        indptr = np.fromfile(f, dtype=np.uint64, count=int(num_frames) + 1)
+        indices = np.fromfile(f, dtype=np.uint32, count=int(nnz))
+        data = np.fromfile(f, dtype=np.uint32, count=int(nnz))
+    shape = (int(num_frames), int(num_frames))
+    return sp.csr_matrix((data, indices, indptr), shape=shape), frames
+
+
+def read_triplet_match_matrix(filename):
+    """Read a text triplet match matrix written by maptk_match_matrix
+
+    Returns the sparse matrix and the array of frame numbers
+    """
+    with open(filename) as f:
+        lines = (l for l in f if l.strip() and not l.lstrip().startswith("#"))
+        num_frames, nnz = [int(v) for v in next(lines).split()]
+        frames = np.array(next(lines).split(), dtype=np.int64)
+        ijv = np.loadtxt(lines, dtype=np.int64, ndmin=2)
+    if ijv.shape[0] != nnz:
+        raise ValueError("expected %d triplets, found %d" % (nnz, ijv.shape[0]))
+    shape = (num_frames, num_frames)
+    return sp.coo_matrix((ijv[:, 2], (ijv[:, 0], ijv[:, 1])), shape=shape), frames
+
+
+def file_starts_with(filename, prefix):
+    """Return True if the file contents start with the given bytes"""
+    with open(filename, "rb") as f:
+        return f.read(len(prefix)) == prefix
+
+
+def is_triplet_file(filename):
+    """Return True if the file starts with a triplet match matrix header"""
+    with open(filename) as f:
+        return f.readline().startswith("# MAP-Tk match matrix")
 
 
 def main():
@@ -49,9 +97,12 @@ def main():
 
     matrix_filename = args[0]
 
-    ext = os.path.splitext(matrix_filename)[1]
-    if ext == ".mtx" or ext == "mtx.gz":
+    if matrix_filename.endswith(".mtx.gz") or file_starts_with(matrix_filename, b"%%MatrixMarket"):
         MM = sio.mmread(matrix_filename).toarray()
+    elif file_starts_with(matrix_filename, b"MAPTKCSR"):
+        MM = read_csr_match_matrix(matrix_filename)[0].toarray()
+    elif is_triplet_file(matrix_filename):
+        MM = read_triplet_match_matrix(matrix_filename)[0].toarray()
     else:
         MM = np.loadtxt(matrix_filename)
     plt.imshow(MM)
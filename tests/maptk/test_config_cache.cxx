@@ -0,0 +1,198 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief test reading configuration files through the compiled config cache
+ */
+
+#include <test_common.h>
+
+#include <maptk/config_cache.h>
+
+#include <kwiversys/Directory.hxx>
+#include <kwiversys/SystemTools.hxx>
+
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+#define TEST_ARGS ()
+
+DECLARE_TEST_MAP();
+
+int
+main(int argc, char* argv[])
+{
+  CHECK_ARGS(1);
+
+  testname_t const testname = argv[1];
+
+  RUN_TEST(testname);
+}
+
+
+namespace {
+
+typedef kwiversys::SystemTools ST;
+
+// Write a file
+void
+write_file(std::string const& path, std::string const& contents)
+{
+  std::ofstream(path.c_str()) << contents;
+}
+
+// Read a file
+std::string
+read_file(std::string const& path)
+{
+  std::ifstream ifs(path.c_str());
+  std::ostringstream ss;
+  ss << ifs.rdbuf();
+  return ss.str();
+}
+
+// List the compiled configuration files in a directory
+std::vector<std::string>
+compiled_files(std::string const& dir)
+{
+  std::vector<std::string> files;
+  kwiversys::Directory d;
+  d.Load(dir);
+  for (unsigned long i = 0; i < d.GetNumberOfFiles(); ++i)
+  {
+    std::string const name = d.GetFile(i);
+    if (ST::GetFilenameLastExtension(name) == ".conf")
+    {
+      files.push_back(dir + "/" + name);
+    }
+  }
+  return files;
+}
+
+}
+
+
+IMPLEMENT_TEST(includes)
+{
+  std::string const dir = ST::GetCurrentWorkingDirectory() + "/test_config_cache_dir";
+  std::string const cache_dir = dir + "/cache";
+  ST::RemoveADirectory(dir);
+  ST::MakeDirectory(dir);
+
+  write_file(dir + "/main.conf",
+             "value = 1\n"
+             "block nested\n"
+             "  include included.conf\n"
+             "endblock\n");
+  write_file(dir + "/included.conf", "a = first\n");
+
+  using kwiver::maptk::read_cached_config_file;
+  auto config = read_cached_config_file(dir + "/main.conf", "maptk_test",
+                                        "", "", cache_dir);
+  TEST_EQUAL("top level value", config->get_value<int>("value"), 1);
+  TEST_EQUAL("included value",
+             config->get_value<std::string>("nested:a"), "first");
+
+  // modifying the returned block does not affect the cache
+  config->set_value("value", 2);
+  config = read_cached_config_file(dir + "/main.conf", "maptk_test",
+                                   "", "", cache_dir);
+  TEST_EQUAL("cached value", config->get_value<int>("value"), 1);
+
+  // a changed include is noticed (the new contents also change the size, in
+  // case the modification time does not)
+  write_file(dir + "/included.conf", "a = second value\n");
+  config = read_cached_config_file(dir + "/main.conf", "maptk_test",
+                                   "", "", cache_dir);
+  TEST_EQUAL("updated included value",
+             config->get_value<std::string>("nested:a"), "second value");
+
+  ST::RemoveADirectory(dir);
+}
+
+
+IMPLEMENT_TEST(compiled_file)
+{
+  std::string const dir = ST::GetCurrentWorkingDirectory() + "/test_config_cache_dir";
+  std::string const cache_dir = dir + "/cache";
+  ST::RemoveADirectory(dir);
+  ST::MakeDirectory(dir);
+
+  write_file(dir + "/main.conf",
+             "value = 1\n"
+             "fixed[RO] = 2\n"
+             "block nested\n"
+             "  include included.conf\n"
+             "endblock\n");
+  write_file(dir + "/included.conf", "a = first\n");
+
+  using kwiver::maptk::read_cached_config_file;
+  auto config = read_cached_config_file(dir + "/main.conf", "maptk_test",
+                                        "", "", cache_dir);
+  TEST_EQUAL("read-only value", config->is_read_only("fixed"), true);
+
+  auto files = compiled_files(cache_dir);
+  TEST_EQUAL("one compiled file", files.size(), 1);
+  if (files.size() != 1)
+  {
+    return;
+  }
+
+  // Change a value in the compiled file only (keeping its size), so that
+  // reading the changed value shows the compiled file was used
+  std::string compiled = read_file(files[0]);
+  auto const pos = compiled.find("first");
+  TEST_EQUAL("compiled value found", pos != std::string::npos, true);
+  if (pos == std::string::npos)
+  {
+    return;
+  }
+  compiled.replace(pos, 5, "FIRST");
+  write_file(files[0], compiled);
+
+  kwiver::maptk::clear_config_memory_cache();
+  config = read_cached_config_file(dir + "/main.conf", "maptk_test",
+                                   "", "", cache_dir);
+  TEST_EQUAL("value from compiled file",
+             config->get_value<std::string>("nested:a"), "FIRST");
+  TEST_EQUAL("compiled top level value", config->get_value<int>("value"), 1);
+  TEST_EQUAL("compiled read-only value", config->is_read_only("fixed"), true);
+  TEST_EQUAL("compiled writable value", config->is_read_only("value"), false);
+
+  // files using macros are never compiled, since their values may change
+  // without the file changing
+  write_file(dir + "/macro.conf", "home = $ENV{HOME}\n");
+  read_cached_config_file(dir + "/macro.conf", "maptk_test", "", "", cache_dir);
+  TEST_EQUAL("macro file not compiled", compiled_files(cache_dir).size(), 1);
+
+  ST::RemoveADirectory(dir);
+}
@@ -0,0 +1,147 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief test top-K co-visible frame queries
+ */
+
+#include <test_common.h>
+#include <test_tracks.h>
+
+#include <maptk/covisibility_index.h>
+
+#define TEST_ARGS ()
+
+DECLARE_TEST_MAP();
+
+int
+main(int argc, char* argv[])
+{
+  CHECK_ARGS(1);
+
+  testname_t const testname = argv[1];
+
+  RUN_TEST(testname);
+}
+
+
+namespace {
+
+using namespace kwiver::vital;
+using kwiver::maptk::testing::make_track;
+
+// Create tracks along a sequence of 30 frames that revisits frames 0-4
+// at frames 20-24, with frame f + 20 sharing (5 - f) tracks with frame f
+std::vector<track_sptr>
+make_loop_tracks()
+{
+  std::vector<track_sptr> tracks;
+  track_id_t id = 0;
+  for (frame_id_t f = 0; f < 29; ++f)
+  {
+    // short tracks connecting consecutive frames
+    for (int i = 0; i < 10; ++i)
+    {
+      tracks.push_back(make_track(id++, { f, f + 1 }));
+    }
+  }
+  for (frame_id_t f = 0; f < 5; ++f)
+  {
+    // loop tracks connecting a frame to its revisit
+    for (frame_id_t i = f; i < 5; ++i)
+    {
+      tracks.push_back(make_track(id++, { f, f + 20 }));
+    }
+  }
+  return tracks;
+}
+
+}
+
+
+IMPLEMENT_TEST(top_k)
+{
+  kwiver::maptk::match_matrix_builder builder;
+  builder.update(make_loop_tracks());
+
+  kwiver::maptk::covisibility_index index(2);
+  index.build(builder);
+  TEST_EQUAL("number of frames", index.num_frames(), 30);
+
+  // without an exclusion window the adjacent frames dominate
+  auto n = index.top_k(21, 2);
+  TEST_EQUAL("unrestricted size", n.size(), 2);
+  TEST_EQUAL("unrestricted first", n[0].frame, 20);
+  TEST_EQUAL("unrestricted second", n[1].frame, 22);
+  TEST_EQUAL("unrestricted count", n[0].count, 10);
+
+  // excluding nearby frames leaves the loop closure
+  n = index.top_k(21, 3, 5);
+  TEST_EQUAL("excluded size", n.size(), 1);
+  TEST_EQUAL("excluded frame", n[0].frame, 1);
+  TEST_EQUAL("excluded count", n[0].count, 4);
+
+  // the loop is also found from the earlier frame, but not if only earlier
+  // frames are requested
+  TEST_EQUAL("later frame", index.top_k(1, 3, 5)[0].frame, 21);
+  TEST_EQUAL("earlier only", index.top_k(1, 3, 5, 1, true).empty(), true);
+
+  // minimum count
+  TEST_EQUAL("min count", index.top_k(24, 3, 5, 2).empty(), true);
+  TEST_EQUAL("unknown frame", index.top_k(100, 3).empty(), true);
+}
+
+
+IMPLEMENT_TEST(candidate_pairs)
+{
+  kwiver::maptk::match_matrix_builder builder;
+  builder.update(make_loop_tracks());
+
+  std::vector<frame_id_t> frames;
+  auto const mm = builder.matrix(frames);
+  kwiver::maptk::covisibility_index index;
+  index.build(mm, frames);
+
+  auto const pairs = index.candidate_pairs(2, 5, 2);
+  TEST_EQUAL("number of pairs", pairs.size(), 4);
+  for (size_t i = 0; i < pairs.size(); ++i)
+  {
+    TEST_EQUAL("pair " << i << " first", pairs[i].first,
+               static_cast<frame_id_t>(i));
+    TEST_EQUAL("pair " << i << " second", pairs[i].second,
+               static_cast<frame_id_t>(i + 20));
+  }
+
+  // both build methods produce the same index
+  kwiver::maptk::covisibility_index from_builder;
+  from_builder.build(builder);
+  TEST_EQUAL("same pairs", from_builder.candidate_pairs(2, 5, 2) == pairs, true);
+}
@@ -0,0 +1,250 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief test the on-disk feature and descriptor cache
+ */
+
+#include <test_common.h>
+
+#include <maptk/feature_cache.h>
+
+#include <vital/exceptions.h>
+#include <vital/types/covariance.h>
+#include <vital/types/descriptor.h>
+#include <vital/types/feature.h>
+
+#include <kwiversys/SystemTools.hxx>
+
+#include <fstream>
+#include <sstream>
+
+#define TEST_ARGS ()
+
+DECLARE_TEST_MAP();
+
+int
+main(int argc, char* argv[])
+{
+  CHECK_ARGS(1);
+
+  testname_t const testname = argv[1];
+
+  RUN_TEST(testname);
+}
+
+
+namespace {
+
+using namespace kwiver::vital;
+
+// Create a set of features with distinct values
+feature_set_sptr
+make_features(unsigned num)
+{
+  std::vector<feature_sptr> feat;
+  for (unsigned i = 0; i < num; ++i)
+  {
+    feat.push_back(std::make_shared<feature_d>(
+      vector_2d(i * 1.5, i * 2.5), i * 0.1, 1.0 + i, i * 0.01,
+      rgb_color(i % 256, (2 * i) % 256, (3 * i) % 256)));
+  }
+  return std::make_shared<simple_feature_set>(feat);
+}
+
+// Create a descriptor for each feature
+descriptor_set_sptr
+make_descriptors(unsigned num, unsigned length)
+{
+  std::vector<descriptor_sptr> desc;
+  for (unsigned i = 0; i < num; ++i)
+  {
+    auto d = std::make_shared<descriptor_dynamic<float> >(length);
+    for (unsigned j = 0; j < length; ++j)
+    {
+      d->raw_data()[j] = static_cast<float>(i * length + j);
+    }
+    desc.push_back(d);
+  }
+  return std::make_shared<simple_descriptor_set>(desc);
+}
+
+// Check that two feature and descriptor sets are equal
+void
+check_equal(feature_set_sptr const& f1, descriptor_set_sptr const& d1,
+            feature_set_sptr const& f2, descriptor_set_sptr const& d2)
+{
+  auto const feat1 = f1->features();
+  auto const feat2 = f2->features();
+  TEST_EQUAL("number of features", feat2.size(), feat1.size());
+  for (size_t i = 0; i < feat1.size() && i < feat2.size(); ++i)
+  {
+    TEST_EQUAL("feature " << i << " location", feat2[i]->loc(), feat1[i]->loc());
+    TEST_EQUAL("feature " << i << " scale", feat2[i]->scale(), feat1[i]->scale());
+    TEST_EQUAL("feature " << i << " color", feat2[i]->color().b, feat1[i]->color().b);
+    TEST_EQUAL("feature " << i << " type",
+               feat2[i]->data_type() == feat1[i]->data_type(), true);
+    TEST_EQUAL("feature " << i << " covariance",
+               feat2[i]->covar().matrix(), feat1[i]->covar().matrix());
+  }
+
+  auto const desc1 = d1->descriptors();
+  auto const desc2 = d2->descriptors();
+  TEST_EQUAL("number of descriptors", desc2.size(), desc1.size());
+  for (size_t i = 0; i < desc1.size() && i < desc2.size(); ++i)
+  {
+    TEST_EQUAL("descriptor " << i << " values",
+               desc2[i]->as_double() == desc1[i]->as_double(), true);
+  }
+}
+
+}
+
+
+IMPLEMENT_TEST(stream_round_trip)
+{
+  auto const features = make_features(50);
+  auto const descriptors = make_descriptors(50, 64);
+
+  std::stringstream ss;
+  kwiver::maptk::write_feature_cache(ss, *features, descriptors.get());
+
+  feature_set_sptr f;
+  descriptor_set_sptr d;
+  kwiver::maptk::read_feature_cache(ss, f, d);
+  check_equal(features, descriptors, f, d);
+
+  // float features with a covariance
+  std::vector<feature_sptr> float_feat;
+  for (unsigned i = 0; i < 10; ++i)
+  {
+    auto f = std::make_shared<feature_f>(vector_2f(i * 0.5f, i * 0.25f),
+                                         0.1f * i, 2.0f, 0.01f * i);
+    Eigen::Matrix2f covar;
+    covar << 1.0f + i, 0.5f, 0.5f, 2.0f + i;
+    f->set_covar(covariance_2f(covar));
+    float_feat.push_back(f);
+  }
+  auto const float_features = std::make_shared<simple_feature_set>(float_feat);
+  std::stringstream fss;
+  kwiver::maptk::write_feature_cache(fss, *float_features, descriptors.get());
+  kwiver::maptk::read_feature_cache(fss, f, d);
+  check_equal(float_features, descriptors, f, d);
+
+  // truncated data
+  std::string const data = ss.str();
+  std::istringstream truncated(data.substr(0, data.size() / 2));
+  EXPECT_EXCEPTION(invalid_data,
+                   kwiver::maptk::read_feature_cache(truncated, f, d),
+                   "reading truncated feature cache data");
+
+  // a corrupt feature count larger than the data is rejected, not allocated
+  std::string corrupt = data;
+  uint64_t const huge_count = uint64_t(1) << 60;
+  corrupt.replace(16, sizeof(huge_count),
+                  reinterpret_cast<char const*>(&huge_count),
+                  sizeof(huge_count));
+  std::istringstream corrupt_stream(corrupt);
+  EXPECT_EXCEPTION(invalid_data,
+                   kwiver::maptk::read_feature_cache(corrupt_stream, f, d),
+                   "reading a corrupt feature count");
+}
+
+
+IMPLEMENT_TEST(cache_keys)
+{
+  std::string const dir = "test_feature_cache_dir";
+  kwiversys::SystemTools::RemoveADirectory(dir);
+  kwiversys::SystemTools::MakeDirectory(dir);
+
+  std::string const image1 = dir + "/image1.raw";
+  std::string const image2 = dir + "/image2.raw";
+  std::ofstream(image1.c_str()) << "first image";
+  std::ofstream(image2.c_str()) << "second image";
+
+  auto config = config_block::empty_config();
+  config->set_value("detector:type", "ocv");
+  config->set_value("detector:ocv:threshold", 250);
+  auto reordered = config_block::empty_config();
+  reordered->set_value("detector:ocv:threshold", 250);
+  reordered->set_value("detector:type", "ocv");
+  auto changed = config_block::empty_config();
+  changed->set_value("detector:type", "ocv");
+  changed->set_value("detector:ocv:threshold", 300);
+
+  typedef kwiver::maptk::feature_cache cache_t;
+  uint64_t const h = cache_t::hash_config(config);
+  TEST_EQUAL("config order does not matter", cache_t::hash_config(reordered), h);
+  TEST_EQUAL("config values matter", cache_t::hash_config(changed) != h, true);
+
+  std::string const key1 = cache_t::make_key(image1, h);
+  TEST_EQUAL("same key", cache_t::make_key(image1, h), key1);
+  TEST_EQUAL("image changes key", cache_t::make_key(image2, h) != key1, true);
+  TEST_EQUAL("mask changes key", cache_t::make_key(image1, h, image2) != key1, true);
+
+  cache_t cache(dir + "/cache");
+  feature_set_sptr f;
+  descriptor_set_sptr d;
+  TEST_EQUAL("miss before store", cache.load(key1, f, d), false);
+
+  auto const features = make_features(20);
+  auto const descriptors = make_descriptors(20, 8);
+  TEST_EQUAL("store", cache.store(key1, features, descriptors), true);
+  TEST_EQUAL("hit after store", cache.load(key1, f, d), true);
+  check_equal(features, descriptors, f, d);
+  TEST_EQUAL("other key misses",
+             cache.load(cache_t::make_key(image2, h), f, d), false);
+
+  // a corrupt entry is a miss
+  std::ofstream(cache.entry_path(key1).c_str(),
+                std::ios::out | std::ios::binary) << "MAPTKFDC garbage";
+  feature_set_sptr f2;
+  TEST_EQUAL("corrupt entry misses", cache.load(key1, f2, d), false);
+  TEST_EQUAL("corrupt entry leaves outputs", f2 == nullptr, true);
+
+  // detection settings hash the same however the tool nests them
+  auto tool = config_block::empty_config();
+  tool->set_value("feature_tracker:core:feature_detector:type", "ocv");
+  tool->set_value("convert_image:type", "bypass");
+  auto other_tool = config_block::empty_config();
+  other_tool->set_value("feature_detector:type", "ocv");
+  other_tool->set_value("image_converter:type", "bypass");
+  TEST_EQUAL("detection config hash",
+             cache_t::hash_config(cache_t::detection_config(
+               nullptr, tool->subblock("convert_image"),
+               tool->subblock("feature_tracker:core:feature_detector"),
+               nullptr)),
+             cache_t::hash_config(cache_t::detection_config(
+               nullptr, other_tool->subblock("image_converter"),
+               other_tool->subblock("feature_detector"), nullptr)));
+
+  kwiversys::SystemTools::RemoveADirectory(dir);
+}
@@ -0,0 +1,171 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief test incremental, multi-threaded match matrix computation
+ */
+
+#include <test_common.h>
+#include <test_tracks.h>
+
+#include <maptk/match_matrix_builder.h>
+
+#define TEST_ARGS ()
+
+DECLARE_TEST_MAP();
+
+int
+main(int argc, char* argv[])
+{
+  CHECK_ARGS(1);
+
+  testname_t const testname = argv[1];
+
+  RUN_TEST(testname);
+}
+
+
+namespace {
+
+using namespace kwiver::vital;
+using kwiver::maptk::testing::make_track;
+
+// Create a deterministic pseudo-random set of tracks
+std::vector<track_sptr>
+make_tracks(unsigned num_tracks, track_id_t first_id = 0)
+{
+  std::vector<track_sptr> tracks;
+  for (unsigned i = 0; i < num_tracks; ++i)
+  {
+    frame_id_t const start = (i * 7) % 40;
+    frame_id_t const length = 1 + (i * 13) % 9;
+    std::vector<frame_id_t> frames;
+    for (frame_id_t f = start; f < start + length; ++f)
+    {
+      frames.push_back(f);
+    }
+    tracks.push_back(make_track(first_id + i, frames));
+  }
+  return tracks;
+}
+
+// Check a builder against a brute force count over the given tracks
+void
+check_counts(kwiver::maptk::match_matrix_builder const& builder,
+             std::vector<track_sptr> const& tracks,
+             std::string const& label)
+{
+  std::vector<frame_id_t> frames;
+  auto const mm = builder.matrix(frames);
+
+  TEST_EQUAL(label << ": matrix size", static_cast<size_t>(mm.rows()), frames.size());
+  for (size_t i = 0; i < frames.size(); ++i)
+  {
+    for (size_t j = 0; j < frames.size(); ++j)
+    {
+      unsigned int expected = 0;
+      VITAL_FOREACH (auto const& t, tracks)
+      {
+        if (t->find(frames[i]) != t->end() && t->find(frames[j]) != t->end())
+        {
+          ++expected;
+        }
+      }
+      TEST_EQUAL(label << ": count (" << frames[i] << ", " << frames[j] << ")",
+                 mm.coeff(static_cast<int>(i), static_cast<int>(j)), expected);
+    }
+  }
+}
+
+}
+
+
+IMPLEMENT_TEST(full_build)
+{
+  auto const tracks = make_tracks(200);
+
+  kwiver::maptk::match_matrix_builder single(1);
+  single.update(tracks);
+  check_counts(single, tracks, "single thread");
+
+  kwiver::maptk::match_matrix_builder multi(4);
+  multi.update(tracks);
+  check_counts(multi, tracks, "four threads");
+
+  TEST_EQUAL("same number of pairs", multi.pair_counts().size(),
+             single.pair_counts().size());
+}
+
+
+IMPLEMENT_TEST(incremental_update)
+{
+  kwiver::maptk::match_matrix_builder builder(3);
+
+  // append tracks in two batches
+  auto tracks = make_tracks(100);
+  builder.update(tracks);
+  auto more = make_tracks(50, 100);
+  builder.update(more, false);
+  tracks.insert(tracks.end(), more.begin(), more.end());
+  check_counts(builder, tracks, "appended tracks");
+  TEST_EQUAL("number of tracks", builder.num_tracks(), 150);
+
+  // extend, shorten and remove some tracks
+  tracks[3] = make_track(3, { 0, 1, 2, 45, 46 });
+  tracks[10] = make_track(10, { 5 });
+  tracks.erase(tracks.begin() + 20, tracks.begin() + 30);
+  builder.update(tracks);
+  check_counts(builder, tracks, "modified tracks");
+  TEST_EQUAL("number of tracks", builder.num_tracks(), 140);
+
+  // extend a track in place, and replace another with a different track
+  // object of the same size
+  auto const feat = std::make_shared<feature_d>(vector_2d(0, 0));
+  tracks[5]->append(track::track_state(46, feat, descriptor_sptr()));
+  std::vector<frame_id_t> shifted;
+  VITAL_FOREACH (auto const& ts, *tracks[6])
+  {
+    shifted.push_back(ts.frame_id + 3);
+  }
+  tracks[6] = make_track(6, shifted);
+  builder.update(tracks);
+  check_counts(builder, tracks, "changed in place and replaced tracks");
+  TEST_EQUAL("number of tracks", builder.num_tracks(), 140);
+
+  // a sub-range of frames
+  std::vector<frame_id_t> frames = { 2, 5, 45 };
+  auto const mm = builder.matrix(frames);
+  TEST_EQUAL("sub-range size", mm.rows(), 3);
+  TEST_EQUAL("sub-range count", mm.coeff(0, 2), builder.count(2, 45));
+
+  builder.clear();
+  TEST_EQUAL("cleared", builder.frames().empty(), true);
+}
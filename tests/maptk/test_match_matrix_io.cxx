@@ -0,0 +1,261 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief test reading and writing sparse match matrix files
+ */
+
+#include <test_common.h>
+
+#include <fstream>
+#include <sstream>
+
+#include <maptk/match_matrix_io.h>
+
+#include <vital/exceptions.h>
+
+#include <kwiversys/SystemTools.hxx>
+
+#define TEST_ARGS ()
+
+DECLARE_TEST_MAP();
+
+int
+main(int argc, char* argv[])
+{
+  CHECK_ARGS(1);
+
+  testname_t const testname = argv[1];
+
+  RUN_TEST(testname);
+}
+
+
+namespace {
+
+typedef Eigen::SparseMatrix<unsigned int> match_matrix_t;
+
+// Build a small symmetric match matrix over frames 10, 12, 15, 20
+void
+make_matrix(match_matrix_t& mm, std::vector<kwiver::vital::frame_id_t>& frames)
+{
+  frames = { 10, 12, 15, 20 };
+
+  std::vector< Eigen::Triplet<unsigned int> > t;
+  t.push_back(Eigen::Triplet<unsigned int>(0, 0, 50));
+  t.push_back(Eigen::Triplet<unsigned int>(1, 1, 40));
+  t.push_back(Eigen::Triplet<unsigned int>(2, 2, 30));
+  t.push_back(Eigen::Triplet<unsigned int>(3, 3, 7));
+  t.push_back(Eigen::Triplet<unsigned int>(0, 1, 25));
+  t.push_back(Eigen::Triplet<unsigned int>(1, 0, 25));
+  t.push_back(Eigen::Triplet<unsigned int>(1, 2, 12));
+  t.push_back(Eigen::Triplet<unsigned int>(2, 1, 12));
+
+  mm = match_matrix_t(4, 4);
+  mm.setFromTriplets(t.begin(), t.end());
+}
+
+// Compare two match matrices and frame lists
+void
+compare(match_matrix_t const& a, std::vector<kwiver::vital::frame_id_t> const& fa,
+        match_matrix_t const& b, std::vector<kwiver::vital::frame_id_t> const& fb)
+{
+  TEST_EQUAL("frame numbers", fa == fb, true);
+  TEST_EQUAL("rows", a.rows(), b.rows());
+  TEST_EQUAL("cols", a.cols(), b.cols());
+  TEST_EQUAL("non-zeros", a.nonZeros(), b.nonZeros());
+  for (int r = 0; r < a.rows(); ++r)
+  {
+    for (int c = 0; c < a.cols(); ++c)
+    {
+      TEST_EQUAL("value (" << r << ", " << c << ")",
+                 a.coeff(r, c), b.coeff(r, c));
+    }
+  }
+}
+
+}
+
+
+IMPLEMENT_TEST(triplets_roundtrip)
+{
+  using namespace kwiver;
+
+  match_matrix_t mm, mm2;
+  std::vector<vital::frame_id_t> frames, frames2;
+  make_matrix(mm, frames);
+
+  std::stringstream ss;
+  maptk::write_match_matrix_triplets(ss, mm, frames);
+  maptk::read_match_matrix_triplets(ss, mm2, frames2);
+
+  compare(mm, frames, mm2, frames2);
+}
+
+
+IMPLEMENT_TEST(csr_roundtrip)
+{
+  using namespace kwiver;
+
+  match_matrix_t mm, mm2;
+  std::vector<vital::frame_id_t> frames, frames2;
+  make_matrix(mm, frames);
+
+  std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+  maptk::write_match_matrix_csr(ss, mm, frames);
+  maptk::read_match_matrix_csr(ss, mm2, frames2);
+
+  compare(mm, frames, mm2, frames2);
+}
+
+
+IMPLEMENT_TEST(market_roundtrip)
+{
+  using namespace kwiver;
+
+  match_matrix_t mm, mm2;
+  std::vector<vital::frame_id_t> frames, frames2;
+  make_matrix(mm, frames);
+
+  std::stringstream ss;
+  maptk::write_match_matrix_market(ss, mm, frames);
+  maptk::read_match_matrix_market(ss, mm2, frames2);
+
+  compare(mm, frames, mm2, frames2);
+
+  // a symmetric file from another tool, without frame numbers
+  std::stringstream external("%%MatrixMarket matrix coordinate real symmetric\n"
+                             "% written elsewhere\n"
+                             "3 3 2\n"
+                             "1 1 9.0\n"
+                             "3 1 4.0\n");
+  maptk::read_match_matrix_market(external, mm2, frames2);
+  std::vector<vital::frame_id_t> const expected_frames = { 0, 1, 2 };
+  TEST_EQUAL("default frame numbers", frames2 == expected_frames, true);
+  TEST_EQUAL("diagonal value", mm2.coeff(0, 0), 9u);
+  TEST_EQUAL("lower value", mm2.coeff(2, 0), 4u);
+  TEST_EQUAL("mirrored value", mm2.coeff(0, 2), 4u);
+}
+
+
+IMPLEMENT_TEST(file_format_detection)
+{
+  using namespace kwiver;
+
+  std::string const dir = "test_match_matrix_io_dir";
+  kwiversys::SystemTools::RemoveADirectory(dir);
+  kwiversys::SystemTools::MakeDirectory(dir);
+
+  match_matrix_t mm, mm2;
+  std::vector<vital::frame_id_t> frames, frames2;
+  make_matrix(mm, frames);
+
+  // formats chosen by extension
+  char const* const names[] = { "matrix.txt", "matrix.csr", "matrix.mtx" };
+  for (auto const name : names)
+  {
+    std::string const path = dir + "/" + name;
+    maptk::write_match_matrix_file(mm, frames, path);
+    maptk::read_match_matrix_file(path, mm2, frames2);
+    compare(mm, frames, mm2, frames2);
+  }
+
+  // formats that do not match the extension are detected from the contents
+  char const* const formats[] = { "triplets", "csr", "mtx" };
+  for (auto const format : formats)
+  {
+    std::string const path = dir + "/" + format + ".dat";
+    maptk::write_match_matrix_file(mm, frames, path, format);
+    maptk::read_match_matrix_file(path, mm2, frames2);
+    compare(mm, frames, mm2, frames2);
+  }
+
+  EXPECT_EXCEPTION(vital::invalid_value,
+                   maptk::write_match_matrix_file(mm, frames,
+                                                  dir + "/bad.txt", "dense"),
+                   "writing an unknown format");
+
+  // dense text, as printed by the match matrix tool, is rejected
+  std::string const dense = dir + "/dense.txt";
+  std::ofstream(dense.c_str()) << "50 25 0\n25 40 12\n0 12 30\n";
+  EXPECT_EXCEPTION(vital::invalid_file,
+                   maptk::read_match_matrix_file(dense, mm2, frames2),
+                   "reading a dense text matrix");
+
+  kwiversys::SystemTools::RemoveADirectory(dir);
+}
+
+
+IMPLEMENT_TEST(invalid_input)
+{
+  using namespace kwiver;
+
+  match_matrix_t mm;
+  std::vector<vital::frame_id_t> frames;
+
+  std::stringstream bad_csr("NOTACSRFILE");
+  EXPECT_EXCEPTION(vital::invalid_data,
+                   maptk::read_match_matrix_csr(bad_csr, mm, frames),
+                   "reading a file without the CSR signature");
+
+  // a valid header whose counts do not fit in the remaining data
+  match_matrix_t good;
+  std::vector<vital::frame_id_t> good_frames;
+  make_matrix(good, good_frames);
+  std::stringstream csr(std::ios::in | std::ios::out | std::ios::binary);
+  maptk::write_match_matrix_csr(csr, good, good_frames);
+  std::string data = csr.str();
+  uint64_t const huge = uint64_t{1} << 20;
+  std::string const huge_frames = data.substr(0, 16) +
+    std::string(reinterpret_cast<char const*>(&huge), sizeof(huge)) +
+    data.substr(24);
+  std::stringstream bad_frames(huge_frames);
+  EXPECT_EXCEPTION(vital::invalid_data,
+                   maptk::read_match_matrix_csr(bad_frames, mm, frames),
+                   "reading a CSR frame count larger than the data");
+  uint64_t const many = 1000;
+  std::string const many_nonzeros = data.substr(0, 24) +
+    std::string(reinterpret_cast<char const*>(&many), sizeof(many)) +
+    data.substr(32);
+  std::stringstream bad_nonzeros(many_nonzeros);
+  EXPECT_EXCEPTION(vital::invalid_data,
+                   maptk::read_match_matrix_csr(bad_nonzeros, mm, frames),
+                   "reading a CSR non-zero count larger than the matrix");
+  std::stringstream truncated(data.substr(0, data.size() - 4));
+  EXPECT_EXCEPTION(vital::invalid_data,
+                   maptk::read_match_matrix_csr(truncated, mm, frames),
+                   "reading truncated CSR data");
+
+  std::stringstream bad_triplets("2 1\n0 1\n0 5 3\n");
+  EXPECT_EXCEPTION(vital::invalid_data,
+                   maptk::read_match_matrix_triplets(bad_triplets, mm, frames),
+                   "reading a triplet index out of range");
+}
@@ -0,0 +1,137 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief test parallel loop helpers
+ */
+
+#include <test_common.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include <maptk/parallel.h>
+
+#define TEST_ARGS ()
+
+DECLARE_TEST_MAP();
+
+int
+main(int argc, char* argv[])
+{
+  CHECK_ARGS(1);
+
+  testname_t const testname = argv[1];
+
+  RUN_TEST(testname);
+}
+
+
+IMPLEMENT_TEST(resolve_num_threads)
+{
+  using namespace kwiver::maptk;
+
+  TEST_EQUAL("explicit thread count", resolve_num_threads(3), 3);
+  TEST_EQUAL("hardware thread count is positive", resolve_num_threads(0) > 0, true);
+}
+
+
+IMPLEMENT_TEST(parallel_for_visits_all)
+{
+  using namespace kwiver::maptk;
+
+  std::vector<int> visits(1000, 0);
+  parallel_for(visits.size(), 4, [&visits](size_t i) { ++visits[i]; });
+
+  bool all_once = true;
+  VITAL_FOREACH(int v, visits)
+  {
+    all_once = all_once && (v == 1);
+  }
+  TEST_EQUAL("every index visited once", all_once, true);
+}
+
+
+IMPLEMENT_TEST(parallel_for_chunks_cover_range)
+{
+  using namespace kwiver::maptk;
+
+  std::vector<int> visits(1001, 0);
+  std::atomic<unsigned> num_chunks(0);
+  parallel_for_chunks(visits.size(), 4,
+    [&visits, &num_chunks](size_t begin, size_t end)
+    {
+      ++num_chunks;
+      for (size_t i = begin; i < end; ++i)
+      {
+        ++visits[i];
+      }
+    });
+
+  bool all_once = true;
+  VITAL_FOREACH(int v, visits)
+  {
+    all_once = all_once && (v == 1);
+  }
+  TEST_EQUAL("every index visited once", all_once, true);
+  TEST_EQUAL("number of chunks", num_chunks, 4);
+
+  num_chunks = 0;
+  parallel_for_chunks(2, 8, [&num_chunks](size_t, size_t) { ++num_chunks; });
+  TEST_EQUAL("no more chunks than indices", num_chunks, 2);
+}
+
+
+IMPLEMENT_TEST(exception_propagation)
+{
+  using namespace kwiver::maptk;
+
+  EXPECT_EXCEPTION(std::runtime_error,
+                   parallel_for(100, 4, [](size_t i)
+                   {
+                     if (i == 42)
+                     {
+                       throw std::runtime_error("failure at index 42");
+                     }
+                   }),
+                   "a loop body throws");
+
+  EXPECT_EXCEPTION(std::runtime_error,
+                   parallel_for_chunks(100, 4, [](size_t begin, size_t)
+                   {
+                     if (begin == 0)
+                     {
+                       throw std::runtime_error("failure in first chunk");
+                     }
+                   }),
+                   "a chunk body throws");
+}
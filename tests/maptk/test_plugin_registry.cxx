@@ -0,0 +1,74 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief test selective plugin loading helpers
+ */
+
+#include <test_common.h>
+
+#include <maptk/plugin_registry.h>
+
+#define TEST_ARGS ()
+
+DECLARE_TEST_MAP();
+
+int
+main(int argc, char* argv[])
+{
+  CHECK_ARGS(1);
+
+  testname_t const testname = argv[1];
+
+  RUN_TEST(testname);
+}
+
+
+IMPLEMENT_TEST(algorithm_types)
+{
+  using kwiver::vital::config_block;
+
+  auto config = config_block::empty_config();
+  config->set_value("type", "top");
+  config->set_value("feature_tracker:type", "core");
+  config->set_value("feature_tracker:core:feature_detector:type", "ocv");
+  config->set_value("feature_tracker:core:feature_matcher:type", "ocv");
+  config->set_value("image_reader:type", "");
+  config->set_value("image_reader:subtype", "not_a_type");
+  config->set_value("output_file", "tracks.txt");
+
+  auto const names = kwiver::maptk::algorithm_types(config);
+  TEST_EQUAL("number of names", names.size(), 3);
+  TEST_EQUAL("top level type", names.count("top"), 1);
+  TEST_EQUAL("nested type", names.count("core"), 1);
+  TEST_EQUAL("repeated type", names.count("ocv"), 1);
+  TEST_EQUAL("suffix only", names.count("not_a_type"), 0);
+}
@@ -0,0 +1,208 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief test column-oriented track statistics
+ */
+
+#include <test_common.h>
+
+#include <cstdio>
+#include <fstream>
+
+#include <maptk/track_statistics.h>
+
+#define TEST_ARGS ()
+
+DECLARE_TEST_MAP();
+
+int
+main(int argc, char* argv[])
+{
+  CHECK_ARGS(1);
+
+  testname_t const testname = argv[1];
+
+  RUN_TEST(testname);
+}
+
+
+namespace {
+
+// Build a small track set:
+//   track 0 on frames 0 1 2 3
+//   track 1 on frames 1 3      (one frame gap)
+//   track 2 on frame  3
+kwiver::vital::track_set_sptr
+make_tracks()
+{
+  using namespace kwiver::vital;
+
+  std::vector<track_sptr> tracks;
+  frame_id_t const frames[3][4] = { { 0, 1, 2, 3 }, { 1, 3 }, { 3 } };
+  unsigned const lengths[3] = { 4, 2, 1 };
+  for (unsigned t = 0; t < 3; ++t)
+  {
+    auto trk = std::make_shared<track>();
+    trk->set_id(t);
+    for (unsigned i = 0; i < lengths[t]; ++i)
+    {
+      auto feat = std::make_shared<feature_d>(vector_2d(t, frames[t][i]));
+      trk->append(track::track_state(frames[t][i], feat, descriptor_sptr()));
+    }
+    tracks.push_back(trk);
+  }
+  return std::make_shared<simple_track_set>(tracks);
+}
+
+}
+
+
+IMPLEMENT_TEST(track_set_statistics)
+{
+  using namespace kwiver;
+
+  auto const columns = maptk::track_set_columns(*make_tracks());
+  TEST_EQUAL("number of tracks", columns.num_tracks(), 3);
+  TEST_EQUAL("number of states", columns.num_states(), 7);
+
+  auto const stats = maptk::compute_track_statistics(columns);
+  TEST_EQUAL("first frame", stats.first_frame, 0);
+  TEST_EQUAL("last frame", stats.last_frame, 3);
+  TEST_NEAR("mean track length", stats.mean_track_length, 7.0 / 3.0, 1e-12);
+
+  TEST_EQUAL("length histogram size", stats.length_histogram.size(), 5);
+  TEST_EQUAL("tracks of length 1", stats.length_histogram[1], 1);
+  TEST_EQUAL("tracks of length 2", stats.length_histogram[2], 1);
+  TEST_EQUAL("tracks of length 4", stats.length_histogram[4], 1);
+
+  TEST_EQUAL("fully continuous tracks", stats.continuity_histogram[9], 2);
+  TEST_EQUAL("partially continuous tracks", stats.continuity_histogram[6], 1);
+
+  size_t const active[4] = { 1, 2, 1, 3 };
+  size_t const created[4] = { 1, 1, 0, 1 };
+  size_t const ended[4] = { 0, 0, 0, 3 };
+  for (unsigned f = 0; f < 4; ++f)
+  {
+    TEST_EQUAL("active tracks on frame " << f, stats.active_tracks[f], active[f]);
+    TEST_EQUAL("new tracks on frame " << f, stats.new_tracks[f], created[f]);
+    TEST_EQUAL("terminated tracks on frame " << f, stats.terminated_tracks[f], ended[f]);
+  }
+  TEST_EQUAL("no reprojection errors", stats.num_reprojection_errors, 0);
+}
+
+
+IMPLEMENT_TEST(track_file_statistics)
+{
+  using namespace kwiver;
+
+  // states are deliberately not grouped by track
+  char const* const filename = "test_track_statistics.txt";
+  {
+    std::ofstream ofs(filename);
+    ofs << "0 0 0 0\n"
+        << "1 1 1 1\n"
+        << "0 1 0 1\n"
+        << "0 2 0 2\n"
+        << "1 3 1 3\n"
+        << "0 3 0 3\n"
+        << "2 3 2 3\n";
+  }
+
+  auto const file_stats =
+    maptk::compute_track_statistics(maptk::read_track_file_columns(filename));
+  auto const set_stats =
+    maptk::compute_track_statistics(maptk::track_set_columns(*make_tracks()));
+  std::remove(filename);
+
+  TEST_EQUAL("number of tracks", file_stats.num_tracks, set_stats.num_tracks);
+  TEST_EQUAL("number of states", file_stats.num_states, set_stats.num_states);
+  TEST_EQUAL("length histogram", file_stats.length_histogram == set_stats.length_histogram, true);
+  TEST_EQUAL("active tracks", file_stats.active_tracks == set_stats.active_tracks, true);
+  TEST_EQUAL("new tracks", file_stats.new_tracks == set_stats.new_tracks, true);
+  TEST_EQUAL("terminated tracks", file_stats.terminated_tracks == set_stats.terminated_tracks, true);
+}
+
+
+IMPLEMENT_TEST(offset_frame_ids)
+{
+  using namespace kwiver;
+
+  // frame numbers far from zero, arriving out of order
+  maptk::track_columns columns;
+  columns.add_state(0, 100002);
+  columns.add_state(0, 100003);
+  columns.add_state(1, 100000);
+  columns.add_state(1, 100001);
+  columns.add_state(1, 100003);
+
+  TEST_EQUAL("frame storage is bounded by the frame range",
+             columns.frame_states().size() <= 8, true);
+
+  auto const stats = maptk::compute_track_statistics(columns);
+  TEST_EQUAL("first frame", stats.first_frame, 100000);
+  TEST_EQUAL("last frame", stats.last_frame, 100003);
+
+  unsigned const active[4] = { 1, 1, 1, 2 };
+  TEST_EQUAL("number of frames", stats.active_tracks.size(), 4);
+  for (unsigned f = 0; f < 4; ++f)
+  {
+    TEST_EQUAL("active tracks on frame " << f, stats.active_tracks[f], active[f]);
+  }
+}
+
+
+IMPLEMENT_TEST(reprojection_error)
+{
+  using namespace kwiver;
+  using namespace kwiver::vital;
+
+  // cameras at the origin looking down +Z with identity intrinsics
+  camera_map::map_camera_t cams;
+  for (frame_id_t f = 0; f < 4; ++f)
+  {
+    cams[f] = std::make_shared<simple_camera>();
+  }
+
+  // landmark 0 projects exactly onto (0, f) only for frame 0
+  landmark_map::map_landmark_t lms;
+  lms[0] = std::make_shared<landmark_d>(vector_3d(0, 0, 1));
+
+  auto const columns =
+    maptk::track_set_columns(*make_tracks(),
+                             std::make_shared<simple_camera_map>(cams),
+                             std::make_shared<simple_landmark_map>(lms));
+  auto const stats = maptk::compute_track_statistics(columns);
+
+  TEST_EQUAL("number of measurements", stats.num_reprojection_errors, 4);
+  TEST_NEAR("maximum error", stats.reprojection_max, 3.0, 1e-6);
+  TEST_NEAR("RMSE", stats.reprojection_rmse, std::sqrt(14.0 / 4.0), 1e-6);
+}
@@ -0,0 +1,80 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ *
+ * \brief Functions for creating simple synthetic tracks
+ *
+ * These functions are shared by tests of track set derived structures
+ */
+
+#ifndef MAPTK_TEST_TEST_TRACKS_H_
+#define MAPTK_TEST_TEST_TRACKS_H_
+
+#include <vital/types/descriptor.h>
+#include <vital/types/feature.h>
+#include <vital/types/track.h>
+
+#include <vital/vital_foreach.h>
+
+#include <memory>
+#include <vector>
+
+
+namespace kwiver {
+namespace maptk {
+
+namespace testing
+{
+
+// construct a track with states at the origin on the given frames
+kwiver::vital::track_sptr
+make_track(kwiver::vital::track_id_t id,
+           std::vector<kwiver::vital::frame_id_t> const& frames)
+{
+  using namespace kwiver::vital;
+
+  auto t = std::make_shared<track>();
+  t->set_id(id);
+  VITAL_FOREACH (auto const f, frames)
+  {
+    auto feat = std::make_shared<feature_d>(vector_2d(0, 0));
+    t->append(track::track_state(f, feat, descriptor_sptr()));
+  }
+  return t;
+}
+
+} // end namespace testing
+
+} // end namespace maptk
+} // end namespace kwiver
+
+#endif // MAPTK_TEST_TEST_TRACKS_H_
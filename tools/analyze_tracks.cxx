@@ -31,6 +31,8 @@
 #include <iostream>
 #include <fstream>
 #include <exception>
+#include <deque>
+#include <future>
 #include <string>
 #include <vector>
 
@@ -56,6 +58,10 @@
 #include <kwiversys/CommandLineArguments.hxx>
 
 #include <arrows/core/projected_track_set.h>
+#include <maptk/config_cache.h>
+#include <maptk/parallel.h>
+#include <maptk/plugin_registry.h>
+#include <maptk/track_statistics.h>
 #include <maptk/version.h>
 
 typedef kwiversys::SystemTools     ST;
@@ -93,6 +99,22 @@ static kwiver::vital::config_block_sptr default_config()
   config->set_value( "comparison_camera_dir", "",
                      "Path to an optional camera directory, which can be used alongside "
                      "a landmark ply file to generate a comparison track set." );
+  config->set_value( "columnar_statistics", false,
+                     "If true, compute track statistics by streaming the track file "
+                     "into flat per-track and per-frame arrays instead of running the "
+                     "track_analyzer algorithm on a fully loaded track set. This uses "
+                     "a fraction of the memory on large track files. If the "
+                     "comparison landmark file, camera directory and image list are "
+                     "all given, reprojection error statistics are included." );
+  config->set_value( "num_threads", 1,
+                     "Number of worker threads used to read images while drawing "
+                     "tracks. Use 0 for the number of hardware threads. Images "
+                     "are decoded on worker threads, at most this many ahead of "
+                     "the frame being drawn. Drawing, and writing the drawn "
+                     "images if the track drawer is configured to, remains "
+                     "serial in frame order since the track drawer keeps state "
+                     "across frames, so the speedup is limited by the drawing "
+                     "time per frame." );
 
   kwiver::vital::algo::analyze_tracks::get_nested_algo_configuration(
     "track_analyzer", config, kwiver::vital::algo::analyze_tracks_sptr() );
@@ -111,7 +133,8 @@ static bool check_config( kwiver::vital::config_block_sptr config )
     return false;
   }
 
-  if( !kwiver::vital::algo::analyze_tracks::check_nested_algo_configuration( "track_analyzer", config ) )
+  if( !config->get_value<bool>( "columnar_statistics", false ) &&
+      !kwiver::vital::algo::analyze_tracks::check_nested_algo_configuration( "track_analyzer", config ) )
   {
     std::cerr << "Invalid analyze_tracks config" << std::endl;
     return false;
@@ -178,7 +201,14 @@ static int maptk_main(int argc, char const* argv[])
   // register the algorithm implementations
   std::string rel_plugin_path = kwiver::vital::get_executable_path() + "/../lib/modules";
   kwiver::vital::plugin_manager::instance().add_search_path(rel_plugin_path);
-  kwiver::vital::plugin_manager::instance().load_all_plugins();
+
+  // Writing a configuration lists every available implementation, so load
+  // all plugins; otherwise only load the plugins the configuration needs.
+  bool const lazy_plugins = opt_out_config.empty();
+  if( ! lazy_plugins )
+  {
+    kwiver::vital::plugin_manager::instance().load_all_plugins();
+  }
 
   // Set config to algo chain
   // Get config from algo chain after set
@@ -198,8 +228,8 @@ static int maptk_main(int argc, char const* argv[])
   if( ! opt_config.empty() )
   {
     const std::string prefix = kwiver::vital::get_executable_path() + "/..";
-    config->merge_config(kwiver::vital::read_config_file(opt_config, "maptk",
-                                                         MAPTK_VERSION, prefix));
+    config->merge_config(kwiver::maptk::read_cached_config_file(opt_config, "maptk",
+                                                                MAPTK_VERSION, prefix));
   }
 
   // Load all input images if they are specified
@@ -209,17 +239,26 @@ static int maptk_main(int argc, char const* argv[])
   bool output_to_file = config->has_value( "output_file" ) &&
                         !config->get_value<std::string>( "output_file" ).empty();
 
-  if( use_images )
+  // Configuring an algorithm can reveal nested algorithm types, so repeat
+  // until no more plugins are needed.
+  if( lazy_plugins )
   {
-    kwiver::vital::algo::image_io::set_nested_algo_configuration( "image_reader", config, image_reader );
-    kwiver::vital::algo::image_io::get_nested_algo_configuration( "image_reader", config, image_reader );
-
-    kwiver::vital::algo::draw_tracks::set_nested_algo_configuration( "track_drawer", config, draw_tracks );
-    kwiver::vital::algo::draw_tracks::get_nested_algo_configuration( "track_drawer", config, draw_tracks );
+    kwiver::maptk::load_plugins_for_config( config );
   }
+  do
+  {
+    if( use_images )
+    {
+      kwiver::vital::algo::image_io::set_nested_algo_configuration( "image_reader", config, image_reader );
+      kwiver::vital::algo::image_io::get_nested_algo_configuration( "image_reader", config, image_reader );
 
-  kwiver::vital::algo::analyze_tracks::set_nested_algo_configuration( "track_analyzer", config, analyze_tracks );
-  kwiver::vital::algo::analyze_tracks::get_nested_algo_configuration( "track_analyzer", config, analyze_tracks );
+      kwiver::vital::algo::draw_tracks::set_nested_algo_configuration( "track_drawer", config, draw_tracks );
+      kwiver::vital::algo::draw_tracks::get_nested_algo_configuration( "track_drawer", config, draw_tracks );
+    }
+
+    kwiver::vital::algo::analyze_tracks::set_nested_algo_configuration( "track_analyzer", config, analyze_tracks );
+    kwiver::vital::algo::analyze_tracks::get_nested_algo_configuration( "track_analyzer", config, analyze_tracks );
+  } while( lazy_plugins && kwiver::maptk::load_plugins_for_config( config ) );
 
   bool valid_config = check_config( config );
 
@@ -245,15 +284,74 @@ static int maptk_main(int argc, char const* argv[])
     return EXIT_FAILURE;
   }
 
+  std::string track_file = config->get_value<std::string>( "track_file" );
+
+  // Generate columnar statistics directly from the track file if enabled
+  bool const columnar_statistics = config->get_value<bool>( "columnar_statistics" );
+  if( columnar_statistics )
+  {
+    kwiver::vital::camera_map_sptr cameras;
+    kwiver::vital::landmark_map_sptr landmarks;
+    if( use_images &&
+        config->has_value( "comparison_landmark_file" ) &&
+        !config->get_value<std::string>( "comparison_landmark_file" ).empty() &&
+        config->has_value( "comparison_camera_dir" ) &&
+        !config->get_value<std::string>( "comparison_camera_dir" ).empty() )
+    {
+      std::vector<kwiver::vital::path_t> image_paths;
+      std::ifstream ifs( config->get_value<std::string>( "image_list_file" ).c_str() );
+      for( std::string line; std::getline(ifs,line); )
+      {
+        image_paths.push_back( line );
+      }
+
+      std::cout << std::endl << "Loading cameras and landmarks for reprojection error..." << std::endl;
+      landmarks = kwiver::vital::read_ply_file(
+        config->get_value<std::string>( "comparison_landmark_file" ) );
+      cameras = kwiver::vital::read_krtd_files(
+        image_paths, config->get_value<std::string>( "comparison_camera_dir" ) );
+    }
+
+    std::cout << std::endl << "Generating columnar track statistics..." << std::endl;
+
+    kwiver::maptk::track_statistics const stats =
+      kwiver::maptk::compute_track_statistics(
+        kwiver::maptk::read_track_file_columns( track_file, cameras, landmarks ) );
+
+    if( output_to_file )
+    {
+      std::string output_file = config->get_value<std::string>( "output_file" );
+      std::ofstream ofs( output_file.c_str() );
+
+      if( !ofs )
+      {
+        std::cerr << "Error: Could not open file " << output_file << " for writing." << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      kwiver::maptk::print_track_statistics( stats, ofs );
+    }
+    else
+    {
+      kwiver::maptk::print_track_statistics( stats, std::cout );
+    }
+  }
+
+  // The full track set is only needed for the track_analyzer or for drawing
+  if( columnar_statistics && !use_images )
+  {
+    std::cout << std::endl;
+    return EXIT_SUCCESS;
+  }
+
   // Load main track set
   kwiver::vital::track_set_sptr tracks;
 
   std::cout << std::endl << "Loading main track set file..." << std::endl;
-  std::string track_file = config->get_value<std::string>( "track_file" );
   tracks = kwiver::vital::read_track_file( track_file );
 
   // Generate statistics if enabled
-  if( analyze_tracks )
+  if( analyze_tracks && !columnar_statistics )
   {
     std::cout << std::endl << "Generating track statistics..." << std::endl;
 
@@ -337,20 +435,48 @@ static int maptk_main(int argc, char const* argv[])
       comparison_tracks = kwiver::arrows::projected_tracks( landmarks, cameras );
     }
 
-    // Read images one by one, this is more memory efficient than loading them all
+    // Read images ahead of drawing on worker threads, keeping at most
+    // num_threads decoded images in memory.  Each slot in the window has its
+    // own image reader so that no reader is used concurrently.  Drawing, and
+    // any writing the track drawer is configured to do, stays on this thread
+    // in frame order.
     std::cout << std::endl << "Generating feature images..." << std::endl;
 
+    size_t const num_slots = kwiver::maptk::resolve_num_threads(
+      config->get_value<unsigned>( "num_threads" ) );
+    std::vector<kwiver::vital::algo::image_io_sptr> slot_readers( num_slots );
+    slot_readers[0] = image_reader;
+    for( size_t s = 1; s < num_slots; ++s )
+    {
+      kwiver::vital::algo::image_io::set_nested_algo_configuration( "image_reader", config, slot_readers[s] );
+    }
+
+    std::deque< std::future<kwiver::vital::image_container_sptr> > pending;
+    size_t next_load = 0;
+    auto const launch_load = [&]()
+    {
+      kwiver::vital::path_t const& path = image_paths[next_load];
+      if( !ST::FileExists( path ) )
+      {
+        throw kwiver::vital::path_not_exists( path );
+      }
+      kwiver::vital::algo::image_io_sptr const reader = slot_readers[next_load % num_slots];
+      pending.push_back( std::async( std::launch::async,
+                                     [reader, path]() { return reader->load( path ); } ) );
+      ++next_load;
+    };
+
     for( unsigned i = 0; i < image_paths.size(); i++ )
     {
-      if( !ST::FileExists( image_paths[i] ) )
+      while( next_load < image_paths.size() && next_load < i + num_slots )
       {
-        throw kwiver::vital::path_not_exists( image_paths[i] );
+        launch_load();
       }
 
       kwiver::vital::image_container_sptr_list images;
 
-      kwiver::vital::image_container_sptr image = image_reader->load( image_paths[i] );
-      images.push_back( image );
+      images.push_back( pending.front().get() );
+      pending.pop_front();
 
       // Draw tracks on images
       draw_tracks->draw( tracks, images, comparison_tracks );
@@ -70,10 +70,13 @@
 #include <arrows/core/match_matrix.h>
 #include <arrows/core/transform.h>
 
+#include <maptk/config_cache.h>
 #include <maptk/colorize.h>
 #include <maptk/geo_reference_points_io.h>
 #include <maptk/ins_data_io.h>
 #include <maptk/local_geo_cs.h>
+#include <maptk/match_matrix_builder.h>
+#include <maptk/plugin_registry.h>
 #include <maptk/version.h>
 
 typedef kwiversys::SystemTools     ST;
@@ -361,7 +364,9 @@ filter_tracks_importance(kwiver::vital::track_set_sptr tracks, double min_score)
 
   // compute the match matrix
   std::vector<vital::frame_id_t> frames;
-  Eigen::SparseMatrix<unsigned int> mm = kwiver::arrows::match_matrix(tracks, frames);
+  maptk::match_matrix_builder builder( 0 );
+  builder.update( *tracks );
+  Eigen::SparseMatrix<unsigned int> mm = builder.matrix( frames );
 
   // compute the importance scores on the tracks
   std::map<vital::track_id_t, double> importance =
@@ -648,7 +653,14 @@ static int maptk_main(int argc, char const* argv[])
   // register the algorithm implementations
   std::string rel_plugin_path = kwiver::vital::get_executable_path() + "/../lib/modules";
   kwiver::vital::plugin_manager::instance().add_search_path(rel_plugin_path);
-  kwiver::vital::plugin_manager::instance().load_all_plugins();
+
+  // Writing a configuration lists every available implementation, so load
+  // all plugins; otherwise only load the plugins the configuration needs.
+  bool const lazy_plugins = opt_out_config.empty();
+  if( ! lazy_plugins )
+  {
+    kwiver::vital::plugin_manager::instance().load_all_plugins();
+  }
 
   // Set config to algo chain
   // Get config from algo chain after set
@@ -671,17 +683,32 @@ static int maptk_main(int argc, char const* argv[])
   if( ! opt_config.empty() )
   {
     const std::string prefix = kwiver::vital::get_executable_path() + "/..";
-    config->merge_config(kwiver::vital::read_config_file(opt_config, "maptk",
-                                                         MAPTK_VERSION, prefix));
+    config->merge_config(kwiver::maptk::read_cached_config_file(opt_config, "maptk",
+                                                                MAPTK_VERSION, prefix));
   }
 
+  // Configuring an algorithm can reveal nested algorithm types, so repeat
+  // until no more plugins are needed.
+  if( lazy_plugins )
+  {
+    kwiver::maptk::load_plugins_for_config( config );
+  }
+  do
+  {
+    kwiver::vital::algo::bundle_adjust::set_nested_algo_configuration("bundle_adjuster", config, bundle_adjuster);
+    kwiver::vital::algo::triangulate_landmarks::set_nested_algo_configuration("triangulator", config, triangulator);
+    kwiver::vital::algo::initialize_cameras_landmarks::set_nested_algo_configuration("initializer", config, initializer);
+    kwiver::vital::algo::geo_map::set_nested_algo_configuration("geo_mapper", config, geo_mapper);
+    kwiver::vital::algo::estimate_similarity_transform::set_nested_algo_configuration("st_estimator", config, st_estimator);
+    kwiver::vital::algo::estimate_canonical_transform::set_nested_algo_configuration("can_tfm_estimator", config, can_tfm_estimator);
 
-  kwiver::vital::algo::bundle_adjust::set_nested_algo_configuration("bundle_adjuster", config, bundle_adjuster);
-  kwiver::vital::algo::triangulate_landmarks::set_nested_algo_configuration("triangulator", config, triangulator);
-  kwiver::vital::algo::initialize_cameras_landmarks::set_nested_algo_configuration("initializer", config, initializer);
-  kwiver::vital::algo::geo_map::set_nested_algo_configuration("geo_mapper", config, geo_mapper);
-  kwiver::vital::algo::estimate_similarity_transform::set_nested_algo_configuration("st_estimator", config, st_estimator);
-  kwiver::vital::algo::estimate_canonical_transform::set_nested_algo_configuration("can_tfm_estimator", config, can_tfm_estimator);
+    kwiver::vital::algo::bundle_adjust::get_nested_algo_configuration("bundle_adjuster", config, bundle_adjuster);
+    kwiver::vital::algo::triangulate_landmarks::get_nested_algo_configuration("triangulator", config, triangulator);
+    kwiver::vital::algo::initialize_cameras_landmarks::get_nested_algo_configuration("initializer", config, initializer);
+    kwiver::vital::algo::geo_map::get_nested_algo_configuration("geo_mapper", config, geo_mapper);
+    kwiver::vital::algo::estimate_similarity_transform::get_nested_algo_configuration("st_estimator", config, st_estimator);
+    kwiver::vital::algo::estimate_canonical_transform::get_nested_algo_configuration("can_tfm_estimator", config, can_tfm_estimator);
+  } while( lazy_plugins && kwiver::maptk::load_plugins_for_config( config ) );
 
   kwiver::vital::config_block_sptr dflt_config = default_config();
   dflt_config->merge_config(config);
@@ -691,13 +718,6 @@ static int maptk_main(int argc, char const* argv[])
 
   if( ! opt_out_config.empty() )
   {
-    kwiver::vital::algo::bundle_adjust::get_nested_algo_configuration("bundle_adjuster", config, bundle_adjuster);
-    kwiver::vital::algo::triangulate_landmarks::get_nested_algo_configuration("triangulator", config, triangulator);
-    kwiver::vital::algo::initialize_cameras_landmarks::get_nested_algo_configuration("initializer", config, initializer);
-    kwiver::vital::algo::geo_map::get_nested_algo_configuration("geo_mapper", config, geo_mapper);
-    kwiver::vital::algo::estimate_similarity_transform::get_nested_algo_configuration("st_estimator", config, st_estimator);
-    kwiver::vital::algo::estimate_canonical_transform::get_nested_algo_configuration("can_tfm_estimator", config, can_tfm_estimator);
-
     write_config_file(config, opt_out_config );
     if(valid_config)
     {
@@ -0,0 +1,425 @@
+/*ckwg +29
+ * Copyright 2017 by Kitware, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *  * Redistributions of source code must retain the above copyright notice,
+ *    this list of conditions and the following disclaimer.
+ *
+ *  * Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ *  * Neither name of Kitware, Inc. nor the names of any contributors may be used
+ *    to endorse or promote products derived from this software without specific
+ *    prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS ``AS IS''
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE AUTHORS OR CONTRIBUTORS BE LIABLE FOR
+ * ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * \brief Generate reference homographies from an existing track file
+ */
+
+#include <algorithm>
+#include <iostream>
+#include <fstream>
+#include <exception>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <maptk/config_cache.h>
+#include <maptk/parallel.h>
+
+#include <vital/config/config_block.h>
+#include <vital/config/config_block_io.h>
+#include <vital/logger/logger.h>
+#include <vital/vital_foreach.h>
+
+#include <vital/exceptions.h>
+#include <vital/io/track_set_io.h>
+#include <vital/vital_types.h>
+#include <vital/algo/compute_ref_homography.h>
+#include <vital/plugin_loader/plugin_manager.h>
+#include <vital/util/get_paths.h>
+
+#include <kwiversys/SystemTools.hxx>
+#include <kwiversys/CommandLineArguments.hxx>
+
+#include <maptk/plugin_registry.h>
+#include <maptk/version.h>
+
+typedef kwiversys::SystemTools ST;
+typedef kwiversys::CommandLineArguments argT;
+
+static kwiver::vital::logger_handle_t main_logger( kwiver::vital::get_logger( "compute_homographies_tool" ) );
+
+// ------------------------------------------------------------------
+static kwiver::vital::config_block_sptr default_config()
+{
+  kwiver::vital::config_block_sptr config = kwiver::vital::config_block::empty_config("compute_homographies_tool");
+
+  config->set_value("input_tracks_file", "",
+                    "Path to an input file containing feature tracks, as "
+                    "written by the track features tool.");
+  config->set_value("output_homography_file", "",
+                    "Path to a file to write source-to-reference "
+                    "homographies for each frame. If this file exists, it "
+                    "will be overwritten.");
+  config->set_value("num_threads", 1,
+                    "Number of threads used to compute homographies. Use 0 "
+                    "for the number of hardware threads. The frame range is "
+                    "split into one contiguous block per thread and each "
+                    "block is processed by its own homography generator, so "
+                    "with more than one thread a new reference frame is "
+                    "started at each block boundary. Use 1 to process all "
+                    "frames with a single generator, as the track features "
+                    "tool does.");
+
+  kwiver::vital::algo::compute_ref_homography::get_nested_algo_configuration("output_homography_generator",
+                              config, kwiver::vital::algo::compute_ref_homography_sptr());
+  return config;
+}
+
+
+// ------------------------------------------------------------------
+static bool check_config(kwiver::vital::config_block_sptr config)
+{
+  bool config_valid = true;
+
+#define MAPTK_CONFIG_FAIL(msg) \
+  LOG_ERROR(main_logger, "Config Check Fail: " << msg); \
+  config_valid = false
+
+  if ( ! config->has_value("input_tracks_file") ||
+      config->get_value<std::string>("input_tracks_file") == "")
+  {
+    MAPTK_CONFIG_FAIL("Config needs value input_tracks_file");
+  }
+  else
+  {
+    std::string path = config->get_value<std::string>("input_tracks_file");
+    if ( ! ST::FileExists( kwiver::vital::path_t(path), true ) )
+    {
+      MAPTK_CONFIG_FAIL("input_tracks_file path, " << path << ", does not exist or is not a regular file");
+    }
+  }
+
+  if ( ! config->has_value("output_homography_file") ||
+      config->get_value<std::string>("output_homography_file") == "")
+  {
+    MAPTK_CONFIG_FAIL("Config needs value output_homography_file");
+  }
+  else
+  {
+    kwiver::vital::config_path_t fp = config->get_value<kwiver::vital::config_path_t>("output_homography_file");
+    if ( ST::FileIsDirectory( fp ) )
+    {
+      MAPTK_CONFIG_FAIL("Given output homography file is a directory! "
+                        << "(Given: " << fp << ")");
+    }
+    else if ( ST::GetFilenamePath( fp ) != "" &&
+              ! ST::FileIsDirectory( ST::GetFilenamePath( fp ) ))
+    {
+      MAPTK_CONFIG_FAIL("Given output homography file does not have a valid "
+                        << "parent path! (Given: " << fp << ")");
+    }
+  }
+
+  if( !kwiver::vital::algo::compute_ref_homography
+           ::check_nested_algo_configuration("output_homography_generator",
+                                             config) )
+  {
+    MAPTK_CONFIG_FAIL("output_homography_generator configuration check failed");
+  }
+
+#undef MAPTK_CONFIG_FAIL
+
+  return config_valid;
+}
+
+
+// ------------------------------------------------------------------
+/// Index the tracks active on each frame in [first_frame, last_frame]
+/**
+ * The reference homography estimator only looks at the tracks active on the
+ * frame being estimated, so handing it a per-frame subset avoids a scan over
+ * every track in the set for every frame.
+ */
+static std::vector<kwiver::vital::track_set_sptr>
+index_tracks_by_frame( kwiver::vital::track_set const& tracks,
+                       kwiver::vital::frame_id_t first_frame,
+                       kwiver::vital::frame_id_t last_frame )
+{
+  using namespace kwiver;
+
+  std::vector< std::vector<vital::track_sptr> >
+    frame_tracks( last_frame - first_frame + 1 );
+  VITAL_FOREACH( auto const& trk, tracks.tracks() )
+  {
+    VITAL_FOREACH( auto const& ts, *trk )
+    {
+      frame_tracks[ts.frame_id - first_frame].push_back( trk );
+    }
+  }
+
+  std::vector<vital::track_set_sptr> index;
+  index.reserve( frame_tracks.size() );
+  VITAL_FOREACH( auto const& ft, frame_tracks )
+  {
+    index.push_back( std::make_shared<vital::simple_track_set>( ft ) );
+  }
+  return index;
+}
+
+
+// ------------------------------------------------------------------
+/// Copies of tracks that end at the frame being processed
+/**
+ * The track features tool estimates each homography while the tracks only
+ * extend to the current frame.  To hand the estimator the same tracks, this
+ * keeps a copy of each active track and appends one state per frame as the
+ * frames of a block are processed in order.
+ */
+class partial_tracks
+{
+public:
+  /// Return the active tracks on \p frame, truncated after \p frame
+  /**
+   * \p active holds the complete tracks active on \p frame.  Frames must
+   * be visited in increasing order.
+   */
+  kwiver::vital::track_set_sptr
+  advance( kwiver::vital::track_set const& active,
+           kwiver::vital::frame_id_t frame )
+  {
+    using namespace kwiver;
+
+    std::vector<vital::track_sptr> truncated;
+    VITAL_FOREACH( auto const& trk, active.tracks() )
+    {
+      auto& copy = tracks_[trk->id()];
+      if ( ! copy )
+      {
+        // first visit in this block; copy the earlier states too
+        copy = std::make_shared<vital::track>();
+        copy->set_id( trk->id() );
+        for ( auto ts = trk->begin(); ts != trk->end() && ts->frame_id <= frame; ++ts )
+        {
+          copy->append( *ts );
+        }
+      }
+      else
+      {
+        copy->append( *trk->find( frame ) );
+      }
+      truncated.push_back( copy );
+
+      // later frames no longer need a track that ends here
+      if ( trk->last_frame() == frame )
+      {
+        tracks_.erase( trk->id() );
+      }
+    }
+    return std::make_shared<vital::simple_track_set>( truncated );
+  }
+
+private:
+  std::map<kwiver::vital::track_id_t, kwiver::vital::track_sptr> tracks_;
+};
+
+
+// ------------------------------------------------------------------
+static int maptk_main(int argc, char const* argv[])
+{
+  static bool        opt_help(false);
+  static std::string opt_config;
+  static std::string opt_out_config;
+
+  kwiversys::CommandLineArguments arg;
+
+  arg.Initialize( argc, argv );
+
+  arg.AddArgument( "--help",        argT::NO_ARGUMENT, &opt_help, "Display usage information" );
+  arg.AddArgument( "-h",            argT::NO_ARGUMENT, &opt_help, "Display usage information" );
+  arg.AddArgument( "--config",      argT::SPACE_ARGUMENT, &opt_config, "Configuration file for tool" );
+  arg.AddArgument( "-c",            argT::SPACE_ARGUMENT, &opt_config, "Configuration file for tool" );
+  arg.AddArgument( "--output-config", argT::SPACE_ARGUMENT, &opt_out_config,
+                   "Output a configuration. This may be seeded with a configuration file from -c/--config." );
+  arg.AddArgument( "-o",            argT::SPACE_ARGUMENT, &opt_out_config,
+                   "Output a configuration. This may be seeded with a configuration file from -c/--config." );
+
+  if ( ! arg.Parse() )
+  {
+    LOG_ERROR(main_logger, "Problem parsing arguments");
+    return EXIT_FAILURE;
+  }
+
+  if ( opt_help )
+  {
+    std::cout
+      << "USAGE: " << argv[0] << " [OPTS]\n\n"
+      << "Regenerate the reference homographies for an existing track file\n\n"
+      << "Options:"
+      << arg.GetHelp() << std::endl;
+    return EXIT_SUCCESS;
+  }
+
+  // register the algorithm implementations
+  std::string rel_plugin_path = kwiver::vital::get_executable_path() + "/../lib/modules";
+  kwiver::vital::plugin_manager::instance().add_search_path(rel_plugin_path);
+
+  // Writing a configuration lists every available implementation, so load
+  // all plugins; otherwise only load the plugins the configuration needs.
+  bool const lazy_plugins = opt_out_config.empty();
+  if( ! lazy_plugins )
+  {
+    kwiver::vital::plugin_manager::instance().load_all_plugins();
+  }
+
+  // Set up top level configuration w/ defaults where applicable.
+  kwiver::vital::config_block_sptr config = default_config();
+  kwiver::vital::algo::compute_ref_homography_sptr out_homog_generator;
+
+  // If -c/--config given, read in confg file, merge in with default just generated
+  if( ! opt_config.empty() )
+  {
+    const std::string prefix = kwiver::vital::get_executable_path() + "/..";
+    config->merge_config(kwiver::maptk::read_cached_config_file(opt_config, "maptk",
+                                                                MAPTK_VERSION, prefix));
+  }
+
+  // Configuring an algorithm can reveal nested algorithm types, so repeat
+  // until no more plugins are needed.
+  if( lazy_plugins )
+  {
+    kwiver::maptk::load_plugins_for_config( config );
+  }
+  do
+  {
+    kwiver::vital::algo::compute_ref_homography::set_nested_algo_configuration("output_homography_generator", config, out_homog_generator);
+    kwiver::vital::algo::compute_ref_homography::get_nested_algo_configuration("output_homography_generator", config, out_homog_generator);
+  } while( lazy_plugins && kwiver::maptk::load_plugins_for_config( config ) );
+
+  bool valid_config = check_config(config);
+
+  if( ! opt_out_config.empty() )
+  {
+    write_config_file(config, opt_out_config );
+    if(valid_config)
+    {
+      LOG_INFO(main_logger, "Configuration file contained valid parameters and may be used for running");
+    }
+    else
+    {
+      LOG_WARN(main_logger, "Configuration deemed not valid.");
+    }
+    return EXIT_SUCCESS;
+  }
+  else if(!valid_config)
+  {
+    LOG_ERROR(main_logger, "Configuration not valid.");
+    return EXIT_FAILURE;
+  }
+
+  std::string input_tracks_file = config->get_value<std::string>("input_tracks_file");
+  kwiver::vital::path_t homog_fp = config->get_value<kwiver::vital::path_t>("output_homography_file");
+  unsigned num_threads = kwiver::maptk::resolve_num_threads(
+    config->get_value<unsigned>("num_threads") );
+
+  // verify that we can open the output file for writing
+  std::ofstream homog_ofs( homog_fp.c_str() );
+  if ( !homog_ofs )
+  {
+    LOG_ERROR(main_logger, "Could not open homography file for writing: "
+                           << homog_fp);
+    return EXIT_FAILURE;
+  }
+
+  LOG_INFO(main_logger, "loading tracks: " << input_tracks_file);
+  kwiver::vital::track_set_sptr tracks = kwiver::vital::read_track_file(input_tracks_file);
+  if ( !tracks || tracks->empty() )
+  {
+    LOG_ERROR(main_logger, "No tracks loaded from " << input_tracks_file);
+    return EXIT_FAILURE;
+  }
+
+  // Homographies are written for every frame from zero through the last
+  // tracked frame, matching the output of the track features tool.
+  kwiver::vital::frame_id_t const last_frame = tracks->last_frame();
+  auto const frame_index = index_tracks_by_frame( *tracks, 0, last_frame );
+  std::vector<kwiver::vital::f2f_homography_sptr> homogs( frame_index.size() );
+
+  // The estimator is stateful, so each contiguous block of frames gets its
+  // own instance, created up front on this thread.
+  size_t const num_blocks = std::min<size_t>( num_threads, homogs.size() );
+  std::vector<kwiver::vital::algo::compute_ref_homography_sptr> generators( num_blocks );
+  generators[0] = out_homog_generator;
+  for ( size_t b = 1; b < num_blocks; ++b )
+  {
+    kwiver::vital::algo::compute_ref_homography
+      ::set_nested_algo_configuration( "output_homography_generator",
+                                       config, generators[b] );
+  }
+
+  LOG_INFO(main_logger, "computing homographies for " << homogs.size()
+                        << " frames using " << num_blocks << " thread(s)");
+  kwiver::maptk::parallel_for( num_blocks, num_threads,
+    [&]( size_t b )
+    {
+      size_t const begin = ( homogs.size() * b ) / num_blocks;
+      size_t const end = ( homogs.size() * ( b + 1 ) ) / num_blocks;
+      partial_tracks partial;
+      for ( size_t f = begin; f < end; ++f )
+      {
+        auto const frame = static_cast<kwiver::vital::frame_id_t>( f );
+        homogs[f] = generators[b]->estimate(
+          frame, partial.advance( *frame_index[f], frame ) );
+      }
+    } );
+
+  LOG_INFO(main_logger, "writing homographies to: " << homog_fp);
+  VITAL_FOREACH( auto const& h, homogs )
+  {
+    homog_ofs << *h << std::endl;
+  }
+  homog_ofs.close();
+
+  return EXIT_SUCCESS;
+}
+
+
+// ------------------------------------------------------------------
+int main(int argc, char const* argv[])
+{
+  try
+  {
+    return maptk_main(argc, argv);
+  }
+  catch (std::exception const& e)
+  {
+    LOG_ERROR(main_logger, "Exception caught: " << e.what());
+
+    return EXIT_FAILURE;
+  }
+  catch (...)
+  {
+    LOG_ERROR(main_logger, "Unknown exception caught");
+
+    return EXIT_FAILURE;
+  }
+}
@@ -33,8 +33,14 @@
  * \brief Image homography estimation utility
  */
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <fstream>
+#include <memory>
+#include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <vital/config/config_block.h>
@@ -58,6 +64,10 @@
 #include <kwiversys/SystemTools.hxx>
 #include <kwiversys/CommandLineArguments.hxx>
 
+#include <maptk/config_cache.h>
+#include <maptk/feature_cache.h>
+#include <maptk/parallel.h>
+#include <maptk/plugin_registry.h>
 #include <maptk/version.h>
 
 typedef kwiversys::SystemTools     ST;
@@ -71,6 +81,7 @@ static void print_usage(std::string const &prog_name,
 {
   std::cout << std::endl
             << "USAGE: " << prog_name << " [OPTS] img1 img2 output_file\n"
+            << "       " << prog_name << " [OPTS] --image-list file --batch-mode mode output_file\n"
             << std::endl
             << "Options:"
             << args.GetHelp() << std::endl
@@ -79,7 +90,11 @@ static void print_usage(std::string const &prog_name,
             << "    output_file - File to receive generated homography transformation between input frames.\n"
             << "                  This ends up including two homographies: An identity associated to\n"
             << "                  the first frame and then an actual homography describing the\n"
-            << "                  transformation to the second frame."
+            << "                  transformation to the second frame.\n"
+            << "                  In batch mode, the file contains one homography per image pair,\n"
+            << "                  each preceded by a line \"i j\" giving the image list indices\n"
+            << "                  of the second and first image of the pair, in the order the\n"
+            << "                  pairs were given."
             << std::endl;
 }
 
@@ -116,6 +131,15 @@ static kwiver::vital::config_block_sptr default_config()
 
   config->set_value("homog_estimator:type", "vxl");
 
+  config->set_value("feature_cache_directory", "",
+                    "Optional directory of cached features and descriptors. "
+                    "Entries are keyed by the image and mask file contents and "
+                    "the image_reader, image_converter, feature_detector and "
+                    "descriptor_extractor configuration, so only a change to "
+                    "one of those causes features to be detected again. "
+                    "maptk_track_features stores the features it tracks in "
+                    "the same format.");
+
   // expand algo config from defaults above if any
 #define get_default(type, name) \
   kwiver::vital::algo::type::get_nested_algo_configuration( #name, config, kwiver::vital::algo::type##_sptr() );
@@ -152,6 +176,287 @@ static bool check_config(kwiver::vital::config_block_sptr config)
 }
 
 
+/// Algorithm instances used by one worker thread
+struct algo_set
+{
+#define define_algo(type, name)  kwiver::vital::algo::type##_sptr name
+
+  tool_algos(define_algo);
+
+#undef define_algo
+};
+
+
+/// Features and descriptors computed for one image
+struct image_features
+{
+  kwiver::vital::feature_set_sptr features;
+  kwiver::vital::descriptor_set_sptr descriptors;
+};
+
+
+/// Optional feature cache and the hash of the configuration it is keyed by
+struct cache_settings
+{
+  std::unique_ptr<kwiver::maptk::feature_cache> cache;
+  uint64_t config_hash;
+};
+
+
+/// Set up the feature cache if one is configured
+static cache_settings
+make_cache_settings(kwiver::vital::config_block_sptr config)
+{
+  cache_settings settings;
+  settings.config_hash = 0;
+  std::string const dir = config->get_value<std::string>("feature_cache_directory", "");
+  if( dir.empty() )
+  {
+    return settings;
+  }
+  settings.cache.reset( new kwiver::maptk::feature_cache( dir ) );
+
+  // Only the algorithms which affect the detected features are part of the key
+  settings.config_hash = kwiver::maptk::feature_cache::hash_config(
+    kwiver::maptk::feature_cache::detection_config(
+      config->subblock( "image_reader" ),
+      config->subblock( "image_converter" ),
+      config->subblock( "feature_detector" ),
+      config->subblock( "descriptor_extractor" ) ) );
+  LOG_INFO(main_logger, "Using feature cache: " << dir);
+  return settings;
+}
+
+
+/// Detect features and extract descriptors on an image
+/**
+ * If a feature cache is configured, features stored for the same image,
+ * mask and configuration are loaded instead of decoding the image, and
+ * newly computed features are stored.
+ */
+static image_features
+compute_image_features(algo_set const& a,
+                       kwiver::vital::path_t const& image_file,
+                       kwiver::vital::image_container_sptr const& mask,
+                       kwiver::vital::path_t const& mask_file,
+                       cache_settings const& cache)
+{
+  image_features result;
+  std::string key;
+  if( cache.cache )
+  {
+    key = kwiver::maptk::feature_cache::make_key( image_file, cache.config_hash,
+                                                  mask_file );
+    if( cache.cache->load( key, result.features, result.descriptors ) )
+    {
+      LOG_DEBUG(main_logger, "-- Loaded cached features for " << image_file);
+      return result;
+    }
+  }
+
+  kwiver::vital::image_container_sptr image =
+    a.image_converter->convert( a.image_reader->load( image_file ) );
+  // if no mask was loaded, the mask is the default value
+  // (uninitialized sptr)
+  result.features = a.feature_detector->detect( image, mask );
+  result.descriptors = a.descriptor_extractor->extract( image, result.features );
+
+  if( cache.cache && ! cache.cache->store( key, result.features, result.descriptors ) )
+  {
+    LOG_WARN(main_logger, "Could not store features for " << image_file
+             << " in the feature cache");
+  }
+  return result;
+}
+
+
+/// Read an image list file, one path per line
+static std::vector<kwiver::vital::path_t>
+read_image_list(std::string const& list_file)
+{
+  std::ifstream ifs( list_file.c_str() );
+  if( ! ifs )
+  {
+    throw kwiver::vital::path_not_exists( list_file );
+  }
+  std::vector<kwiver::vital::path_t> files;
+  for( std::string line; std::getline( ifs, line ); )
+  {
+    if( line.empty() )
+    {
+      continue;
+    }
+    if( ! ST::FileExists( line, true ) )
+    {
+      throw kwiver::vital::path_not_exists( line );
+    }
+    files.push_back( line );
+  }
+  return files;
+}
+
+
+/// Build the list of (first, second) image index pairs for a batch mode
+static std::vector< std::pair<size_t, size_t> >
+make_batch_pairs(std::string const& mode, size_t num_images,
+                 int reference, std::string const& pairs_file)
+{
+  std::vector< std::pair<size_t, size_t> > pairs;
+  if( mode == "consecutive" )
+  {
+    for( size_t i = 1; i < num_images; ++i )
+    {
+      pairs.push_back( std::make_pair( i - 1, i ) );
+    }
+  }
+  else if( mode == "reference" )
+  {
+    if( reference < 0 || static_cast<size_t>( reference ) >= num_images )
+    {
+      throw kwiver::vital::invalid_value( "Reference image index is outside "
+                                          "the image list" );
+    }
+    size_t const r = static_cast<size_t>( reference );
+    for( size_t i = 0; i < num_images; ++i )
+    {
+      if( i != r )
+      {
+        pairs.push_back( std::make_pair( r, i ) );
+      }
+    }
+  }
+  else if( mode == "pairs" )
+  {
+    std::ifstream ifs( pairs_file.c_str() );
+    if( ! ifs )
+    {
+      throw kwiver::vital::path_not_exists( pairs_file );
+    }
+    size_t line_num = 0;
+    for( std::string line; std::getline( ifs, line ); )
+    {
+      ++line_num;
+      std::istringstream ss( line );
+      long long a, b;
+      if( ! ( ss >> a ) )
+      {
+        continue; // blank line
+      }
+      if( ! ( ss >> b ) || a < 0 || b < 0 ||
+          static_cast<size_t>( a ) >= num_images ||
+          static_cast<size_t>( b ) >= num_images )
+      {
+        std::ostringstream msg;
+        msg << "Line " << line_num << " is not a pair of image list indices";
+        throw kwiver::vital::invalid_file( pairs_file, msg.str() );
+      }
+      pairs.push_back( std::make_pair( static_cast<size_t>( a ),
+                                       static_cast<size_t>( b ) ) );
+    }
+  }
+  else
+  {
+    throw kwiver::vital::invalid_value( "Unknown batch mode: " + mode );
+  }
+  return pairs;
+}
+
+
+/// Estimate homographies for many image pairs, reusing per-image features
+/**
+ * Features and descriptors are computed once for each image used by any
+ * pair, then matching and estimation run for all pairs.  Both stages are
+ * spread over \\p workers, each of which owns its own algorithm instances.
+ * Only the features and descriptors are kept, not the decoded images.
+ */
+static bool
+run_batch(std::vector<kwiver::vital::path_t> const& files,
+          std::vector< std::pair<size_t, size_t> > const& pairs,
+          std::vector<algo_set> const& workers,
+          kwiver::vital::image_container_sptr mask,
+          kwiver::vital::path_t const& mask_file,
+          cache_settings const& cache,
+          std::ostream& homog_output_stream)
+{
+  // Find the images used by any pair
+  std::vector<size_t> used_images;
+  {
+    std::vector<bool> used( files.size(), false );
+    VITAL_FOREACH( auto const& p, pairs )
+    {
+      used[p.first] = used[p.second] = true;
+    }
+    for( size_t i = 0; i < used.size(); ++i )
+    {
+      if( used[i] )
+      {
+        used_images.push_back( i );
+      }
+    }
+  }
+
+  LOG_INFO(main_logger, "Generating features and descriptors over "
+           << used_images.size() << " images using " << workers.size()
+           << " thread(s)...");
+  std::vector<image_features> features( files.size() );
+  std::atomic<size_t> next_image( 0 );
+  kwiver::maptk::parallel_for( workers.size(), workers.size(),
+    [&]( size_t w )
+    {
+      algo_set const& a = workers[w];
+      for( size_t n = next_image++; n < used_images.size(); n = next_image++ )
+      {
+        size_t const i = used_images[n];
+        features[i] = compute_image_features( a, files[i], mask, mask_file, cache );
+        LOG_DEBUG(main_logger, "-- Image " << i << " features / descriptors: "
+                  << features[i].descriptors->size());
+      }
+    } );
+
+  LOG_INFO(main_logger, "Matching features and estimating homographies for "
+           << pairs.size() << " pairs...");
+  std::vector<kwiver::vital::homography_sptr> homogs( pairs.size() );
+  std::atomic<size_t> next_pair( 0 );
+  kwiver::maptk::parallel_for( workers.size(), workers.size(),
+    [&]( size_t w )
+    {
+      algo_set const& a = workers[w];
+      for( size_t n = next_pair++; n < pairs.size(); n = next_pair++ )
+      {
+        // As in the single pair case, match from the second image to the
+        // first so the homography maps second image space to first.
+        image_features const& f1 = features[pairs[n].first];
+        image_features const& f2 = features[pairs[n].second];
+        kwiver::vital::match_set_sptr matches =
+          a.feature_matcher->match( f2.features, f2.descriptors,
+                                    f1.features, f1.descriptors );
+        std::vector<bool> inliers;
+        homogs[n] = a.homog_estimator->estimate( f2.features, f1.features,
+                                                 matches, inliers );
+      }
+    } );
+
+  bool all_valid = true;
+  for( size_t n = 0; n < pairs.size(); ++n )
+  {
+    homog_output_stream << pairs[n].second << " " << pairs[n].first << "\n";
+    if( homogs[n] )
+    {
+      homog_output_stream << *homogs[n] << std::endl;
+    }
+    else
+    {
+      LOG_ERROR(main_logger, "Failed to estimate valid homography for images "
+                << pairs[n].first << " and " << pairs[n].second
+                << "; writing identity.");
+      homog_output_stream << kwiver::vital::homography_<double>() << std::endl;
+      all_valid = false;
+    }
+  }
+  return all_valid;
+}
+
+
 static int maptk_main(int argc, char const* argv[])
 {
   //
@@ -163,6 +468,11 @@ static int maptk_main(int argc, char const* argv[])
   static double opt_inlier_scale(0);
   static std::string opt_mask_image;
   static std::string opt_mask2_image;
+  static std::string opt_image_list;
+  static std::string opt_batch_mode;
+  static std::string opt_pairs_file;
+  static int opt_reference(0);
+  static int opt_threads(1);
 
   kwiversys::CommandLineArguments arg;
   arg.StoreUnusedArguments(true);
@@ -214,6 +524,25 @@ static int maptk_main(int argc, char const* argv[])
                    "the first image. This mask is only considered if \"--mask-image\" is "
                    "provided.");
 
+  arg.AddArgument( "--image-list",  argT::SPACE_ARGUMENT, &opt_image_list,
+                   "Batch mode: file listing the input images, one per line. Images "
+                   "are referred to by their zero-based index in this list. Only "
+                   "\"--mask-image\" is used, and applies to every image.");
+  arg.AddArgument( "--batch-mode",  argT::SPACE_ARGUMENT, &opt_batch_mode,
+                   "Batch mode: which image pairs to process. \"consecutive\" pairs "
+                   "each image with the next, \"reference\" pairs the image given by "
+                   "\"--reference\" with every other image and \"pairs\" reads the "
+                   "pairs of indices given in \"--pairs\" (default: consecutive).");
+  arg.AddArgument( "--reference",   argT::SPACE_ARGUMENT, &opt_reference,
+                   "Batch mode: index of the reference image for the \"reference\" "
+                   "mode (default: 0).");
+  arg.AddArgument( "--pairs",       argT::SPACE_ARGUMENT, &opt_pairs_file,
+                   "Batch mode: file with one pair of image indices \"i j\" per line "
+                   "for the \"pairs\" mode. The homography maps image j to image i.");
+  arg.AddArgument( "--threads",     argT::SPACE_ARGUMENT, &opt_threads,
+                   "Batch mode: number of threads, each with its own algorithm "
+                   "instances (default: 1, 0 uses all hardware threads).");
+
   if ( ! arg.Parse() )
   {
     std::cerr << "Problem parsing arguments" << std::endl;
@@ -231,6 +560,7 @@ static int maptk_main(int argc, char const* argv[])
   // if only writing out a config, we don't need the image files
   std::vector<std::string> input_img_files;
   std::string homog_output_path;
+  bool const batch = ! opt_image_list.empty();
   if ( opt_out_config.empty() )
   {
     // Get positional file arguments
@@ -239,7 +569,7 @@ static int maptk_main(int argc, char const* argv[])
 
     arg.GetUnusedArguments( &pos_argc, &pos_argv );
 
-    if ( 4 != pos_argc )
+    if ( ( batch ? 2 : 4 ) != pos_argc )
     {
       std::cout << "Insufficient number of files specified after options.\n\n";
       print_usage( argv[0], arg );
@@ -247,16 +577,30 @@ static int maptk_main(int argc, char const* argv[])
     }
 
     // Note: pos_argv[0] is the executable name
-    input_img_files.push_back( pos_argv[1] );
-    input_img_files.push_back( pos_argv[2] );
+    if ( batch )
+    {
+      homog_output_path = pos_argv[1];
+    }
+    else
+    {
+      input_img_files.push_back( pos_argv[1] );
+      input_img_files.push_back( pos_argv[2] );
 
-    homog_output_path = pos_argv[3];
+      homog_output_path = pos_argv[3];
+    }
   }
 
   // register the algorithm implementations
   std::string rel_plugin_path = kwiver::vital::get_executable_path() + "/../lib/modules";
   kwiver::vital::plugin_manager::instance().add_search_path(rel_plugin_path);
-  kwiver::vital::plugin_manager::instance().load_all_plugins();
+
+  // Writing a configuration lists every available implementation, so load
+  // all plugins; otherwise only load the plugins the configuration needs.
+  bool const lazy_plugins = opt_out_config.empty();
+  if( ! lazy_plugins )
+  {
+    kwiver::vital::plugin_manager::instance().load_all_plugins();
+  }
 
   // Set config to algo chain
   // Get config from algo chain after set
@@ -284,16 +628,25 @@ static int maptk_main(int argc, char const* argv[])
   if( ! opt_config.empty() )
   {
     const std::string prefix = kwiver::vital::get_executable_path() + "/..";
-    config->merge_config(kwiver::vital::read_config_file(opt_config, "maptk",
-                                                         MAPTK_VERSION, prefix));
+    config->merge_config(kwiver::maptk::read_cached_config_file(opt_config, "maptk",
+                                                                MAPTK_VERSION, prefix));
   }
 
   // Set current configuration to algorithms and extract refined configuration.
+  // Configuring an algorithm can reveal nested algorithm types, so repeat
+  // until no more plugins are needed.
 #define sa(type, name)                                                       \
   kwiver::vital::algo::type::set_nested_algo_configuration( #name, config, name ); \
   kwiver::vital::algo::type::get_nested_algo_configuration( #name, config, name )
 
-  tool_algos(sa);
+  if( lazy_plugins )
+  {
+    kwiver::maptk::load_plugins_for_config( config );
+  }
+  do
+  {
+    tool_algos(sa);
+  } while( lazy_plugins && kwiver::maptk::load_plugins_for_config( config ) );
 
 #undef sa
 
@@ -319,28 +672,64 @@ static int maptk_main(int argc, char const* argv[])
     return EXIT_FAILURE;
   }
 
-  LOG_INFO(main_logger, "Loading images...");
+  cache_settings const cache = make_cache_settings( config );
 
-  kwiver::vital::image_container_sptr i1_image, i2_image;
-  try
-  {
-    i1_image = image_converter->convert(image_reader->load(input_img_files[0]));
-    i2_image = image_converter->convert(image_reader->load(input_img_files[1]));
-  }
-  catch (kwiver::vital::path_not_exists const &e)
-  {
-    LOG_ERROR(main_logger, e.what());
-    return EXIT_FAILURE;
-  }
-  catch (kwiver::vital::path_not_a_file const &e)
+  if ( batch )
   {
-    LOG_ERROR(main_logger, e.what());
-    return EXIT_FAILURE;
+    std::vector<kwiver::vital::path_t> const files = read_image_list( opt_image_list );
+    auto const pairs = make_batch_pairs( opt_batch_mode.empty() ? "consecutive"
+                                                                : opt_batch_mode,
+                                         files.size(), opt_reference,
+                                         opt_pairs_file );
+
+    std::ofstream homog_output_stream( homog_output_path.c_str() );
+    if (!homog_output_stream)
+    {
+      LOG_ERROR(main_logger, "Could not open output homog file: " << homog_output_path );
+      return EXIT_FAILURE;
+    }
+
+    // Algorithms may keep internal state, so each worker gets its own set
+    size_t const num_workers = std::max<size_t>(
+      std::min<size_t>( kwiver::maptk::resolve_num_threads(
+                          static_cast<unsigned>( std::max( opt_threads, 0 ) ) ),
+                        pairs.size() ), 1 );
+    std::vector<algo_set> workers( num_workers );
+#define copy_algo(type, name)  workers[0].name = name
+
+    tool_algos(copy_algo);
+
+#undef copy_algo
+#define create_algo(type, name)                                               \
+    kwiver::vital::algo::type::set_nested_algo_configuration( #name, config, \
+                                                              workers[w].name )
+
+    for ( size_t w = 1; w < num_workers; ++w )
+    {
+      tool_algos(create_algo);
+    }
+
+#undef create_algo
+
+    kwiver::vital::image_container_sptr mask;
+    if( ! opt_mask_image.empty() )
+    {
+      mask = image_converter->convert( image_reader->load( opt_mask_image ) );
+    }
+
+    bool const all_valid = run_batch( files, pairs, workers, mask,
+                                      opt_mask_image, cache,
+                                      homog_output_stream );
+    homog_output_stream.close();
+    LOG_INFO(main_logger, "-- '" << homog_output_path << "' finished writing");
+
+    return all_valid ? EXIT_SUCCESS : EXIT_FAILURE;
   }
 
   // load and convert mask images if they were given
   LOG_DEBUG(main_logger, "Before mask load");
   kwiver::vital::image_container_sptr mask, mask2;
+  std::string mask2_file;
   if( ! opt_mask_image.empty() )
   {
     mask = image_converter->convert( image_reader->load( opt_mask_image ) );
@@ -348,10 +737,12 @@ static int maptk_main(int argc, char const* argv[])
     if( ! opt_mask2_image.empty() )
     {
       mask2 = image_converter->convert( image_reader->load( opt_mask2_image ) );
+      mask2_file = opt_mask2_image;
     }
     else
     {
       mask2 = mask;
+      mask2_file = opt_mask_image;
     }
   }
 
@@ -363,14 +754,34 @@ static int maptk_main(int argc, char const* argv[])
     return EXIT_FAILURE;
   }
 
-  LOG_INFO(main_logger, "Generating features over input frames...");
-  // if no masks were loaded, the value of each mask at this point will be the
-  // same as the default value (uninitialized sptr)
-  kwiver::vital::feature_set_sptr i1_features = feature_detector->detect(i1_image, mask),
-                          i2_features = feature_detector->detect(i2_image, mask2);
-  LOG_INFO(main_logger, "Generating descriptors over input frames...");
-  kwiver::vital::descriptor_set_sptr i1_descriptors = descriptor_extractor->extract(i1_image, i1_features),
-                             i2_descriptors = descriptor_extractor->extract(i2_image, i2_features);
+  algo_set algos;
+#define copy_algo(type, name)  algos.name = name
+
+  tool_algos(copy_algo);
+
+#undef copy_algo
+
+  LOG_INFO(main_logger, "Generating features and descriptors over input frames...");
+  image_features i1, i2;
+  try
+  {
+    i1 = compute_image_features( algos, input_img_files[0], mask, opt_mask_image, cache );
+    i2 = compute_image_features( algos, input_img_files[1], mask2, mask2_file, cache );
+  }
+  catch (kwiver::vital::path_not_exists const &e)
+  {
+    LOG_ERROR(main_logger, e.what());
+    return EXIT_FAILURE;
+  }
+  catch (kwiver::vital::path_not_a_file const &e)
+  {
+    LOG_ERROR(main_logger, e.what());
+    return EXIT_FAILURE;
+  }
+  kwiver::vital::feature_set_sptr i1_features = i1.features,
+                          i2_features = i2.features;
+  kwiver::vital::descriptor_set_sptr i1_descriptors = i1.descriptors,
+                             i2_descriptors = i2.descriptors;
   LOG_INFO(main_logger, "-- Img1 features / descriptors: " << i1_descriptors->size());
   LOG_INFO(main_logger, "-- Img2 features / descriptors: " << i2_descriptors->size());
 
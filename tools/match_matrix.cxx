@@ -33,17 +33,19 @@
  * \brief compute a match matrix from a track file
  */
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <exception>
 #include <string>
 #include <vector>
 
-#include <unsupported/Eigen/SparseExtra>
-
-#include <arrows/core/match_matrix.h>
+#include <maptk/covisibility_index.h>
+#include <maptk/match_matrix_builder.h>
+#include <maptk/match_matrix_io.h>
 #include <vital/exceptions.h>
 #include <vital/io/track_set_io.h>
+#include <vital/vital_foreach.h>
 
 #include <kwiversys/SystemTools.hxx>
 #include <kwiversys/CommandLineArguments.hxx>
@@ -83,7 +85,8 @@ void
 write_match_matrix(std::ostream& os,
                    const Eigen::SparseMatrix<unsigned int>& mm)
 {
-  // TODO write out the matrix in a more memory efficient way
+  // Note: this expands the matrix to dense form; use the "triplets" or "csr"
+  // formats for long sequences.
   os << Eigen::MatrixXd(mm) << std::endl;
 }
 
@@ -126,6 +129,11 @@ static int maptk_main(int argc, char const* argv[])
   static std::string opt_in_tracks;
   static std::string opt_out_matrix;
   static std::string opt_out_frames;
+  static std::string opt_format;
+  static int         opt_threads( 0 );
+  static std::string opt_out_candidates;
+  static int         opt_top_k( 5 );
+  static int         opt_exclusion( 50 );
 
 
   kwiversys::CommandLineArguments arg;
@@ -136,6 +144,25 @@ static int maptk_main(int argc, char const* argv[])
   arg.AddArgument( "--input-tracks",   argT::SPACE_ARGUMENT, &opt_in_tracks, "Input track file." );
   arg.AddArgument( "--output-matrix",  argT::SPACE_ARGUMENT, &opt_out_matrix, "Output match matrix file" );
   arg.AddArgument( "--output-frames",  argT::SPACE_ARGUMENT, &opt_out_frames, "Output frame number file" );
+  arg.AddArgument( "--threads",        argT::SPACE_ARGUMENT, &opt_threads,
+                   "Number of threads used to compute the matrix (default: 0, "
+                   "use all hardware threads)" );
+  arg.AddArgument( "--output-candidates", argT::SPACE_ARGUMENT, &opt_out_candidates,
+                   "Output file of loop closure candidate frame pairs, one "
+                   "\"frame candidate count\" line per pair" );
+  arg.AddArgument( "--top-k",          argT::SPACE_ARGUMENT, &opt_top_k,
+                   "Maximum number of loop closure candidates per frame (default: 5)" );
+  arg.AddArgument( "--exclusion-window", argT::SPACE_ARGUMENT, &opt_exclusion,
+                   "Frames within this many frames of each other are not loop "
+                   "closure candidates (default: 50)" );
+  arg.AddArgument( "--matrix-format",  argT::SPACE_ARGUMENT, &opt_format,
+                   "Output match matrix format: \"dense\" (text), \"triplets\" "
+                   "(sparse text with frame numbers), \"csr\" (sparse binary with "
+                   "frame numbers) or \"mtx\" (Matrix Market with frame numbers in "
+                   "comments). By default the format is \"mtx\" or \"csr\" for files "
+                   "with those extensions, \"triplets\" for other files, and "
+                   "\"dense\" when printing to standard output. The dense format "
+                   "cannot be read back by the GUI." );
 
   if ( ! arg.Parse() )
   {
@@ -155,6 +182,32 @@ static int maptk_main(int argc, char const* argv[])
     return EXIT_FAILURE;
   }
 
+  // determine the output matrix format
+  std::string format = ST::LowerCase( opt_format );
+  if( format.empty() )
+  {
+    if( opt_out_matrix.empty() )
+    {
+      format = "dense";
+    }
+    else
+    {
+      std::string const ext = ST::LowerCase( ST::GetFilenameLastExtension( opt_out_matrix ) );
+      format = ( ext == ".mtx" || ext == ".csr" ) ? ext.substr( 1 ) : "triplets";
+    }
+  }
+  if( format != "dense" && format != "triplets" &&
+      format != "csr" && format != "mtx" )
+  {
+    std::cerr << "Unknown match matrix format: " << opt_format << std::endl;
+    return EXIT_FAILURE;
+  }
+  if( format == "csr" && opt_out_matrix.empty() )
+  {
+    std::cerr << "The csr format requires an output matrix file" << std::endl;
+    return EXIT_FAILURE;
+  }
+
   // test the output files
   if( ! opt_out_matrix.empty() )
   {
@@ -168,6 +221,12 @@ static int maptk_main(int argc, char const* argv[])
     check_file_path(outfile);
   }
 
+  if( ! opt_out_candidates.empty() )
+  {
+    vital::path_t outfile( opt_out_candidates );
+    check_file_path(outfile);
+  }
+
   // load the tracks
   std::string infile = opt_in_tracks;
   std::cout << "loading: "<< infile << std::endl;
@@ -176,23 +235,38 @@ static int maptk_main(int argc, char const* argv[])
   // compute the match matrix
   std::cout << "computing matching matrix" <<std::endl;
   std::vector<vital::frame_id_t> frames;
-  Eigen::SparseMatrix<unsigned int> mm = kwiver::arrows::match_matrix(tracks, frames);
+  unsigned const builder_threads = static_cast<unsigned>( std::max( opt_threads, 0 ) );
+  maptk::match_matrix_builder builder( builder_threads );
+  builder.update( *tracks );
+  Eigen::SparseMatrix<unsigned int> mm = builder.matrix( frames );
 
   // write output
   if( ! opt_out_matrix.empty() )
   {
     vital::path_t outfile( opt_out_matrix );
     std::cout << "writing matrix to: "<< outfile << std::endl;
-    if( ST::GetFilenameExtension( outfile ) == ".mtx" )
+    if( format == "dense" )
     {
-      Eigen::saveMarket(mm, outfile);
+      std::ofstream ofs(outfile.c_str());
+      write_match_matrix(ofs, mm);
+      if( ! ofs )
+      {
+        throw vital::file_write_exception(outfile, "Could not write match matrix");
+      }
     }
     else
     {
-      std::ofstream ofs(outfile.c_str());
-      write_match_matrix(ofs, mm);
+      maptk::write_match_matrix_file(mm, frames, outfile, format);
     }
   }
+  else if( format == "triplets" )
+  {
+    maptk::write_match_matrix_triplets(std::cout, mm, frames);
+  }
+  else if( format == "mtx" )
+  {
+    maptk::write_match_matrix_market(std::cout, mm, frames);
+  }
   else
   {
     write_frame_numbers(std::cout, frames);
@@ -207,6 +281,23 @@ static int maptk_main(int argc, char const* argv[])
     write_frame_numbers(ofs, frames);
   }
 
+  if( ! opt_out_candidates.empty() )
+  {
+    vital::path_t outfile( opt_out_candidates );
+    std::cout << "writing loop closure candidates to: "<< outfile << std::endl;
+    maptk::covisibility_index index( builder_threads );
+    index.build( builder );
+    std::ofstream ofs(outfile.c_str());
+    VITAL_FOREACH( auto const f, frames )
+    {
+      VITAL_FOREACH( auto const& n, index.top_k( f, static_cast<size_t>( std::max( opt_top_k, 0 ) ),
+                                                 opt_exclusion, 1, true ) )
+      {
+        ofs << f << " " << n.frame << " " << n.count << "\n";
+      }
+    }
+  }
+
   return EXIT_SUCCESS;
 }
 
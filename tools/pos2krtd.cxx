@@ -33,9 +33,14 @@
  * \brief POS file to KRTD conversion utility
  */
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <fstream>
 #include <exception>
+#include <mutex>
+#include <set>
+#include <sstream>
 #include <string>
 #include <vector>
 
@@ -54,8 +59,11 @@
 #include <kwiversys/CommandLineArguments.hxx>
 #include <kwiversys/Directory.hxx>
 
+#include <maptk/config_cache.h>
 #include <maptk/ins_data_io.h>
 #include <maptk/local_geo_cs.h>
+#include <maptk/parallel.h>
+#include <maptk/plugin_registry.h>
 #include <maptk/version.h>
 
 typedef kwiversys::SystemTools     ST;
@@ -105,6 +113,27 @@ default_config()
                     "A quaternion used to offset rotation data from POS files when "
                     "updating cameras.");
 
+  // local coordinate system options
+  config->set_value("utm_origin", "",
+                    "Optional local coordinate system origin as \"easting "
+                    "northing zone\" in UTM. By default the origin is the mean "
+                    "easting and northing of the input cameras, in the UTM "
+                    "zone of the first camera.");
+
+  // directory conversion options
+  config->set_value("streaming", "false",
+                    "Convert a directory of POS files in two passes without "
+                    "holding all of the POS data in memory. The first pass "
+                    "only computes the local origin, and is skipped if "
+                    "utm_origin is given. The second pass converts POS files "
+                    "and writes KRTD files in chunks, in parallel.");
+  config->set_value("num_threads", "0",
+                    "Number of threads used in streaming mode. Zero uses the "
+                    "number of hardware threads.");
+  config->set_value("chunk_size", "256",
+                    "Number of POS files a thread converts at a time in "
+                    "streaming mode. Progress is reported after each chunk.");
+
   return config;
 }
 
@@ -156,6 +185,23 @@ check_config(kwiver::vital::config_block_sptr config)
     }
   }
 
+  if (config->get_value<std::string>("utm_origin", "") != "")
+  {
+    std::istringstream ss(config->get_value<std::string>("utm_origin"));
+    double easting, northing;
+    int zone;
+    if (!(ss >> easting >> northing >> zone) || zone < 1 || zone > 60)
+    {
+      MAPTK_CHECK_FAIL("utm_origin must be \"easting northing zone\" with a "
+                       "zone from 1 to 60.");
+    }
+  }
+
+  if (config->get_value<unsigned>("chunk_size") == 0)
+  {
+    MAPTK_CHECK_FAIL("chunk_size must be positive.");
+  }
+
 #undef MAPTK_CHECK_FAIL
 
   return config_valid;
@@ -283,6 +329,194 @@ bool convert_pos2krtd_dir(const kwiver::vital::path_t& pos_dir,
 }
 
 
+// ------------------------------------------------------------------
+/// Convert a directory of POS files to KRTD files without loading all of them
+/**
+ * The first pass computes the local origin the same way as
+ * initialize_cameras_with_ins (the mean easting and northing in the UTM zone
+ * of the first valid file), keeping only running sums.  It is skipped if
+ * \p cs already has an origin.  The second pass converts files in chunks,
+ * each worker reading, converting and writing one file at a time, so memory
+ * use does not grow with the number of files.  Each worker has its own
+ * geo_map instance since the implementation may not be thread safe.
+ */
+bool convert_pos2krtd_dir_streaming(const kwiver::vital::path_t& pos_dir,
+                                    const kwiver::vital::path_t& krtd_dir,
+                                    kwiver::maptk::local_geo_cs& cs,
+                                    const kwiver::vital::simple_camera& base_camera,
+                                    kwiver::vital::rotation_d const& ins_rot_offset,
+                                    unsigned num_threads, size_t chunk_size)
+{
+  kwiversys::Directory dir;
+  dir.Load( pos_dir );
+
+  std::vector<kwiver::vital::path_t> pos_files;
+  unsigned long num_files = dir.GetNumberOfFiles();
+  for ( unsigned long i = 0; i < num_files; i++)
+  {
+    kwiver::vital::path_t p = pos_dir + "/" + dir.GetFile( i );
+    if ( ! ST::FileIsDirectory( p ) )
+    {
+      pos_files.push_back( p );
+    }
+  }
+
+  size_t const num_chunks = ( pos_files.size() + chunk_size - 1 ) / chunk_size;
+  size_t const num_workers =
+    std::max<size_t>( std::min<size_t>( num_threads, num_chunks ), 1 );
+  std::vector<kwiver::maptk::local_geo_cs> worker_cs;
+  for ( size_t w = 0; w < num_workers; ++w )
+  {
+    kwiver::vital::algo::geo_map_sptr geo_mapper =
+      ( w == 0 ) ? cs.geo_map_algo() : kwiver::vital::algo::geo_map::create("proj");
+    worker_cs.push_back( kwiver::maptk::local_geo_cs( geo_mapper ) );
+  }
+
+  std::mutex log_mutex;
+  // 0 = not yet read, 1 = valid, 2 = invalid
+  std::vector<char> status( pos_files.size(), 0 );
+
+  if ( cs.utm_origin_zone() < 0 )
+  {
+    std::cerr << "Computing local origin from " << pos_files.size()
+              << " POS files" << std::endl;
+
+    // the UTM zone of the first valid file is used for every file
+    size_t first = 0;
+    for ( ; first < pos_files.size() && cs.utm_origin_zone() < 0; ++first )
+    {
+      try
+      {
+        kwiver::maptk::ins_data ins = kwiver::maptk::read_pos_file( pos_files[first] );
+        cs.set_utm_origin_zone( cs.geo_map_algo()->latlon_zone( ins.lat, ins.lon ) );
+      }
+      catch (kwiver::vital::io_exception const& e)
+      {
+        std::cerr << "-> Skipping invalid file: " << pos_files[first] << std::endl;
+        std::cerr << "   " << e.what() << std::endl;
+        status[first] = 2;
+      }
+    }
+    if ( cs.utm_origin_zone() < 0 )
+    {
+      std::cerr << "WARNING: No valid input files found in directory. "
+                << "Nothing to do."
+                << std::endl;
+      return false;
+    }
+
+    std::vector<kwiver::vital::vector_2d> sums( num_workers, kwiver::vital::vector_2d( 0, 0 ) );
+    std::vector<size_t> counts( num_workers, 0 );
+    std::atomic<size_t> next_chunk( 0 );
+    int const zone = cs.utm_origin_zone();
+    kwiver::maptk::parallel_for( num_workers, num_workers, [&]( size_t w )
+    {
+      auto const& geo_mapper = worker_cs[w].geo_map_algo();
+      for ( size_t c = next_chunk++; c < num_chunks; c = next_chunk++ )
+      {
+        size_t const end = std::min( ( c + 1 ) * chunk_size, pos_files.size() );
+        for ( size_t i = c * chunk_size; i < end; ++i )
+        {
+          if ( status[i] == 2 )
+          {
+            continue;
+          }
+          try
+          {
+            kwiver::maptk::ins_data ins = kwiver::maptk::read_pos_file( pos_files[i] );
+            double x, y;
+            int z;
+            bool is_north_hemi;
+            geo_mapper->latlon_to_utm( ins.lat, ins.lon, x, y, z, is_north_hemi, zone );
+            sums[w] += kwiver::vital::vector_2d( x, y );
+            ++counts[w];
+            status[i] = 1;
+          }
+          catch (kwiver::vital::io_exception const& e)
+          {
+            std::lock_guard<std::mutex> lock( log_mutex );
+            std::cerr << "-> Skipping invalid file: " << pos_files[i] << std::endl;
+            std::cerr << "   " << e.what() << std::endl;
+            status[i] = 2;
+          }
+        }
+      }
+    } );
+
+    kwiver::vital::vector_2d sum( 0, 0 );
+    size_t count = 0;
+    for ( size_t w = 0; w < num_workers; ++w )
+    {
+      sum += sums[w];
+      count += counts[w];
+    }
+    sum /= static_cast<double>( count );
+    cs.set_utm_origin( kwiver::vital::vector_3d( sum[0], sum[1], 0.0 ) );
+  }
+
+  VITAL_FOREACH( auto& wcs, worker_cs )
+  {
+    wcs.set_utm_origin_zone( cs.utm_origin_zone() );
+    wcs.set_utm_origin( cs.utm_origin() );
+  }
+
+  std::cerr << "Converting " << pos_files.size() << " POS files using "
+            << num_workers << " thread(s)" << std::endl;
+  std::atomic<size_t> next_chunk( 0 );
+  std::atomic<size_t> num_written( 0 );
+  size_t files_done = 0;
+  kwiver::maptk::parallel_for( num_workers, num_workers, [&]( size_t w )
+  {
+    for ( size_t c = next_chunk++; c < num_chunks; c = next_chunk++ )
+    {
+      size_t const end = std::min( ( c + 1 ) * chunk_size, pos_files.size() );
+      for ( size_t i = c * chunk_size; i < end; ++i )
+      {
+        if ( status[i] == 2 )
+        {
+          continue;
+        }
+        kwiver::vital::path_t const& p = pos_files[i];
+        kwiver::vital::path_t krtd_filename = krtd_dir + "/"
+                                            + ST::GetFilenameWithoutLastExtension( p ) + ".krtd";
+        try
+        {
+          kwiver::vital::simple_camera cam( base_camera );
+          worker_cs[w].update_camera( kwiver::maptk::read_pos_file( p ), cam,
+                                      ins_rot_offset );
+          kwiver::vital::write_krtd_file( cam, krtd_filename );
+          ++num_written;
+        }
+        catch (kwiver::vital::io_exception const& e)
+        {
+          std::lock_guard<std::mutex> lock( log_mutex );
+          std::cerr << "-> Skipping invalid file: " << p << std::endl;
+          std::cerr << "   " << e.what() << std::endl;
+        }
+      }
+
+      std::lock_guard<std::mutex> lock( log_mutex );
+      files_done += end - c * chunk_size;
+      std::cerr << "Converted " << files_done << " / " << pos_files.size()
+                << " files" << std::endl;
+    }
+  } );
+
+  if ( num_written == 0 )
+  {
+    std::cerr << "WARNING: No valid input files found in directory. "
+              << "Nothing to do."
+              << std::endl;
+    return false;
+  }
+
+  kwiver::vital::vector_3d origin = cs.utm_origin();
+  std::cerr << "using local UTM origin at "<<origin[0] <<", "<<origin[1]
+            <<", zone "<<cs.utm_origin_zone() <<std::endl;
+  return true;
+}
+
+
 // ------------------------------------------------------------------
 static int maptk_main(int argc, char const* argv[])
 {
@@ -327,7 +561,8 @@ static int maptk_main(int argc, char const* argv[])
   // register the algorithm implementations
   std::string rel_plugin_path = kwiver::vital::get_executable_path() + "/../lib/modules";
   kwiver::vital::plugin_manager::instance().add_search_path(rel_plugin_path);
-  kwiver::vital::plugin_manager::instance().load_all_plugins();
+  // only the plugin providing the "proj" geo_map used below is needed
+  kwiver::maptk::load_plugins_providing( std::set<std::string>{ "proj" } );
 
   //
   // Initialize from configuration
@@ -337,8 +572,8 @@ static int maptk_main(int argc, char const* argv[])
   if ( ! opt_config.empty())
   {
     const std::string prefix = kwiver::vital::get_executable_path() + "/..";
-    config->merge_config(kwiver::vital::read_config_file(opt_config, "maptk",
-                                                         MAPTK_VERSION, prefix));
+    config->merge_config(kwiver::maptk::read_cached_config_file(opt_config, "maptk",
+                                                                MAPTK_VERSION, prefix));
   }
 
   bool config_is_valid = check_config(config);
@@ -380,6 +615,17 @@ static int maptk_main(int argc, char const* argv[])
 
   kwiver::maptk::local_geo_cs local_cs(geo_mapper);
 
+  std::string const utm_origin = config->get_value<std::string>("utm_origin", "");
+  if( ! utm_origin.empty() )
+  {
+    std::istringstream ss(utm_origin);
+    double easting, northing;
+    int zone;
+    ss >> easting >> northing >> zone;
+    local_cs.set_utm_origin(kwiver::vital::vector_3d(easting, northing, 0.0));
+    local_cs.set_utm_origin_zone(zone);
+  }
+
   if( ST::FileIsDirectory(input) )
   {
     std::cerr << "processing "<<input<<" as a directory of POS files" << std::endl;
@@ -391,7 +637,18 @@ static int maptk_main(int argc, char const* argv[])
         return EXIT_FAILURE;
       }
     }
-    if( !convert_pos2krtd_dir(input, output, local_cs, base_camera, ins_rot_offset) )
+    if( config->get_value<bool>("streaming") )
+    {
+      unsigned num_threads = kwiver::maptk::resolve_num_threads(
+        config->get_value<unsigned>("num_threads") );
+      if( !convert_pos2krtd_dir_streaming(input, output, local_cs, base_camera,
+                                          ins_rot_offset, num_threads,
+                                          config->get_value<size_t>("chunk_size")) )
+      {
+        return EXIT_FAILURE;
+      }
+    }
+    else if( !convert_pos2krtd_dir(input, output, local_cs, base_camera, ins_rot_offset) )
     {
       return EXIT_FAILURE;
     }
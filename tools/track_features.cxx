@@ -38,8 +38,13 @@
 #include <exception>
 #include <string>
 #include <vector>
+#include <algorithm>
+#include <chrono>
+#include <memory>
 
+#include <maptk/config_cache.h>
 #include <maptk/colorize.h>
+#include <maptk/feature_cache.h>
 
 #include <vital/config/config_block.h>
 #include <vital/config/config_block_io.h>
@@ -60,6 +65,7 @@
 #include <kwiversys/SystemTools.hxx>
 #include <kwiversys/CommandLineArguments.hxx>
 
+#include <maptk/plugin_registry.h>
 #include <maptk/version.h>
 
 typedef kwiversys::SystemTools ST;
@@ -104,6 +110,24 @@ static kwiver::vital::config_block_sptr default_config()
                     "homographies for each frame. Leave blank to disable this "
                     "output. The output_homography_generator algorithm type "
                     "only needs to be set if this is set.");
+  config->set_value("output_telemetry_file", "",
+                    "Optional path to a file to write per-frame telemetry to. "
+                    "One record is appended and flushed after each frame with "
+                    "the image decode time, tracking time, homography "
+                    "generation time (in seconds) and the number of features "
+                    "detected, active tracks, new tracks and terminated "
+                    "tracks. If the file extension is \".json\" or "
+                    "\".jsonl\" records are written as JSON lines, otherwise "
+                    "as CSV with a header row. Leave blank to disable this "
+                    "output.");
+  config->set_value("feature_cache_directory", "",
+                    "Optional directory in which to store the features and "
+                    "descriptors tracked on each frame, keyed as by "
+                    "maptk_estimate_homography so that it can load them "
+                    "rather than detect features again. Requires a feature "
+                    "tracker with nested feature_detector and "
+                    "descriptor_extractor algorithms. Leave blank to disable "
+                    "this output.");
 
   kwiver::vital::algo::track_features::get_nested_algo_configuration("feature_tracker", config,
                                       kwiver::vital::algo::track_features_sptr());
@@ -153,6 +177,24 @@ static bool check_config(kwiver::vital::config_block_sptr config)
     }
   }
 
+  // The telemetry file follows the same rules as the homography file.
+  if ( config->has_value("output_telemetry_file")
+    && config->get_value<std::string>("output_telemetry_file") != "" )
+  {
+    kwiver::vital::config_path_t fp = config->get_value<kwiver::vital::config_path_t>("output_telemetry_file");
+    if ( ST::FileIsDirectory( fp ) )
+    {
+      MAPTK_CONFIG_FAIL("Given output telemetry file is a directory! "
+                        << "(Given: " << fp << ")");
+    }
+    else if ( ST::GetFilenamePath( fp ) != "" &&
+              ! ST::FileIsDirectory( ST::GetFilenamePath( fp ) ))
+    {
+      MAPTK_CONFIG_FAIL("Given output telemetry file does not have a valid "
+                        << "parent path! (Given: " << fp << ")");
+    }
+  }
+
   if ( ! config->has_value("image_list_file") ||
       config->get_value<std::string>("image_list_file") == "")
   {
@@ -216,6 +258,197 @@ static bool invert_mask_pixel( bool const &b )
 }
 
 
+// ------------------------------------------------------------------
+/// Per-frame timing and track statistics written to the telemetry file
+struct frame_telemetry
+{
+  frame_telemetry()
+    : frame( 0 ), decode_time( 0.0 ), track_time( 0.0 ), homog_time( 0.0 ),
+      num_features( 0 ), num_active( 0 ), num_new( 0 ), num_terminated( 0 )
+  {}
+
+  kwiver::vital::frame_id_t frame;
+  std::string file;
+  double decode_time;
+  double track_time;
+  double homog_time;
+  size_t num_features;
+  size_t num_active;
+  size_t num_new;
+  size_t num_terminated;
+};
+
+
+// ------------------------------------------------------------------
+/// Incrementally writes frame_telemetry records as CSV or JSON lines
+class telemetry_writer
+{
+public:
+  telemetry_writer()
+    : json_( false )
+  {}
+
+  /// Open the output file, selecting the format from the file extension
+  bool open( kwiver::vital::path_t const& fp )
+  {
+    std::string const ext =
+      ST::LowerCase( ST::GetFilenameLastExtension( fp ) );
+    json_ = ( ext == ".json" || ext == ".jsonl" );
+
+    ofs_.open( fp.c_str() );
+    if ( !ofs_ )
+    {
+      return false;
+    }
+    if ( !json_ )
+    {
+      ofs_ << "frame,decode_time,track_time,homography_time,"
+              "features,active_tracks,new_tracks,terminated_tracks,file"
+           << std::endl;
+    }
+    return true;
+  }
+
+  bool is_open() const { return ofs_.is_open(); }
+
+  /// Write one record and flush so the file can be monitored while running
+  void write( frame_telemetry const& t )
+  {
+    if ( json_ )
+    {
+      ofs_ << "{\"frame\": " << t.frame
+           << ", \"decode_time\": " << t.decode_time
+           << ", \"track_time\": " << t.track_time
+           << ", \"homography_time\": " << t.homog_time
+           << ", \"features\": " << t.num_features
+           << ", \"active_tracks\": " << t.num_active
+           << ", \"new_tracks\": " << t.num_new
+           << ", \"terminated_tracks\": " << t.num_terminated
+           << ", \"file\": \"" << escape_json( t.file ) << "\"}";
+    }
+    else
+    {
+      ofs_ << t.frame << ","
+           << t.decode_time << ","
+           << t.track_time << ","
+           << t.homog_time << ","
+           << t.num_features << ","
+           << t.num_active << ","
+           << t.num_new << ","
+           << t.num_terminated << ","
+           << "\"" << escape_csv( t.file ) << "\"";
+    }
+    ofs_ << std::endl;
+  }
+
+private:
+  /// Double embedded quotes, as required inside a quoted CSV field
+  static std::string escape_csv( std::string const& s )
+  {
+    std::string r;
+    r.reserve( s.size() );
+    VITAL_FOREACH( char const c, s )
+    {
+      if ( c == '"' )
+      {
+        r += '"';
+      }
+      r += c;
+    }
+    return r;
+  }
+
+  static std::string escape_json( std::string const& s )
+  {
+    std::string r;
+    r.reserve( s.size() );
+    VITAL_FOREACH( char const c, s )
+    {
+      if ( c == '"' || c == '\\' )
+      {
+        r += '\\';
+      }
+      r += c;
+    }
+    return r;
+  }
+
+  std::ofstream ofs_;
+  bool json_;
+};
+
+
+// ------------------------------------------------------------------
+/// Derives per-frame track counts from the tracks active on each frame
+///
+/// Only the ids of the tracks with a feature on the current frame (reported
+/// by feature colorization, which already visits them) are compared with
+/// those of the previous frame, so the work per frame is proportional to the
+/// number of active tracks rather than the size of the whole track set.
+class track_counter
+{
+public:
+  track_counter()
+    : max_id_( -1 )
+  {}
+
+  /// Fill in the counts of \p ft from the ids of the tracks on this frame
+  void update( std::vector< kwiver::vital::track_id_t > ids,
+               frame_telemetry& ft )
+  {
+    std::sort( ids.begin(), ids.end() );
+
+    size_t continued = 0;
+    size_t created = 0;
+    auto p = active_.cbegin();
+    VITAL_FOREACH( auto const id, ids )
+    {
+      // The tracker assigns increasing ids, so any id above those seen
+      // before belongs to a track started on this frame
+      if ( id > max_id_ )
+      {
+        ++created;
+        continue;
+      }
+      while ( p != active_.cend() && *p < id )
+      {
+        ++p;
+      }
+      if ( p != active_.cend() && *p == id )
+      {
+        ++continued;
+      }
+    }
+
+    // Each active track has exactly one state on the current frame, and
+    // the tracker keeps one state for each feature it detected there
+    ft.num_features = ids.size();
+    ft.num_active = ids.size();
+    ft.num_new = created;
+    ft.num_terminated = active_.size() - continued;
+
+    if ( !ids.empty() )
+    {
+      max_id_ = std::max( max_id_, ids.back() );
+    }
+    active_.swap( ids );
+  }
+
+private:
+  std::vector< kwiver::vital::track_id_t > active_; // sorted ids
+  kwiver::vital::track_id_t max_id_; // largest id seen so far
+};
+
+
+// ------------------------------------------------------------------
+/// Number of seconds elapsed since \p start
+static double seconds_since( std::chrono::steady_clock::time_point const& start )
+{
+  return std::chrono::duration<double>( std::chrono::steady_clock::now()
+                                        - start ).count();
+}
+
+
 // ------------------------------------------------------------------
 static int maptk_main(int argc, char const* argv[])
 {
@@ -255,7 +488,14 @@ static int maptk_main(int argc, char const* argv[])
   // register the algorithm implementations
   std::string rel_plugin_path = kwiver::vital::get_executable_path() + "/../lib/modules";
   kwiver::vital::plugin_manager::instance().add_search_path(rel_plugin_path);
-  kwiver::vital::plugin_manager::instance().load_all_plugins();
+
+  // Writing a configuration lists every available implementation, so load
+  // all plugins; otherwise only load the plugins the configuration needs.
+  bool const lazy_plugins = opt_out_config.empty();
+  if( ! lazy_plugins )
+  {
+    kwiver::vital::plugin_manager::instance().load_all_plugins();
+  }
 
   // Set config to algo chain
   // Get config from algo chain after set
@@ -275,18 +515,27 @@ static int maptk_main(int argc, char const* argv[])
   if( ! opt_config.empty() )
   {
     const std::string prefix = kwiver::vital::get_executable_path() + "/..";
-    config->merge_config(kwiver::vital::read_config_file(opt_config, "maptk",
-                                                         MAPTK_VERSION, prefix));
+    config->merge_config(kwiver::maptk::read_cached_config_file(opt_config, "maptk",
+                                                                MAPTK_VERSION, prefix));
   }
 
-  kwiver::vital::algo::track_features::set_nested_algo_configuration("feature_tracker", config, feature_tracker);
-  kwiver::vital::algo::track_features::get_nested_algo_configuration("feature_tracker", config, feature_tracker);
-  kwiver::vital::algo::image_io::set_nested_algo_configuration("image_reader", config, image_reader);
-  kwiver::vital::algo::image_io::get_nested_algo_configuration("image_reader", config, image_reader);
-  kwiver::vital::algo::convert_image::set_nested_algo_configuration("convert_image", config, image_converter);
-  kwiver::vital::algo::convert_image::get_nested_algo_configuration("convert_image", config, image_converter);
-  kwiver::vital::algo::compute_ref_homography::set_nested_algo_configuration("output_homography_generator", config, out_homog_generator);
-  kwiver::vital::algo::compute_ref_homography::get_nested_algo_configuration("output_homography_generator", config, out_homog_generator);
+  // Configuring an algorithm can reveal nested algorithm types, so repeat
+  // until no more plugins are needed.
+  if( lazy_plugins )
+  {
+    kwiver::maptk::load_plugins_for_config( config );
+  }
+  do
+  {
+    kwiver::vital::algo::track_features::set_nested_algo_configuration("feature_tracker", config, feature_tracker);
+    kwiver::vital::algo::track_features::get_nested_algo_configuration("feature_tracker", config, feature_tracker);
+    kwiver::vital::algo::image_io::set_nested_algo_configuration("image_reader", config, image_reader);
+    kwiver::vital::algo::image_io::get_nested_algo_configuration("image_reader", config, image_reader);
+    kwiver::vital::algo::convert_image::set_nested_algo_configuration("convert_image", config, image_converter);
+    kwiver::vital::algo::convert_image::get_nested_algo_configuration("convert_image", config, image_converter);
+    kwiver::vital::algo::compute_ref_homography::set_nested_algo_configuration("output_homography_generator", config, out_homog_generator);
+    kwiver::vital::algo::compute_ref_homography::get_nested_algo_configuration("output_homography_generator", config, out_homog_generator);
+  } while( lazy_plugins && kwiver::maptk::load_plugins_for_config( config ) );
 
   bool valid_config = check_config(config);
 
@@ -396,12 +645,68 @@ static int maptk_main(int argc, char const* argv[])
     }
   }
 
+  // Create the output telemetry file if specified
+  telemetry_writer telemetry;
+  track_counter telemetry_counter;
+  if ( config->has_value("output_telemetry_file") &&
+       config->get_value<std::string>("output_telemetry_file") != "" )
+  {
+    kwiver::vital::path_t telem_fp = config->get_value<kwiver::vital::path_t>("output_telemetry_file");
+    if ( !telemetry.open( telem_fp ) )
+    {
+      LOG_ERROR(main_logger, "Could not open telemetry file for writing: "
+                             << telem_fp);
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Set up the feature cache if specified.  The tracker detects features
+  // itself, so entries are only stored here, keyed by the configuration of
+  // the tracker's nested detector and extractor.
+  std::unique_ptr<kwiver::maptk::feature_cache> cache;
+  uint64_t cache_config_hash = 0;
+  std::string const cache_dir =
+    config->get_value<std::string>("feature_cache_directory", "");
+  if ( ! cache_dir.empty() )
+  {
+    std::string const tracker_block = "feature_tracker:" +
+      config->get_value<std::string>("feature_tracker:type", "");
+    auto const detector = config->subblock( tracker_block + ":feature_detector" );
+    auto const extractor = config->subblock( tracker_block + ":descriptor_extractor" );
+    if ( detector->available_values().empty() ||
+         extractor->available_values().empty() )
+    {
+      LOG_WARN(main_logger, "The feature tracker has no nested feature "
+                            "detector and descriptor extractor; not using "
+                            "the feature cache");
+    }
+    else
+    {
+      auto const detect_config = kwiver::maptk::feature_cache::detection_config(
+        config->subblock( "image_reader" ), config->subblock( "convert_image" ),
+        detector, extractor );
+      if ( use_masks && invert_masks )
+      {
+        // the mask file alone does not determine the mask used
+        detect_config->set_value( "invert_masks", true );
+      }
+      cache_config_hash = kwiver::maptk::feature_cache::hash_config( detect_config );
+      cache.reset( new kwiver::maptk::feature_cache( cache_dir ) );
+      LOG_INFO(main_logger, "Storing features in feature cache: " << cache_dir);
+    }
+  }
+
   // Track features on each frame sequentially
   kwiver::vital::track_set_sptr tracks;
   for(unsigned i=0; i<files.size(); ++i)
   {
     LOG_INFO(main_logger, "processing frame "<<i<<": "<<files[i]);
 
+    frame_telemetry ft;
+    ft.frame = i;
+    ft.file = files[i];
+    auto timer = std::chrono::steady_clock::now();
+
     auto const image = image_reader->load( files[i] );
     auto const converted_image = image_converter->convert( image );
 
@@ -439,11 +744,30 @@ static int maptk_main(int argc, char const* argv[])
 
       converted_mask = image_converter->convert( mask );
     }
+    ft.decode_time = seconds_since( timer );
 
+    timer = std::chrono::steady_clock::now();
     tracks = feature_tracker->track(tracks, i, converted_image, converted_mask);
+    ft.track_time = seconds_since( timer );
+
+    // Store the features as detected, before they are colorized
+    if ( cache && tracks )
+    {
+      std::string const key = kwiver::maptk::feature_cache::make_key(
+        files[i], cache_config_hash, use_masks ? mask_files[i] : "" );
+      if ( ! cache->store( key, tracks->frame_features( i ),
+                           tracks->frame_descriptors( i ) ) )
+      {
+        LOG_WARN(main_logger, "Could not store features for " << files[i]
+                              << " in the feature cache");
+      }
+    }
+
+    std::vector<kwiver::vital::track_id_t> frame_track_ids;
     if (tracks)
     {
-      tracks = kwiver::maptk::extract_feature_colors(*tracks, *image, i);
+      tracks = kwiver::maptk::extract_feature_colors(*tracks, *image, i,
+                                                     &frame_track_ids);
     }
 
     // Compute ref homography for current frame with current track set + write to file
@@ -451,7 +775,18 @@ static int maptk_main(int argc, char const* argv[])
     if ( homog_ofs.is_open() )
     {
       LOG_DEBUG(main_logger, "writing homography");
+      timer = std::chrono::steady_clock::now();
       homog_ofs << *(out_homog_generator->estimate(i, tracks)) << std::endl;
+      ft.homog_time = seconds_since( timer );
+    }
+
+    if ( telemetry.is_open() && tracks )
+    {
+      telemetry_counter.update( frame_track_ids, ft );
+    }
+    if ( telemetry.is_open() )
+    {
+      telemetry.write( ft );
     }
   }
 